@@ -0,0 +1,608 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include "logger.h"
+
+#include "offscreen_context.h"
+#include "../include/session.h"
+#include "../include/drawing_lib.h"
+#include "../include/frame_stats.h"
+#include "../include/config.h"
+#include "../include/input_recording.h"
+#include "../include/frame_capture.h"
+#include "../include/mesh_buffer_cache.h"
+#include "../include/memory_report.h"
+#include "../include/primitive_generator.h"
+
+// project_1_bench renders the scene off-screen and measures the hot paths of the application:
+//   host_bytes  - host memory of the scene counted by MemoryAccounting, with GPU-resident Objects (the default) and
+//                 with copies of meshes and colours in every Object (host_bytes_with_object_copies);
+//   frame       - drawing all Objects with regular colours (DrawingLib::drawFrame) until the GPU is done;
+//   pick        - drawing all Objects with pick colours and reading the pixel under the cursor;
+//   box_select  - drawing with pick colours and reading all pixels inside a selection rectangle;
+//   box_select_queries - the same rectangles with occlusion queries instead of the pixel readback
+//                 (DrawingLib::queryObjectIdsInRect). Objects found only by the readback are counted as missed; queries
+//                 may find more, because Objects whose faces tie for the nearest depth all pass the depth test;
+//   hover_pick  - time of DrawingLib::updateHoverPick in a frame: the cursor moves to a random pixel (the pixel is
+//                 rendered), stays for the next frame (the result is read) and for one more (the result is cached);
+//                 hover_pick_frame is the whole frame with it, to compare with frame; hover_pick_agreement is the share
+//                 of positions where the hovered Object equals the one found by pick;
+//   views_2x2   - drawing the scene in four views of a quarter of the window each, from different angles (see
+//                 SceneView), to compare with four times frame; views_2x2_without_culling draws every Object in every
+//                 view; views_2x2_drawn_objects is the number of Objects drawn in all views of a frame;
+//                 views_2x2_occlusion_culling skips Objects hidden behind others as well (see OcclusionCuller), with the
+//                 numbers of occluders and of Objects it skipped in a frame;
+//   frame_compact_vertices - frame with VertexFormat::kCompact (16-bit positions and indices, see MeshBufferCache);
+//                 meshes lists for every built-in mesh the size of its buffers in both formats and the frame time of a
+//                 scene of only objects_per_type Objects of it, with each format;
+//   drag_event  - applying one cursor movement to all selected Objects (Session::updateObjectsCoordinates);
+//   add_objects - creating add_objects_count cubes with one call of Session::addObjects; add_object is the time of
+//                 creating a single one with Session::add_object;
+//   mesh_buffers - kGeneratedMeshCount generated spheres of different resolutions in the shared mesh buffers (see
+//                 MeshBufferCache): frame_generated_meshes draws objects_per_type / 10 Objects of each, then the
+//                 Objects of every other mesh are removed; fragmented and compacted are the buffer statistics before
+//                 and after MeshBufferCache::compact, compact_ms is its time;
+//   capture     - only with --capture: time of FrameCapture::captureFrame per frame while frames are written as raw
+//                 video; capture_frame is the whole frame with it, to compare with frame.
+// Results are written as JSON to stdout or to the file given with --output.
+// With --replay, a recording of project_1 --record is played back instead (see InputReplay): every frame is applied
+// and drawn as fast as possible, and the time of every frame is reported next to the recorded one. Replays of the
+// same recording with two builds can be compared frame by frame.
+
+namespace
+{
+struct BenchOptions
+{
+    int objects_per_type{100};
+    int iterations{100};
+    int width{1280};
+    int height{720};
+    unsigned seed{1};
+    std::string output;
+    std::string replay;
+    std::string capture;
+};
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kBatchObjectCount = 100000;
+// Distinct generated meshes of the mesh_buffers case.
+constexpr int kGeneratedMeshCount = 64;
+
+double millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void printUsage()
+{
+    std::cout << "Usage: project_1_bench [--objects N] [--iterations N] [--width W] [--height H] [--seed S] [--output file.json]\n"
+                 "       project_1_bench --replay FILE [--output file.json]\n"
+                 "  --objects     number of objects of every object type (default 100)\n"
+                 "  --iterations  number of measured repetitions of every case (default 100)\n"
+                 "  --replay      replay a recording of project_1 --record and report the time of every frame\n"
+                 "  --capture     also measure frame capture, writing raw video to files starting with the given path\n";
+}
+
+BenchOptions parseOptions(int argc, char** argv)
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool has_value = i + 1 < argc;
+        if (argument == "--objects" && has_value) {options.objects_per_type = std::atoi(argv[++i]);}
+        else if (argument == "--iterations" && has_value) {options.iterations = std::atoi(argv[++i]);}
+        else if (argument == "--width" && has_value) {options.width = std::atoi(argv[++i]);}
+        else if (argument == "--height" && has_value) {options.height = std::atoi(argv[++i]);}
+        else if (argument == "--seed" && has_value) {options.seed = static_cast<unsigned>(std::atoi(argv[++i]));}
+        else if (argument == "--output" && has_value) {options.output = argv[++i];}
+        else if (argument == "--replay" && has_value) {options.replay = argv[++i];}
+        else if (argument == "--capture" && has_value) {options.capture = argv[++i];}
+        else
+        {
+            printUsage();
+            std::exit(argument == "--help" ? 0 : 1);
+        }
+    }
+    if (options.objects_per_type < 0 || options.iterations <= 0 || options.width <= 0 || options.height <= 0)
+    {
+        printUsage();
+        std::exit(1);
+    }
+    return options;
+}
+
+void addObjects(Session& session, ObjectType object_type, int count, std::mt19937& random)
+/* Adds count Objects of object_type and spreads them over the visible part of the scene. */
+{
+    std::uniform_real_distribution<double> position_x(-7.0, 7.0);
+    std::uniform_real_distribution<double> position_y(-3.5, 3.5);
+
+    for (int i = 0; i < count; i++)
+    {
+        session.add_object(object_type);
+        session.getObjects().back().updateObjectCoordinates(position_x(random), position_y(random));
+    }
+}
+
+void populateScene(Session& session, int objects_per_type, std::mt19937& random)
+/* Adds objects_per_type Objects of every built-in type. */
+{
+    session.reserve(static_cast<size_t>(objects_per_type) * kBuiltinObjectTypeCount);
+    for (int type = 0; type < kBuiltinObjectTypeCount; type++)
+    {
+        addObjects(session, static_cast<ObjectType>(type), objects_per_type, random);
+    }
+}
+
+void measureFrames(DrawingLib& drawing_lib, int iterations, FrameStats& stats)
+/* Draws iterations frames with regular colours, each until the GPU is done. */
+{
+    for (int i = 0; i < iterations; i++)
+    {
+        auto frame_start = Clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawing_lib.drawFrame(false);
+        glFinish();
+        stats.add(millisecondsSince(frame_start));
+    }
+}
+
+int writeOutput(const BenchOptions& options, const std::string& json)
+/* Writes the results to --output or to stdout, returns the exit code. */
+{
+    if (options.output.empty())
+    {
+        std::cout << json;
+        return 0;
+    }
+    std::ofstream file(options.output);
+    file << json;
+    if (!file.good())
+    {
+        std::cerr << "Failed to write " << options.output << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+std::string statsToJson(const FrameStats& stats)
+{
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer),
+             "{\"samples\": %zu, \"mean_ms\": %.4f, \"min_ms\": %.4f, \"p50_ms\": %.4f, \"p90_ms\": %.4f, "
+             "\"p99_ms\": %.4f, \"max_ms\": %.4f}",
+             stats.size(), stats.mean(), stats.min(), stats.percentile(0.5), stats.percentile(0.9),
+             stats.percentile(0.99), stats.max());
+    return buffer;
+}
+
+int runReplay(const BenchOptions& options)
+/* Plays a recording back frame by frame into an off-screen framebuffer of the largest recorded window size.
+A frame is timed from applying its records until the GPU is done with it, like a frame of the application
+without ImGui. */
+{
+    InputReplay replay;
+    try
+    {
+        replay.open(options.replay);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    int width = replay.getMaxWindowWidth() > 0 ? replay.getMaxWindowWidth() : options.width;
+    int height = replay.getMaxWindowHeight() > 0 ? replay.getMaxWindowHeight() : options.height;
+    OffscreenContext context(width, height);
+
+    Session session;
+    DrawingLib drawing_lib(session);
+    drawing_lib.setWindowSize(width, height);
+
+    size_t frame_count = std::max<size_t>(replay.getFrameCount(), 1);
+    FrameStats replay_stats(frame_count);
+    FrameStats recorded_stats(frame_count);
+    std::ostringstream replay_frames, recorded_frames;
+    ReplayFrame frame;
+    auto replay_start = Clock::now();
+    for (size_t i = 0; ; i++)
+    {
+        auto frame_start = Clock::now();
+        if (!replay.playFrame(session, drawing_lib, frame))
+        {
+            break;
+        }
+        drawing_lib.renderScene(frame.imgui_capture_mouse);
+        glFinish();
+        double milliseconds = millisecondsSince(frame_start);
+
+        replay_stats.add(milliseconds);
+        recorded_stats.add(frame.recorded_milliseconds);
+        replay_frames << (i == 0 ? "" : ", ") << milliseconds;
+        recorded_frames << (i == 0 ? "" : ", ") << frame.recorded_milliseconds;
+    }
+    double replay_ms = millisecondsSince(replay_start);
+
+    std::ostringstream json;
+    json << "{\n"
+         << "  \"renderer\": \"" << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << "\",\n"
+         << "  \"recording\": \"" << options.replay << "\",\n"
+         << "  \"width\": " << width << ",\n"
+         << "  \"height\": " << height << ",\n"
+         << "  \"frames\": " << replay.getFrameCount() << ",\n"
+         << "  \"replay_ms\": " << replay_ms << ",\n"
+         << "  \"final_object_count\": " << session.getObjects().size() << ",\n"
+         << "  \"final_selected_count\": " << session.getSelection().count() << ",\n"
+         << "  \"replay_frame\": " << statsToJson(replay_stats) << ",\n"
+         << "  \"recorded_frame\": " << statsToJson(recorded_stats) << ",\n"
+         << "  \"replay_frame_ms\": [" << replay_frames.str() << "],\n"
+         << "  \"recorded_frame_ms\": [" << recorded_frames.str() << "]\n"
+         << "}\n";
+    drawing_lib.releaseBuffers();
+    return writeOutput(options, json.str());
+}
+}
+
+
+int main(int argc, char** argv)
+{
+    BenchOptions options = parseOptions(argc, argv);
+    Logger::init();
+    if (!options.replay.empty())
+    {
+        return runReplay(options);
+    }
+
+    OffscreenContext context(options.width, options.height);
+    std::mt19937 random(options.seed);
+
+    Session session;
+    DrawingLib drawing_lib(session);
+    drawing_lib.setWindowSize(options.width, options.height);
+    glViewport(0, 0, options.width, options.height);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+
+    auto start_time = Clock::now();
+    populateScene(session, options.objects_per_type, random);
+    glFinish();
+    double populate_ms = millisecondsSince(start_time);
+
+    // Host memory of the scene with GPU-resident Objects and with copies of meshes and colours in every Object.
+    size_t host_bytes = MemoryAccounting::collect(session).host_bytes;
+    session.setGpuResidentObjects(false);
+    size_t host_bytes_with_copies = MemoryAccounting::collect(session).host_bytes;
+    session.setGpuResidentObjects(true);
+
+    FrameStats frame_stats(static_cast<size_t>(options.iterations));
+    FrameStats pick_stats(static_cast<size_t>(options.iterations));
+    FrameStats box_select_stats(static_cast<size_t>(options.iterations));
+    FrameStats box_select_queries_stats(static_cast<size_t>(options.iterations));
+    FrameStats hover_stats(static_cast<size_t>(options.iterations) * 3);
+    FrameStats hover_frame_stats(static_cast<size_t>(options.iterations) * 3);
+    FrameStats drag_stats(static_cast<size_t>(options.iterations));
+
+    std::uniform_real_distribution<double> cursor_x(0, options.width - 1);
+    std::uniform_real_distribution<double> cursor_y(0, options.height - 1);
+
+    // Warm-up frame: the first draw compiles shaders of the driver and is not representative.
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    drawing_lib.drawFrame(false);
+    glFinish();
+
+    for (int i = 0; i < options.iterations; i++)
+    {
+        auto frame_start = Clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawing_lib.drawFrame(false);
+        glFinish();
+        frame_stats.add(millisecondsSince(frame_start));
+    }
+
+    size_t picked_objects = 0;
+    for (int i = 0; i < options.iterations; i++)
+    {
+        auto pick_start = Clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawing_lib.drawFrame(true);
+        if (drawing_lib.readObjectIdAt(cursor_x(random), cursor_y(random)) >= 0)
+        {
+            picked_objects++;
+        }
+        pick_stats.add(millisecondsSince(pick_start));
+    }
+
+    size_t box_selected_objects = 0;
+    size_t box_select_queries_objects = 0;
+    size_t box_select_queries_missed = 0;
+    for (int i = 0; i < options.iterations; i++)
+    {
+        // Selection rectangles of random size, like an operator dragging over part of the scene.
+        int x0 = static_cast<int>(cursor_x(random)), x1 = static_cast<int>(cursor_x(random));
+        int y0 = static_cast<int>(cursor_y(random)), y1 = static_cast<int>(cursor_y(random));
+
+        auto box_start = Clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawing_lib.drawFrame(true);
+        auto read_ids = drawing_lib.readObjectIdsInRect(x0, y0, x1, y1);
+        box_select_stats.add(millisecondsSince(box_start));
+        box_selected_objects += read_ids.size();
+
+        auto queries_start = Clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawing_lib.drawFrame(true);
+        auto query_ids = drawing_lib.queryObjectIdsInRect(x0, y0, x1, y1);
+        box_select_queries_stats.add(millisecondsSince(queries_start));
+
+        box_select_queries_objects += query_ids.size();
+        for (auto id: read_ids)
+        {
+            if (!std::binary_search(query_ids.begin(), query_ids.end(), id))
+            {
+                box_select_queries_missed++;
+            }
+        }
+    }
+
+    size_t hover_agreements = 0;
+    for (int i = 0; i < options.iterations; i++)
+    {
+        // Whole pixels, so both ways of picking below read the same pixel.
+        double x = std::floor(cursor_x(random)), y = std::floor(cursor_y(random));
+        for (int frame = 0; frame < 3; frame++)
+        {
+            auto frame_start = Clock::now();
+            drawing_lib.updateHoverPick(x, y);
+            hover_stats.add(millisecondsSince(frame_start));
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            drawing_lib.drawFrame(false);
+            glFinish();
+            hover_frame_stats.add(millisecondsSince(frame_start));
+        }
+
+        int hovered_object = drawing_lib.getHoveredObject();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        drawing_lib.drawFrame(true);
+        // readObjectIdAt reads the row one pixel above the one under the cursor (window_height - y).
+        if (drawing_lib.readObjectIdAt(x, y + 1.0) == hovered_object)
+        {
+            hover_agreements++;
+        }
+    }
+    const auto& hover_pick_stats = Config::getHoverPickStats();
+
+    auto& parameters = Config::getParameters();
+    parameters.view_layout = ViewLayout::kQuad;
+    FrameStats views_stats(static_cast<size_t>(options.iterations));
+    FrameStats views_without_culling_stats(static_cast<size_t>(options.iterations));
+    ViewStats view_counts;
+    for (bool culling: {true, false})
+    {
+        parameters.view_culling = culling;
+        for (int i = 0; i < options.iterations; i++)
+        {
+            auto frame_start = Clock::now();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            drawing_lib.drawFrame(false);
+            glFinish();
+            (culling ? views_stats : views_without_culling_stats).add(millisecondsSince(frame_start));
+        }
+        if (culling)
+        {
+            view_counts = Config::getViewStats();
+        }
+    }
+    // The side and top views look along rows of Objects, so many of them hide others.
+    FrameStats views_occlusion_stats(static_cast<size_t>(options.iterations));
+    parameters.view_culling = true;
+    parameters.occlusion_culling = true;
+    measureFrames(drawing_lib, options.iterations, views_occlusion_stats);
+    const ViewStats occlusion_counts = Config::getViewStats();
+    parameters.occlusion_culling = false;
+    parameters.view_layout = ViewLayout::kSingle;
+    parameters.view_culling = true;
+    glViewport(0, 0, options.width, options.height);
+
+    FrameStats compact_frame_stats(static_cast<size_t>(options.iterations));
+    session.setVertexFormat(VertexFormat::kCompact);
+    measureFrames(drawing_lib, options.iterations, compact_frame_stats);
+    session.setVertexFormat(VertexFormat::kFloat);
+
+    // Every built-in mesh alone, so differences between the formats are not averaged over meshes of other sizes.
+    std::ostringstream meshes_json;
+    for (int type = 0; type < kBuiltinObjectTypeCount; type++)
+    {
+        auto object_type = static_cast<ObjectType>(type);
+        Session mesh_session;
+        DrawingLib mesh_drawing_lib(mesh_session);
+        mesh_drawing_lib.setWindowSize(options.width, options.height);
+        addObjects(mesh_session, object_type, options.objects_per_type, random);
+
+        FrameStats float_stats(static_cast<size_t>(options.iterations));
+        FrameStats compact_stats(static_cast<size_t>(options.iterations));
+        measureFrames(mesh_drawing_lib, options.iterations, float_stats);
+        mesh_session.setVertexFormat(VertexFormat::kCompact);
+        size_t compact_bytes = MeshBufferCache::getByteSize(object_type);
+        measureFrames(mesh_drawing_lib, options.iterations, compact_stats);
+        mesh_session.setVertexFormat(VertexFormat::kFloat);
+
+        meshes_json << (type == 0 ? "\n" : ",\n") << R"(    {"name": ")"
+                    << mesh_session.getObjects().front().ObjectTypeToString() << R"(", "float_bytes": )"
+                    << MeshBufferCache::getByteSize(object_type) << R"(, "compact_bytes": )" << compact_bytes
+                    << R"(, "float_frame_mean_ms": )" << float_stats.mean()
+                    << R"(, "compact_frame_mean_ms": )" << compact_stats.mean() << "}";
+        mesh_drawing_lib.releaseBuffers();
+        mesh_session.clear();
+    }
+
+    FrameCapture frame_capture;
+    FrameStats capture_frame_stats(static_cast<size_t>(options.iterations));
+    FrameCaptureStats capture_stats;
+    if (!options.capture.empty())
+    {
+        frame_capture.start(options.capture, CaptureFormat::kRawVideo);
+        for (int i = 0; i < options.iterations; i++)
+        {
+            auto frame_start = Clock::now();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            drawing_lib.drawFrame(false);
+            // A software renderer draws only when it has to: without finishing first, glReadPixels would wait for
+            // the whole frame and its time would count as capture.
+            glFinish();
+            frame_capture.captureFrame(options.width, options.height);
+            capture_frame_stats.add(millisecondsSince(frame_start));
+        }
+        frame_capture.stop();
+        capture_stats = frame_capture.getStats();
+    }
+
+    session.selectAllObjects();
+    const auto& selected_objects = session.getSelection();
+    for (int i = 0; i < options.iterations; i++)
+    {
+        // Small back-and-forth movement, so Objects stay in view.
+        double delta = (i % 2 == 0) ? 0.01 : -0.01;
+        auto drag_start = Clock::now();
+        session.updateObjectsCoordinates(selected_objects, delta, delta);
+        session.updateObjectsGuiCoordinates(selected_objects, static_cast<float>(options.width),
+                                            static_cast<float>(options.height), 1.0, 1.0);
+        drag_stats.add(millisecondsSince(drag_start));
+    }
+
+    // A large scene created at once, and Objects created one by one for comparison.
+    FrameStats add_object_stats(static_cast<size_t>(options.iterations));
+    double add_objects_ms;
+    {
+        Session batch_session;
+        ObjectLayout layout;
+        layout.columns = 316;
+        layout.spacing = 0.05f;
+        auto batch_start = Clock::now();
+        batch_session.addObjects(kCube, kBatchObjectCount, layout);
+        add_objects_ms = millisecondsSince(batch_start);
+        batch_session.clear();
+
+        for (int i = 0; i < options.iterations; i++)
+        {
+            auto add_start = Clock::now();
+            batch_session.add_object(kCube);
+            add_object_stats.add(millisecondsSince(add_start));
+        }
+        batch_session.clear();
+    }
+
+    // Meshes removed from the middle of the shared buffers leave free blocks, which compaction merges.
+    FrameStats generated_frame_stats(static_cast<size_t>(options.iterations));
+    MeshBufferStats fragmented_stats;
+    MeshBufferStats compacted_stats;
+    double compact_ms;
+    {
+        Session generated_session;
+        DrawingLib generated_drawing_lib(generated_session);
+        generated_drawing_lib.setWindowSize(options.width, options.height);
+        std::vector<ObjectType> generated_types;
+        for (int i = 0; i < kGeneratedMeshCount; i++)
+        {
+            PrimitiveParameters parameters;
+            parameters.segments = 8 + i;
+            parameters.rings = 4 + i / 2;
+            generated_types.push_back(PrimitiveGenerator::getObjectType(parameters));
+            addObjects(generated_session, generated_types.back(), std::max(options.objects_per_type / 10, 1), random);
+        }
+        measureFrames(generated_drawing_lib, options.iterations, generated_frame_stats);
+
+        // Session::remove_object takes an index in the vector of Objects, so they are removed from the back.
+        const auto& objects = generated_session.getObjects();
+        for (int index = static_cast<int>(objects.size()) - 1; index >= 0; index--)
+        {
+            auto found = std::find(generated_types.begin(), generated_types.end(), objects[index].getObjectType());
+            if ((found - generated_types.begin()) % 2 == 1)
+            {
+                generated_session.remove_object(index);
+            }
+        }
+        fragmented_stats = MeshBufferCache::getStats();
+
+        auto compact_start = Clock::now();
+        generated_session.compactMeshBuffers();
+        glFinish();
+        compact_ms = millisecondsSince(compact_start);
+        compacted_stats = MeshBufferCache::getStats();
+
+        generated_drawing_lib.releaseBuffers();
+        generated_session.clear();
+    }
+    auto buffer_stats_json = [](const MeshBufferStats& stats) {
+        std::ostringstream stats_json;
+        stats_json << R"({"mesh_count": )" << stats.mesh_count << R"(, "byte_size": )" << stats.byte_size
+                   << R"(, "buffer_capacity": )" << stats.buffer_capacity << R"(, "free_bytes": )" << stats.free_bytes
+                   << R"(, "free_block_count": )" << stats.free_block_count
+                   << R"(, "largest_free_block": )" << stats.largest_free_block << "}";
+        return stats_json.str();
+    };
+
+    std::ostringstream json;
+    json << "{\n"
+         << "  \"renderer\": \"" << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << "\",\n"
+         << "  \"width\": " << options.width << ",\n"
+         << "  \"height\": " << options.height << ",\n"
+         << "  \"objects_per_type\": " << options.objects_per_type << ",\n"
+         << "  \"object_count\": " << session.getObjects().size() << ",\n"
+         << "  \"iterations\": " << options.iterations << ",\n"
+         << "  \"populate_ms\": " << populate_ms << ",\n"
+         << "  \"host_bytes\": " << host_bytes << ",\n"
+         << "  \"host_bytes_with_object_copies\": " << host_bytes_with_copies << ",\n"
+         << "  \"frame\": " << statsToJson(frame_stats) << ",\n"
+         << "  \"pick\": " << statsToJson(pick_stats) << ",\n"
+         << "  \"pick_hit_rate\": " << static_cast<double>(picked_objects) / options.iterations << ",\n"
+         << "  \"box_select\": " << statsToJson(box_select_stats) << ",\n"
+         << "  \"box_select_mean_objects\": " << static_cast<double>(box_selected_objects) / options.iterations << ",\n"
+         << "  \"box_select_queries\": " << statsToJson(box_select_queries_stats) << ",\n"
+         << "  \"box_select_queries_mean_objects\": "
+         << static_cast<double>(box_select_queries_objects) / options.iterations << ",\n"
+         << "  \"box_select_queries_missed_objects\": " << box_select_queries_missed << ",\n"
+         << "  \"hover_pick\": " << statsToJson(hover_stats) << ",\n"
+         << "  \"hover_pick_frame\": " << statsToJson(hover_frame_stats) << ",\n"
+         << "  \"hover_pick_pixels_rendered\": " << hover_pick_stats.pixels_rendered << ",\n"
+         << "  \"hover_pick_cache_hits\": " << hover_pick_stats.cache_hits << ",\n"
+         << "  \"hover_pick_results_not_ready\": " << hover_pick_stats.results_not_ready << ",\n"
+         << "  \"hover_pick_agreement\": " << static_cast<double>(hover_agreements) / options.iterations << ",\n"
+         << "  \"views_2x2\": " << statsToJson(views_stats) << ",\n"
+         << "  \"views_2x2_without_culling\": " << statsToJson(views_without_culling_stats) << ",\n"
+         << "  \"views_2x2_drawn_objects\": " << view_counts.drawn << ",\n"
+         << "  \"views_2x2_objects_without_edges\": " << view_counts.without_edges << ",\n"
+         << "  \"views_2x2_occlusion_culling\": " << statsToJson(views_occlusion_stats) << ",\n"
+         << "  \"views_2x2_occluders\": " << occlusion_counts.occluders << ",\n"
+         << "  \"views_2x2_occluded_objects\": " << occlusion_counts.occluded << ",\n"
+         << "  \"frame_compact_vertices\": " << statsToJson(compact_frame_stats) << ",\n"
+         << "  \"meshes\": [" << meshes_json.str() << "\n  ],\n"
+         << "  \"add_objects_count\": " << kBatchObjectCount << ",\n"
+         << "  \"add_objects_ms\": " << add_objects_ms << ",\n"
+         << "  \"add_object\": " << statsToJson(add_object_stats) << ",\n"
+         << "  \"frame_generated_meshes\": " << statsToJson(generated_frame_stats) << ",\n"
+         << "  \"mesh_buffers_fragmented\": " << buffer_stats_json(fragmented_stats) << ",\n"
+         << "  \"mesh_buffers_compacted\": " << buffer_stats_json(compacted_stats) << ",\n"
+         << "  \"mesh_buffers_compact_ms\": " << compact_ms << ",\n"
+         << "  \"drag_event\": " << statsToJson(drag_stats);
+    if (!options.capture.empty())
+    {
+        json << ",\n  \"capture\": " << statsToJson(frame_capture.getOverhead()) << ",\n"
+             << "  \"capture_frame\": " << statsToJson(capture_frame_stats) << ",\n"
+             << "  \"capture_frames_written\": " << capture_stats.frames_written << ",\n"
+             << "  \"capture_dropped_gpu_busy\": " << capture_stats.dropped_gpu_busy << ",\n"
+             << "  \"capture_dropped_encoder_busy\": " << capture_stats.dropped_encoder_busy;
+    }
+    json << "\n}\n";
+
+    return writeOutput(options, json.str());
+}
@@ -0,0 +1,321 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/math3d.h"
+
+// project_1_math_bench compares the math of the application before and after the move to math3d
+// (the previous code is kept here as reference implementations):
+//   rotation_delta - rotation for a cursor movement: Euler matrices with trig vs quaternions;
+//   model_matrix   - model matrix of an Object with zoom applied: scalar loops vs Mat4;
+//   mat4_multiply  - model-view matrix: scalar 4x4 product (what glMultMatrixf does) vs SSE Mat4 product;
+//   cursor_delta   - cursor movement to scene coordinates: linear NDC scaling vs project/unproject.
+// Every case also reports the largest difference between both results, so the benchmark checks them as well.
+// No OpenGL context is needed. Results are written as JSON to stdout.
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr float kSensitivity = 0.5f;
+
+struct CaseResult
+{
+    double reference_ns;
+    double math3d_ns;
+    double max_difference;
+};
+
+// Keeps results observable, so the compiler can't remove the measured loops.
+volatile float sink;
+
+template <typename Function>
+double nanosecondsPerCall(int iterations, Function function)
+{
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+    {
+        function(i);
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+}
+
+double maxDifference(const float* a, const float* b, int count)
+{
+    double difference = 0.0;
+    for (int i = 0; i < count; i++)
+    {
+        difference = std::fmax(difference, std::fabs(a[i] - b[i]));
+    }
+    return difference;
+}
+
+void referenceRotationDelta(double delta_x, double delta_y, float delta_rotation[9])
+/* Previous Object::calculateRotationDelta. */
+{
+    const float pi = 3.14159265359f;
+    float radians_x = delta_y * kSensitivity * pi / 180.0f;
+    float radians_y = -delta_x * kSensitivity * pi / 180.0f;
+    float cos_x = std::cos(radians_x);
+    float sin_x = std::sin(radians_x);
+    float cos_y = std::cos(radians_y);
+    float sin_y = std::sin(radians_y);
+    const float rotation_y[9] = {cos_y, 0.0f, -sin_y,
+                                 0.0f,  1.0f, 0.0f,
+                                 sin_y, 0.0f, cos_y};
+    const float rotation_x[9] = {1.0f, 0.0f,  0.0f,
+                                 0.0f, cos_x, -sin_x,
+                                 0.0f, sin_x, cos_x};
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            delta_rotation[row * 3 + col] = rotation_x[row * 3] * rotation_y[col] +
+                                            rotation_x[row * 3 + 1] * rotation_y[3 + col] +
+                                            rotation_x[row * 3 + 2] * rotation_y[6 + col];
+        }
+    }
+}
+
+void math3dRotationDelta(double delta_x, double delta_y, float delta_rotation[9])
+/* Current Object::calculateRotationDelta. */
+{
+    float radians_x = math3d::radians(static_cast<float>(delta_y) * kSensitivity);
+    float radians_y = math3d::radians(static_cast<float>(delta_x) * kSensitivity);
+    math3d::Quat rotation = math3d::Quat::fromAxisAngle({1.0f, 0.0f, 0.0f}, radians_x) *
+                            math3d::Quat::fromAxisAngle({0.0f, 1.0f, 0.0f}, radians_y);
+    rotation.toRotation(delta_rotation);
+}
+
+void referenceModelMatrix(const float rotation[9], const float translation[3], const float center[3], float zoom,
+                          float matrix[16])
+/* Previous Object::getModelMatrix and the zoom of Object::fillDrawItem. */
+{
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            matrix[col * 4 + row] = rotation[row * 3 + col];
+        }
+        matrix[12 + row] = center[row] + translation[row] -
+                           (rotation[row * 3] * center[0] + rotation[row * 3 + 1] * center[1] +
+                            rotation[row * 3 + 2] * center[2]);
+        matrix[row * 4 + 3] = 0.0f;
+    }
+    matrix[15] = 1.0f;
+    for (int col = 0; col < 4; col++)
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            matrix[col * 4 + row] *= zoom;
+        }
+    }
+}
+
+math3d::Mat4 math3dModelMatrix(const float rotation[9], const float translation[3], const float center[3], float zoom)
+/* Current Object::getModelMatrix and the zoom of Object::fillDrawItem. */
+{
+    return math3d::Mat4::rotationAround(rotation, center, translation, zoom);
+}
+
+void referenceMultiply(const float a[16], const float b[16], float result[16])
+{
+    for (int col = 0; col < 4; col++)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++)
+            {
+                sum += a[k * 4 + row] * b[col * 4 + k];
+            }
+            result[col * 4 + row] = sum;
+        }
+    }
+}
+
+struct View
+{
+    float left{-1.0f}, right{1.0f}, bottom{-0.5625f}, top{0.5625f}, near_plane{1.0f}, far_plane{50.0f};
+    float depth{8.0f};
+    float width{1920.0f}, height{1080.0f};
+};
+
+void referenceCursorDelta(const View& view, double delta_x, double delta_y, float delta[2])
+/* Previous DrawingLib::calculateCoordinatesOnMouseMove. */
+{
+    double ndc_delta_x = delta_x / (view.width / 2.0f);
+    double ndc_delta_y = delta_y / (view.height / 2.0f);
+    delta[0] = static_cast<float>(ndc_delta_x * (view.right - view.left) / 2.0f * view.depth);
+    delta[1] = static_cast<float>(ndc_delta_y * (view.top - view.bottom) / 2.0f * view.depth);
+}
+
+void math3dCursorDelta(const math3d::Mat4& view_projection, const math3d::Mat4& inverse_view_projection,
+                       const math3d::Viewport& viewport, double delta_x, double delta_y, float delta[2])
+/* Current DrawingLib::calculateCoordinatesOnMouseMove. */
+{
+    const math3d::Vec3 origin = math3d::project({0.0f, 0.0f, 0.0f}, view_projection, viewport);
+    const math3d::Vec3 moved(origin.x + static_cast<float>(delta_x), origin.y - static_cast<float>(delta_y), origin.z);
+    const math3d::Vec3 scene_delta = math3d::unproject(moved, inverse_view_projection, viewport) -
+                                     math3d::unproject(origin, inverse_view_projection, viewport);
+    delta[0] = scene_delta.x;
+    delta[1] = -scene_delta.y;
+}
+
+std::string caseToJson(const CaseResult& result)
+{
+    char buffer[160];
+    std::snprintf(buffer, sizeof(buffer), R"({"reference_ns": %.2f, "math3d_ns": %.2f, "max_difference": %.3g})",
+                  result.reference_ns, result.math3d_ns, result.max_difference);
+    return buffer;
+}
+}
+
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    if (iterations <= 0)
+    {
+        std::cout << "Usage: project_1_math_bench [iterations]  (default 1000000)\n";
+        return 1;
+    }
+
+    // Inputs are prepared in advance, so only the math is measured.
+    const int input_count = 1024;
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> cursor(-20.0f, 20.0f);
+    std::vector<float> deltas(input_count * 2);
+    std::vector<float> rotations(input_count * 9);
+    for (int i = 0; i < input_count; i++)
+    {
+        deltas[i * 2] = cursor(random);
+        deltas[i * 2 + 1] = cursor(random);
+        referenceRotationDelta(deltas[i * 2], deltas[i * 2 + 1], &rotations[i * 9]);
+    }
+    const float translation[3] = {0.3f, -1.2f, 0.5f};
+    const float center[3] = {0.1f, 0.2f, -0.1f};
+
+    CaseResult rotation_delta{};
+    CaseResult model_matrix{};
+    CaseResult mat4_multiply{};
+    CaseResult cursor_delta{};
+
+    // Rotation for a cursor movement.
+    {
+        float reference[9];
+        float result[9];
+        for (int i = 0; i < input_count; i++)
+        {
+            referenceRotationDelta(deltas[i * 2], deltas[i * 2 + 1], reference);
+            math3dRotationDelta(deltas[i * 2], deltas[i * 2 + 1], result);
+            rotation_delta.max_difference = std::fmax(rotation_delta.max_difference, maxDifference(reference, result, 9));
+        }
+        rotation_delta.reference_ns = nanosecondsPerCall(iterations, [&](int i) {
+            int k = i % input_count;
+            referenceRotationDelta(deltas[k * 2], deltas[k * 2 + 1], reference);
+            sink = reference[4];
+        });
+        rotation_delta.math3d_ns = nanosecondsPerCall(iterations, [&](int i) {
+            int k = i % input_count;
+            math3dRotationDelta(deltas[k * 2], deltas[k * 2 + 1], result);
+            sink = result[4];
+        });
+    }
+
+    // Model matrix of an Object.
+    {
+        float reference[16];
+        for (int i = 0; i < input_count; i++)
+        {
+            referenceModelMatrix(&rotations[i * 9], translation, center, 1.5f, reference);
+            math3d::Mat4 result = math3dModelMatrix(&rotations[i * 9], translation, center, 1.5f);
+            model_matrix.max_difference = std::fmax(model_matrix.max_difference, maxDifference(reference, result.m, 16));
+        }
+        model_matrix.reference_ns = nanosecondsPerCall(iterations, [&](int i) {
+            referenceModelMatrix(&rotations[(i % input_count) * 9], translation, center, 1.5f, reference);
+            sink = reference[12];
+        });
+        model_matrix.math3d_ns = nanosecondsPerCall(iterations, [&](int i) {
+            math3d::Mat4 result = math3dModelMatrix(&rotations[(i % input_count) * 9], translation, center, 1.5f);
+            sink = result.m[12];
+        });
+    }
+
+    // Model-view matrix: view matrix * model matrix.
+    {
+        const math3d::Mat4 view_matrix = math3d::Mat4::translation(0.0f, 0.0f, -8.0f);
+        std::vector<math3d::Mat4> models(input_count);
+        for (int i = 0; i < input_count; i++)
+        {
+            models[i] = math3dModelMatrix(&rotations[i * 9], translation, center, 1.5f);
+        }
+        float reference[16];
+        for (int i = 0; i < input_count; i++)
+        {
+            referenceMultiply(view_matrix.m, models[i].m, reference);
+            math3d::Mat4 result = view_matrix * models[i];
+            mat4_multiply.max_difference = std::fmax(mat4_multiply.max_difference, maxDifference(reference, result.m, 16));
+        }
+        mat4_multiply.reference_ns = nanosecondsPerCall(iterations, [&](int i) {
+            referenceMultiply(view_matrix.m, models[i % input_count].m, reference);
+            sink = reference[14];
+        });
+        mat4_multiply.math3d_ns = nanosecondsPerCall(iterations, [&](int i) {
+            math3d::Mat4 result = view_matrix * models[i % input_count];
+            sink = result.m[14];
+        });
+    }
+
+    // Cursor movement to scene coordinates.
+    {
+        View view;
+        const math3d::Mat4 view_projection =
+                math3d::Mat4::frustum(view.left, view.right, view.bottom, view.top, view.near_plane, view.far_plane) *
+                math3d::Mat4::translation(0.0f, 0.0f, -view.depth);
+        math3d::Mat4 inverse_view_projection;
+        math3d::inverse(view_projection, inverse_view_projection);
+        const math3d::Viewport viewport{0.0f, 0.0f, view.width, view.height};
+
+        float reference[2];
+        float result[2];
+        for (int i = 0; i < input_count; i++)
+        {
+            referenceCursorDelta(view, deltas[i * 2], deltas[i * 2 + 1], reference);
+            math3dCursorDelta(view_projection, inverse_view_projection, viewport, deltas[i * 2], deltas[i * 2 + 1], result);
+            cursor_delta.max_difference = std::fmax(cursor_delta.max_difference, maxDifference(reference, result, 2));
+        }
+        cursor_delta.reference_ns = nanosecondsPerCall(iterations, [&](int i) {
+            int k = i % input_count;
+            referenceCursorDelta(view, deltas[k * 2], deltas[k * 2 + 1], reference);
+            sink = reference[0];
+        });
+        cursor_delta.math3d_ns = nanosecondsPerCall(iterations, [&](int i) {
+            int k = i % input_count;
+            math3dCursorDelta(view_projection, inverse_view_projection, viewport, deltas[k * 2], deltas[k * 2 + 1], result);
+            sink = result[0];
+        });
+    }
+
+    std::ostringstream json;
+    json << "{\n"
+#ifdef PROJECT_1_MATH3D_SSE
+         << "  \"sse\": true,\n"
+#else
+         << "  \"sse\": false,\n"
+#endif
+         << "  \"iterations\": " << iterations << ",\n"
+         << "  \"rotation_delta\": " << caseToJson(rotation_delta) << ",\n"
+         << "  \"model_matrix\": " << caseToJson(model_matrix) << ",\n"
+         << "  \"mat4_multiply\": " << caseToJson(mat4_multiply) << ",\n"
+         << "  \"cursor_delta\": " << caseToJson(cursor_delta) << "\n"
+         << "}\n";
+    std::cout << json.str();
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <stdexcept>
+#include <string>
+
+#include "offscreen_context.h"
+#include <EGL/eglext.h>
+
+
+OffscreenContext::OffscreenContext(int width, int height) : width_(width), height_(height)
+{
+    // The surfaceless platform doesn't need a display server. If it isn't available, the default display is used.
+    auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (get_platform_display != nullptr)
+    {
+        display_ = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display_ == EGL_NO_DISPLAY)
+    {
+        display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major, minor;
+    if (display_ == EGL_NO_DISPLAY || !eglInitialize(display_, &major, &minor))
+    {
+        throw std::runtime_error("Failed to initialize an EGL display.");
+    }
+
+    // The application draws with the fixed-function pipeline, so a compatibility context is needed.
+    eglBindAPI(EGL_OPENGL_API);
+    const EGLint config_attributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint config_count = 0;
+    eglChooseConfig(display_, config_attributes, &config, 1, &config_count);
+
+    context_ = eglCreateContext(display_, config_count > 0 ? config : nullptr, EGL_NO_CONTEXT, nullptr);
+    if (context_ == EGL_NO_CONTEXT || !eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, context_))
+    {
+        eglTerminate(display_);
+        throw std::runtime_error("Failed to create an off-screen OpenGL context (EGL error " + std::to_string(eglGetError()) + ").");
+    }
+
+    // GLEW reports a missing GLX display when the context is created with EGL, but OpenGL functions are loaded anyway.
+    glewExperimental = GL_TRUE;
+    GLenum result = glewInit();
+    if (result != GLEW_OK && result != GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        throw std::runtime_error(std::string("Failed to initialize GLEW: ") + reinterpret_cast<const char*>(glewGetErrorString(result)));
+    }
+
+    // Without a window there is no default framebuffer, all drawing goes into a framebuffer object.
+    glGenFramebuffers(1, &framebuffer_);
+    glGenRenderbuffers(1, &color_buffer_);
+    glGenRenderbuffers(1, &depth_buffer_);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, color_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width_, height_);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_buffer_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        throw std::runtime_error("Off-screen framebuffer is incomplete.");
+    }
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glDrawBuffer(GL_COLOR_ATTACHMENT0);
+}
+
+OffscreenContext::~OffscreenContext()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer_);
+    glDeleteRenderbuffers(1, &color_buffer_);
+    glDeleteRenderbuffers(1, &depth_buffer_);
+
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display_, context_);
+    eglTerminate(display_);
+}
@@ -0,0 +1,34 @@
+#ifndef PROJECT_1_OFFSCREEN_CONTEXT_H
+#define PROJECT_1_OFFSCREEN_CONTEXT_H
+
+#include <EGL/egl.h>
+#include <GL/glew.h>
+
+class OffscreenContext
+/** OffscreenContext creates an OpenGL compatibility context without a window through EGL (surfaceless platform when
+available, e.g. Mesa llvmpipe without a GPU) and a framebuffer object of the given size to render into.
+The framebuffer stays bound, so everything drawn afterwards goes into it and can be read with glReadPixels. */
+{
+public:
+    OffscreenContext(int width, int height);
+    ~OffscreenContext();
+
+    OffscreenContext(const OffscreenContext&) = delete;
+    OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+    int width() const{return width_;}
+    int height() const{return height_;}
+
+private:
+    int width_;
+    int height_;
+
+    EGLDisplay display_{EGL_NO_DISPLAY};
+    EGLContext context_{EGL_NO_CONTEXT};
+
+    GLuint framebuffer_{};
+    GLuint color_buffer_{};
+    GLuint depth_buffer_{};
+};
+
+#endif //PROJECT_1_OFFSCREEN_CONTEXT_H
@@ -0,0 +1,45 @@
+#ifndef PROJECT_1_BUFFER_ALLOCATOR_H
+#define PROJECT_1_BUFFER_ALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+
+class BufferAllocator
+/** BufferAllocator hands out byte ranges of one buffer of a fixed capacity, e.g. meshes in the shared vertex and index
+buffers of MeshBufferCache. Free ranges are kept in a list sorted by offset: allocate takes the first one that is
+large enough (first fit), free merges a range with its free neighbours, so free space is never split into more
+blocks than there are gaps between allocated ranges. Sizes and offsets are multiples of kAlignment.
+The allocator only does the bookkeeping, the buffer itself belongs to the caller. */
+{
+public:
+    // Enough for offsets of floats, 16- and 32-bit indices and 16-bit positions.
+    static constexpr size_t kAlignment = 16;
+    static constexpr size_t kNoSpace = static_cast<size_t>(-1);
+
+    explicit BufferAllocator(size_t capacity = 0){reset(capacity);};
+
+    size_t allocate(size_t size);
+    void free(size_t offset, size_t size);
+    void grow(size_t capacity);
+    void reset(size_t capacity);
+
+    static size_t alignedSize(size_t size){return (size + kAlignment - 1) / kAlignment * kAlignment;};
+
+    size_t getCapacity() const{return capacity_;};
+    size_t getUsedBytes() const{return used_bytes_;};
+    size_t getFreeBlockCount() const{return free_blocks_.size();};
+    size_t getLargestFreeBlock() const;
+
+private:
+    struct Block
+    {
+        size_t offset;
+        size_t size;
+    };
+    size_t capacity_{0};
+    size_t used_bytes_{0};
+    // Sorted by offset, neighbouring blocks are never adjacent.
+    std::vector<Block> free_blocks_;
+};
+
+#endif //PROJECT_1_BUFFER_ALLOCATOR_H
@@ -1,6 +1,16 @@
 #ifndef PROJECT_1_CONFIG_H
 #define PROJECT_1_CONFIG_H
 
+#include "../include/frame_stats.h"
+
+// How the window is divided into views of the scene (see SceneView).
+enum class ViewLayout : int
+{
+    kSingle,      // one view over the whole window
+    kSideBySide,  // two views, left and right
+    kQuad         // four views in a 2x2 grid
+};
+
 // Parameters struct contain variables that are used by both ImGui windows (Main panel and individual objects' panel)
 // and by Drawing library to draw OpenGL objects.
 struct Parameters
@@ -8,16 +18,68 @@ struct Parameters
     bool show_metadata{false};
     bool lock_gui_to_objects{false};
     float rotation_sensitivity{0.5};
+    // Draw frames only after something has changed instead of continuously (see FrameScheduler).
+    bool render_on_demand{true};
+    // Find Objects inside the selection rectangle with occlusion queries instead of reading back its pixels.
+    bool box_select_occlusion_queries{false};
+    // Highlight the Object under the cursor (see HoverPicker).
+    bool hover_picking{true};
+    ViewLayout view_layout{ViewLayout::kSingle};
+    // Skip Objects outside of a view or smaller than a pixel and draw small ones without edges (see SceneView::cull).
+    bool view_culling{true};
+    // Skip Objects hidden behind large convex Objects in front of them (see OcclusionCuller).
+    bool occlusion_culling{false};
+};
+
+// InputStats counts mouse events received from GLFW and updates applied to the scene. Events are accumulated and
+// applied once per frame, so with a high polling rate mouse there are several events per applied update.
+struct InputStats
+{
+    unsigned long long cursor_events_received{0};
+    unsigned long long cursor_updates_applied{0};
+    unsigned long long scroll_events_received{0};
+    unsigned long long scroll_updates_applied{0};
+};
+
+// HoverPickStats shows how often hover picking has to render the pixel under the cursor and what it costs the frame.
+struct HoverPickStats
+{
+    unsigned long long frames{0};
+    unsigned long long pixels_rendered{0};
+    unsigned long long cache_hits{0};
+    unsigned long long results_not_ready{0};
+    // Time spent in HoverPicker::update per frame.
+    FrameStats overhead_ms{600};
+};
+
+// ViewStats shows what the views did with the Objects in the last frame, summed over all views.
+struct ViewStats
+{
+    unsigned long long views{0};
+    unsigned long long objects{0};
+    unsigned long long outside_frustum{0};
+    unsigned long long too_small{0};
+    unsigned long long without_edges{0};
+    // Objects drawn into the depth buffer of OcclusionCuller, and Objects it found hidden behind them (not drawn).
+    unsigned long long occluders{0};
+    unsigned long long occluded{0};
+    unsigned long long drawn{0};
 };
 
 class Config
-/** Config class is used across the whole application to get access to Parameters. */
+/** Config class is used across the whole application to get access to Parameters and statistics. */
 {
 public:
     static Parameters& getParameters(){return parameters_;}
+    static InputStats& getInputStats(){return input_stats_;}
+    static HoverPickStats& getHoverPickStats(){return hover_pick_stats_;}
+    static ViewStats& getViewStats(){return view_stats_;}
 
 private:
     static Parameters parameters_;
+    static InputStats input_stats_;
+    static HoverPickStats hover_pick_stats_;
+    static ViewStats view_stats_;
 };
 
 
@@ -5,61 +5,152 @@
 #include <GLFW/glfw3.h>
 #include <set>
 
+#include "../include/math3d.h"
 #include "../include/session.h"
+#include "../include/scene_updater.h"
+#include "../include/hover_picker.h"
+#include "../include/scene_view.h"
+#include "../include/occlusion_culler.h"
+
+class InputRecorder;
+class FrameCapture;
+
+// Mouse input as DrawingLib handles it, from a GLFW callback or from a recording (see InputReplay).
+// time is glfwGetTime() when the event arrived, x and y are the cursor position in window coordinates.
+struct InputEvent
+{
+    enum Type : uint8_t
+    {
+        kMouseButton,
+        kCursorPosition,
+        kScroll,
+        kCursorEnter
+    };
+
+    Type type;
+    double time{0};
+    double x{0};
+    double y{0};
+    double scroll_y{0};
+    int button{0};
+    // GLFW_PRESS or GLFW_RELEASE for kMouseButton, GLFW_TRUE or GLFW_FALSE (entered, left) for kCursorEnter.
+    int action{0};
+    int mods{0};
+};
 
 class DrawingLib
 {
 public:
-    explicit DrawingLib(Session& session) : session_(session){};
+    static constexpr int kMaxViews = 4;
+
+    explicit DrawingLib(Session& session);
 
     GLFWwindow* createWindow() const;
     void getWindowSize(GLFWwindow* window);
+    void setWindowSize(int width, int height);
+    int getWindowWidth() const{return window_width_;};
+    int getWindowHeight() const{return window_height_;};
+    void setSceneUpdater(SceneUpdater* scene_updater){scene_updater_ = scene_updater;};
+    void setInputRecorder(InputRecorder* input_recorder){input_recorder_ = input_recorder;};
+    void setFrameCapture(FrameCapture* frame_capture){frame_capture_ = frame_capture;};
     void defineCallbackFunction(GLFWwindow* window);
+    void releaseBuffers();
 
     void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
     void cursorPositionCallback(GLFWwindow* window, double xpos, double ypos);
     void scrollCallback(GLFWwindow* window, double yoffset);
+    void cursorEnterCallback(GLFWwindow* window, int entered);
+    void handleInput(const InputEvent& event);
+    void applyPendingInput();
+    void zoom(double zooming_factor);
+    int getViewCount() const{return view_count_;};
+    const SceneView& getView(int index) const{return views_[index];};
 
-    void drawFrame();
+    void drawFrame(bool get_pick_color);
     void drawScene(GLFWwindow* window, bool imGuiCaptureMouse);
+    bool renderScene(bool imGuiCaptureMouse);
     void drawFrameBox() const;
     void drawObjectsMetadata();
+    void drawViewBorders() const;
+
+    void updateHoverPick(double cursor_x, double cursor_y);
+    int getHoveredObject() const{return hover_picker_.getHoveredObject(session_.getStructureVersion());};
+
+    int readObjectIdAt(double x, double y) const;
+    std::vector<int> readObjectIdsInRect(int startX, int startY, int endX, int endY) const;
+    std::vector<int> queryObjectIdsInRect(int startX, int startY, int endX, int endY);
 
 private:
     Session& session_;
+    SceneUpdater* scene_updater_{nullptr};
+    InputRecorder* input_recorder_{nullptr};
+    FrameCapture* frame_capture_{nullptr};
+    RenderSnapshot local_snapshot_;
 
     int window_width_{1920};
     int window_height_{1080};
 
-    double left_{-1};
-    double right_{1};
-    double bottom_{-1};
-    double top_{1};
-    double near_{1};
-    double far_{50};
-
-    float dim_ratio_ = static_cast<float>(window_height_) / static_cast<float>(window_width_);
+    // Views of the scene with their own cameras (see SceneView), the first view_count_ of them are shown.
+    // Cameras are kept when the layout changes.
+    SceneView views_[kMaxViews];
+    int view_count_{1};
+    ViewLayout view_layout_{ViewLayout::kSingle};
+    // The view under the cursor when a button was pressed last: picking, dragging and the selection rectangle belong
+    // to it until the next press.
+    int active_view_{0};
+    // Objects of the view being drawn, reused every frame.
+    std::vector<VisibleItem> visible_items_;
+    OcclusionCuller occlusion_culler_;
 
     bool frame_box_{false};
     bool get_color_{false};
     bool left_button_down_{false};
     bool right_button_down_{false};
+    bool middle_button_down_{false};
+    bool cursor_in_window_{false};
 
     double cursor_pos_x_{0}, cursor_pos_y_{0};
     double current_pos_x_{0}, current_pos_y_{0}, prev_pos_x_{0}, prev_pos_y_{0};
     double start_pos_x_{0}, start_pos_y_{0};
 
-    std::vector<int> selected_object_id_{};
+    // Input accumulated by callbacks since the last frame (cursor movement in pixels, scroll steps)
+    double pending_move_x_{0}, pending_move_y_{0};
+    double pending_rotation_x_{0}, pending_rotation_y_{0};
+    double pending_orbit_x_{0}, pending_orbit_y_{0};
+    int pending_zoom_steps_[kMaxViews]{};
 
-    double depth_correction_factor_{8.0f};
+    // Objects that the current drag moves or rotates: the selection at the moment of the click plus the clicked Object.
+    SelectionSet manipulated_objects_;
+
+    // Matrices are computed on the CPU when the window size or a camera changes (see SceneView)
+    // and loaded with glLoadMatrixf, instead of being built on the driver's matrix stack every frame.
+    math3d::Mat4 frame_box_projection_;
+
+    // Occlusion query objects for box selection, created on first use and reused.
+    std::vector<GLuint> occlusion_queries_;
+    // Finds the Object under the cursor every frame for hover highlighting.
+    HoverPicker hover_picker_;
 
     double last_click_time_{0.0};
     const double DOUBLE_CLICK_TIME{0.25}; // 250 ms
+    const double ORBIT_DEGREES_PER_PIXEL{0.25};
     bool imgui_capture_mouse_{false};
     bool left_double_click_{false};
 
-    std::tuple<double, double> calculateCoordinatesOnMouseMove() const;
-    void zoom(double zooming_factor);
+    void handleMouseButton_(const InputEvent& event);
+    void handleCursorPosition_(const InputEvent& event);
+    void handleScroll_(const InputEvent& event);
+
+    std::tuple<double, double> calculateCoordinatesOnMouseMove(double delta_x, double delta_y) const;
+    void updateMatrices_();
+    void updateLayout_();
+    int getViewAt_(double x, double y) const;
+    void drawView_(const SceneView& view, const std::vector<ObjectDrawItem>& items, bool get_pick_color,
+                   int hovered_object, ViewStats& stats);
+    const std::vector<ObjectDrawItem>& currentDrawItems_();
+    std::tuple<double, double> clampToActiveView_(double x, double y) const;
+    void submitSceneCommand_(SceneCommand command);
+    bool isSnapshotCurrent_();
 
     std::set<std::array<unsigned char, 3>> getColorsInSelection(int startX, int startY, int endX, int endY) const;
 };
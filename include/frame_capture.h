@@ -0,0 +1,128 @@
+#ifndef PROJECT_1_FRAME_CAPTURE_H
+#define PROJECT_1_FRAME_CAPTURE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <GL/glew.h>
+
+#include "../include/frame_stats.h"
+
+enum class CaptureFormat : int
+{
+    kPng,       // one PNG file per frame: <path>_000001.png, ... (needs zlib)
+    kRawVideo   // all frames in <path>_<width>x<height>.rgb, 8-bit RGB, top row first
+};
+
+// Counters of FrameCapture since it was started. A frame is either written or dropped for one of the reasons.
+struct FrameCaptureStats
+{
+    unsigned long long frames{0};
+    unsigned long long frames_written{0};
+    // All pixel buffers are still read by the GPU.
+    unsigned long long dropped_gpu_busy{0};
+    // All pixel buffers wait for the encoder thread.
+    unsigned long long dropped_encoder_busy{0};
+    // Raw video keeps the size of its first frame.
+    unsigned long long dropped_size_changed{0};
+    unsigned long long write_errors{0};
+};
+
+class FrameCapture
+/** FrameCapture records the drawn frames to disk without stalling the render loop. The finished back buffer is copied
+into one of a ring of pixel buffer objects (glReadPixels returns without waiting for the GPU) and the buffer is mapped
+a few frames later, when its fence is signalled. Mapped buffers are handed to an encoder thread, which copies the
+pixels out, so the buffer can be reused, and writes PNG files or raw video. If no pixel buffer is free, because the
+GPU or the encoder is behind, the frame is dropped and counted instead of waiting.
+captureFrame, start and stop must be called on the thread that owns the OpenGL context; stop must be called before
+the context is destroyed. */
+{
+public:
+    static constexpr int kBufferCount = 4;
+    // Frames copied out of pixel buffers and not written yet, it bounds the memory of the encoder.
+    static constexpr size_t kMaxEncoderFrames = 4;
+
+    FrameCapture() = default;
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+    ~FrameCapture();
+
+    void start(const std::string& path, CaptureFormat format);
+    void stop();
+    bool isRunning() const{return running_;};
+    void captureFrame(int width, int height);
+
+    FrameCaptureStats getStats() const;
+    // Time spent in captureFrame per frame.
+    const FrameStats& getOverhead() const{return overhead_ms_;};
+    std::string getLastError() const;
+    static bool isPngAvailable();
+
+private:
+    enum class BufferState
+    {
+        kFree,
+        kReading,    // glReadPixels is queued, the fence is not signalled yet
+        kMapped,     // mapped and queued for the encoder thread
+        kReleased    // the encoder has copied the pixels, the buffer has to be unmapped
+    };
+
+    struct PixelBuffer
+    {
+        GLuint buffer{0};
+        GLsync fence{nullptr};
+        size_t capacity{0};
+        int width{0};
+        int height{0};
+        uint64_t frame_number{0};
+        const unsigned char* pixels{nullptr};
+        BufferState state{BufferState::kFree};
+    };
+
+    struct EncodedFrame
+    {
+        std::vector<unsigned char> rgb;
+        int width;
+        int height;
+    };
+
+    bool running_{false};
+    std::string path_;
+    CaptureFormat format_{CaptureFormat::kPng};
+    uint64_t frame_number_{0};
+    int next_buffer_{0};
+    PixelBuffer buffers_[kBufferCount];
+    FrameStats overhead_ms_{600};
+
+    // Guards buffer states (kMapped -> kReleased happens on the encoder thread) and everything below.
+    mutable std::mutex mutex_;
+    std::condition_variable wake_up_;
+    std::deque<int> mapped_buffers_;
+    bool stopping_{false};
+    FrameCaptureStats stats_;
+    std::string last_error_;
+    std::thread encoder_;
+
+    // Only used on the encoder thread.
+    std::ofstream raw_file_;
+    int raw_width_{0};
+    int raw_height_{0};
+    uint64_t written_count_{0};
+
+    void collectBuffers_(bool wait);
+    void issue_(PixelBuffer& buffer, int width, int height);
+    void releaseBuffers_();
+
+    void runEncoder_();
+    void writeFrame_(const EncodedFrame& frame);
+    void writePng_(const EncodedFrame& frame, const std::string& file_path);
+    void writeRaw_(const EncodedFrame& frame);
+};
+
+#endif //PROJECT_1_FRAME_CAPTURE_H
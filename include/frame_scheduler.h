@@ -0,0 +1,25 @@
+#ifndef PROJECT_1_FRAME_SCHEDULER_H
+#define PROJECT_1_FRAME_SCHEDULER_H
+
+#include <atomic>
+
+class FrameScheduler
+/** FrameScheduler tracks whether the window content is outdated. Session, DrawingLib and GuiPanels request a redraw
+when they change something visible; in on-demand mode (Parameters::render_on_demand) the main loop draws frames only
+while a redraw is pending and otherwise sleeps in glfwWaitEventsTimeout. */
+{
+public:
+    // ImGui needs a couple of frames after an input event to update hover state and layout.
+    static constexpr int kFramesAfterChange = 3;
+    // When nothing changes, one frame is still drawn per this interval, so statistics in panels stay current.
+    static constexpr double kIdleRefreshSeconds = 1.0;
+
+    static void requestRedraw(){pending_frames_ = kFramesAfterChange;};
+    static bool isRedrawPending(){return pending_frames_ > 0;};
+    static void frameDrawn();
+
+private:
+    static std::atomic<int> pending_frames_;
+};
+
+#endif //PROJECT_1_FRAME_SCHEDULER_H
@@ -0,0 +1,57 @@
+#ifndef PROJECT_1_FRAME_STATS_H
+#define PROJECT_1_FRAME_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <vector>
+
+class FrameStats
+/** FrameStats keeps the last `capacity` samples of a measured duration (e.g. frame time in milliseconds) in a ring
+buffer and calculates summary statistics over them. */
+{
+public:
+    explicit FrameStats(size_t capacity = 1000) : capacity_(capacity){samples_.reserve(capacity);}
+
+    void add(double sample);
+    void clear();
+
+    size_t size() const{return samples_.size();}
+    double mean() const;
+    double min() const;
+    double max() const;
+    double percentile(double fraction) const;
+
+    // Samples from the oldest to the newest, for plotting.
+    std::vector<float> orderedSamples() const;
+
+private:
+    size_t capacity_;
+    size_t next_{0};
+    std::vector<double> samples_;
+};
+
+class CpuUsage
+/** CpuUsage measures CPU time used by the process (all threads) relative to wall-clock time. The value is
+recalculated at most once per interval, so it can be updated every frame. */
+{
+public:
+    explicit CpuUsage(double interval_seconds = 1.0);
+
+    void update();
+    void countFrame(){frames_++;};
+
+    // CPU usage in percent of one core and drawn frames per second during the last complete interval.
+    double percent() const{return percent_;};
+    double framesPerSecond() const{return frames_per_second_;};
+
+private:
+    double interval_seconds_;
+    std::clock_t last_cpu_time_;
+    std::chrono::steady_clock::time_point last_wall_time_;
+    int frames_{0};
+    double percent_{0};
+    double frames_per_second_{0};
+};
+
+#endif //PROJECT_1_FRAME_STATS_H
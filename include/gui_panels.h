@@ -5,6 +5,11 @@
 #include "imgui.h"
 #include "../include/session.h"
 #include "../include/object.h"
+#include "../include/frame_stats.h"
+#include "../include/primitive_generator.h"
+#include "../include/scene_stress.h"
+#include "../include/memory_report.h"
+#include "../include/frame_capture.h"
 
 
 class GuiPanels
@@ -13,21 +18,57 @@ public:
     explicit GuiPanels(Session& session) : session_(session){ readme_txt_ = readTextFile("../ReadMe.txt");};
     void drawMainPanel();
     void drawObjectsPanels();
+    void addFrameTime(double milliseconds);
+    void setTimeToFirstFrame(double milliseconds){time_to_first_frame_ms_ = milliseconds;};
+    ZoomFlythrough& getFlythrough(){return flythrough_;};
+    FrameCapture& getFrameCapture(){return frame_capture_;};
 
 private:
     Session& session_;
 
     void drawObjectsTab();
     void drawCreateObjects();
+    void drawCreatePrimitives();
+    void drawUndoRedo();
+    void handleUndoShortcuts();
+    void recordColorEdit(int object_index);
+    void drawSceneFileControls();
+    void drawImportMesh();
     void drawObjectsList();
     void drawObjectItemInList(Object& object, int object_id);
-    static void drawSettingsTab();
+    void drawSettingsTab();
+    void drawPerformanceSettings();
+    void drawStressScene();
+    void drawMemoryUsage();
+    void drawFrameCapture();
     void drawHelpTab();
-    void drawIndividualPanel(Object& object) const;
+    void drawIndividualPanel(Object& object, int object_index);
     static void drawLoggerTab();
     std::string readTextFile(const std::string& filePath);
 
     std::string readme_txt_;
+    char scene_file_path_[256]{"scene.p1s"};
+    bool compress_scene_meshes_{false};
+    char mesh_file_path_[256]{""};
+    PrimitiveParameters primitive_parameters_;
+    int primitive_count_{1};
+    FrameStats frame_time_stats_{600};
+    CpuUsage cpu_usage_;
+    double time_to_first_frame_ms_{0.0};
+    char trace_file_path_[256]{"trace.json"};
+    int trace_seconds_{5};
+    MemoryReport memory_report_;
+    double memory_report_time_{-1.0};
+    char memory_report_path_[256]{"memory.json"};
+    FrameCapture frame_capture_;
+    char capture_path_[256]{"capture"};
+    int capture_format_{static_cast<int>(FrameCapture::isPngAvailable() ? CaptureFormat::kPng : CaptureFormat::kRawVideo)};
+    StressParameters stress_parameters_;
+    int flythrough_frames_{600};
+    ZoomFlythrough flythrough_;
+    int undo_budget_mb_{static_cast<int>(History::kDefaultByteBudget / (1024 * 1024))};
+    float color_before_edit_[3]{};
+    std::string comment_before_edit_;
     std::string current_obj_type_{"Cube"};
     const std::map<std::string, ObjectType> object_types_ = {
             { "Cube", kCube },
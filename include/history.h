@@ -0,0 +1,99 @@
+#ifndef PROJECT_1_HISTORY_H
+#define PROJECT_1_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "../include/object.h"
+
+enum class HistoryCommand : uint8_t
+{
+    kTranslate,
+    kRotate,
+    kColor,
+    kCreate,
+    kRemove,
+    kComment,
+    kTransform
+};
+
+// State of an Object that is needed to create it again (kCreate redo, kRemove undo), or its transform before and
+// after a change (kTransform).
+struct ObjectState
+{
+    int id;
+    ObjectType object_type;
+    float rgb[3];
+    float translation[3];
+    float rotation[9];
+    float zoom_factor;
+    PolygonMode polygon_mode;
+    std::string comment;
+};
+
+// One undoable step. Objects are referenced by their ids (not by index in Session, which changes when Objects are
+// removed), and only the change itself is stored:
+//   kTranslate - values[0..2] is the translation added to all object_ids;
+//   kRotate    - values[0..8] is the rotation matrix (row-major) applied on top of the rotation of all object_ids;
+//   kColor     - values[0..2] is the colour before the change, values[3..5] after it;
+//   kComment   - text_before and text_after;
+//   kCreate, kRemove - full state of the Objects in objects;
+//   kTransform - objects[0] and objects[1] are the Object before and after the change, only translation, rotation
+//                and zoom factor are used. Unlike kTranslate and kRotate it sets the transform instead of adding a
+//                change to it, e.g. for Reset.
+struct HistoryEntry
+{
+    HistoryCommand command;
+    std::vector<int> object_ids;
+    float values[9]{};
+    std::string text_before;
+    std::string text_after;
+    std::vector<ObjectState> objects;
+
+    size_t byteSize() const;
+};
+
+class History
+/** History keeps undo and redo stacks of HistoryEntry. A continuous drag or rotation of the same Objects is
+merged into the last entry until the entry is closed (closeEntry, e.g. when the mouse button is released).
+Memory is bounded by a byte budget: the oldest entries are dropped when it is exceeded. */
+{
+public:
+    static constexpr size_t kDefaultByteBudget = 16 * 1024 * 1024;
+
+    explicit History(size_t byte_budget = kDefaultByteBudget) : byte_budget_(byte_budget){};
+
+    void record(HistoryEntry entry);
+    void closeEntry(){entry_open_ = false;};
+    void clear();
+
+    bool canUndo() const{return !undo_entries_.empty();};
+    bool canRedo() const{return !redo_entries_.empty();};
+
+    // The entry to undo (redo) next; after applying it, call finishUndo (finishRedo) to move it to the other stack.
+    HistoryEntry& nextUndo(){return undo_entries_.back();};
+    HistoryEntry& nextRedo(){return redo_entries_.back();};
+    void finishUndo();
+    void finishRedo();
+
+    size_t getByteBudget() const{return byte_budget_;};
+    void setByteBudget(size_t byte_budget);
+    size_t getByteSize() const{return byte_size_;};
+    size_t getUndoCount() const{return undo_entries_.size();};
+    size_t getRedoCount() const{return redo_entries_.size();};
+
+private:
+    std::deque<HistoryEntry> undo_entries_;
+    std::vector<HistoryEntry> redo_entries_;
+    size_t byte_budget_;
+    size_t byte_size_{0};
+    bool entry_open_{false};
+
+    bool mergeIntoLastEntry_(const HistoryEntry& entry);
+    void enforceByteBudget_();
+};
+
+#endif //PROJECT_1_HISTORY_H
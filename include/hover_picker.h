@@ -0,0 +1,70 @@
+#ifndef PROJECT_1_HOVER_PICKER_H
+#define PROJECT_1_HOVER_PICKER_H
+
+#include <cstdint>
+#include <vector>
+#include <GL/glew.h>
+
+#include "../include/math3d.h"
+#include "../include/object.h"
+
+class Session;
+
+class HoverPicker
+/** HoverPicker finds the Object under the cursor every frame without stalling the frame. Only Objects whose bounding
+box is hit by the ray through the cursor are drawn with pick colours, into the single pixel under the cursor (viewport
+and scissor test of one pixel). The pixel is copied into a pixel buffer object, so glReadPixels returns without waiting for the GPU, and is
+read in the next frame. A new pixel is rendered only when the cursor has moved to another pixel or the Objects under
+it have changed, otherwise the last result is kept.
+Must be used on the thread that owns the OpenGL context, before the frame is cleared: the pixel is drawn into the back
+buffer and overwritten by the frame. */
+{
+public:
+    void update(const Session& session, const std::vector<ObjectDrawItem>& items, uint64_t structure_version,
+                const math3d::Mat4& projection_matrix, const math3d::Mat4& view_matrix,
+                const math3d::Mat4& inverse_view_projection, int window_width, int window_height,
+                double cursor_x, double cursor_y);
+    void clear();
+    void releaseBuffers();
+
+    // Index of the Object under the cursor in Session, or -1. Results of a previous structure of the scene are
+    // never returned.
+    int getHoveredObject(uint64_t structure_version) const
+    {
+        return structure_version == hovered_structure_version_ ? hovered_object_ : -1;
+    };
+
+private:
+    // Everything the rendered pixel depends on. If it is the same as for the last request, the result is reused.
+    struct Key
+    {
+        int x{-1};
+        int y{-1};
+        uint64_t structure_version{UINT64_MAX};
+        uint64_t signature{0};
+
+        bool operator==(const Key& other) const
+        {
+            return x == other.x && y == other.y && structure_version == other.structure_version &&
+                   signature == other.signature;
+        };
+    };
+
+    GLuint pixel_buffer_{0};
+    GLsync fence_{nullptr};
+    bool pending_{false};
+
+    Key requested_key_;
+    bool has_requested_key_{false};
+
+    int hovered_object_{-1};
+    uint64_t hovered_structure_version_{UINT64_MAX};
+
+    std::vector<int> candidates_;
+
+    bool resolvePending_(const Session& session);
+    void issue_(const std::vector<ObjectDrawItem>& items, const math3d::Mat4& projection_matrix,
+                const math3d::Mat4& view_matrix, int window_width, int window_height, int x, int y);
+};
+
+#endif //PROJECT_1_HOVER_PICKER_H
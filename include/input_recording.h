@@ -0,0 +1,150 @@
+#ifndef PROJECT_1_INPUT_RECORDING_H
+#define PROJECT_1_INPUT_RECORDING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../include/drawing_lib.h"
+#include "../include/config.h"
+
+// A recording is a header ("P1IR" and the format version, uint32) followed by records: a one-byte RecordType and its
+// fields in host byte order, without padding. Records of a frame are in the order the main loop applies them:
+// input events, changes of the scene, window size and zoom, and kFrame at the end. kViewLayout and kObjectState belong
+// to the changes of the scene; they were added later and are numbered after kFrame, so older recordings stay valid.
+enum class RecordType : uint8_t
+{
+    kMouseButton,     // time, x, y (double), button, action, mods (uint8)
+    kCursorPosition,  // time, x, y (double)
+    kScroll,          // time, y-offset (double)
+    kCursorEnter,     // time (double), entered (uint8)
+    kClearScene,
+    kRemoveObject,    // Object id (int32)
+    kCreateObject,    // ObjectState: id, type (int32), colour, translation, rotation, zoom (float), polygon mode (int32),
+                      // comment (uint16 length and characters)
+    kSelection,       // number of selected Objects (uint32) and their indices (uint32)
+    kParameters,      // boolean Parameters as bits (uint8), rotation sensitivity (float)
+    kWindowSize,      // width, height (int32)
+    kZoom,            // zoom step of the flythrough (double)
+    kFrame,           // ImGui captures the mouse (uint8), recorded frame time in ms (double)
+    kViewLayout,      // ViewLayout (uint8)
+    kObjectState      // ObjectState of an existing Object, as in kCreateObject
+};
+
+class InputRecorder
+/** InputRecorder writes everything a session depends on to a compact binary file, so it can be played back with
+InputReplay, e.g. to compare frame times of two builds on exactly the same input. Mouse events are recorded by
+DrawingLib::handleInput (see DrawingLib::setInputRecorder) with their GLFW timestamps, the rest by the main loop once
+per frame. Changes made outside of the mouse input (GUI and its keyboard shortcuts, undo and redo, loading files) are
+found by comparing the scene with the previous frame: created and removed Objects (by id), the state of every Object
+(colour, transform, zoom, polygon mode, comment), the selection, Parameters and the layout of views. Keyboard events
+themselves are not recorded, only what they have changed. Cameras of the views are changed only with the mouse, so
+they follow from the recorded input.
+If writing fails, recording stops and an error is added to logger. */
+{
+public:
+    InputRecorder() = default;
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+    ~InputRecorder(){close();};
+
+    void open(const std::string& path);
+    void close();
+    bool isOpen() const{return file_.is_open();};
+    size_t getFrameCount() const{return frame_count_;};
+
+    void recordInput(const InputEvent& event);
+    void beginSceneChanges(const Session& session);
+    void recordSceneChanges(const Session& session);
+    void recordWindowSize(int width, int height);
+    void recordZoom(double zoom_step);
+    void recordFrame(bool imgui_capture_mouse, double frame_milliseconds);
+
+private:
+    std::ofstream file_;
+    std::string path_;
+    size_t frame_count_{0};
+
+    // The scene as it was recorded last time, to find what has changed.
+    uint64_t structure_version_{UINT64_MAX};
+    uint64_t clear_count_{0};
+    // In the order of Session::getObjects.
+    std::vector<ObjectState> object_states_;
+    SelectionSet selection_;
+    uint8_t parameter_flags_{0};
+    float rotation_sensitivity_{0.0f};
+    bool parameters_recorded_{false};
+    int view_layout_{-1};
+    int window_width_{0};
+    int window_height_{0};
+
+    void recordStructure_(const Session& session);
+    void recordObjectStates_(const Session& session);
+    void writeType_(RecordType type);
+    void writeObjectState_(const ObjectState& state);
+    void checkWritten_();
+
+    template<typename T>
+    void write_(T value){file_.write(reinterpret_cast<const char*>(&value), sizeof(value));};
+};
+
+// Result of InputReplay::playFrame.
+struct ReplayFrame
+{
+    bool imgui_capture_mouse{false};
+    double recorded_milliseconds{0};
+};
+
+class InputReplay
+/** InputReplay plays a recording of InputRecorder back frame by frame. Mouse events go through
+DrawingLib::handleInput as if they came from GLFW, with their recorded timestamps (double clicks are detected in the
+same way), changes of the scene are applied to Session directly. Frames follow each other without waiting, so the
+replay runs as fast as frames can be drawn, and the same recording always gives the same sequence of scenes.
+The whole file is read and checked when it is opened. */
+{
+public:
+    void open(const std::string& path);
+    bool playFrame(Session& session, DrawingLib& drawing_lib, ReplayFrame& frame);
+
+    size_t getFrameCount() const{return frame_count_;};
+    // The largest window size of the recording, 0 if no size was recorded.
+    int getMaxWindowWidth() const{return max_window_width_;};
+    int getMaxWindowHeight() const{return max_window_height_;};
+
+private:
+    // One parsed record, only the fields of its type are set.
+    struct Record
+    {
+        RecordType type;
+        InputEvent event{};
+        ObjectState state{};
+        std::vector<int> indices;
+        int values[2]{};
+        float rotation_sensitivity{0.0f};
+        double number{0};
+    };
+
+    std::vector<char> data_;
+    size_t position_{0};
+    size_t frame_count_{0};
+    // Index after the Object of the last kObjectState.
+    size_t next_object_index_{0};
+    int max_window_width_{0};
+    int max_window_height_{0};
+
+    bool readRecord_(Record& record);
+    void applyRecord_(const Record& record, Session& session, DrawingLib& drawing_lib, double& zoom_step);
+    void read_(void* value, size_t size);
+
+    template<typename T>
+    T read_()
+    {
+        T value;
+        read_(&value, sizeof(value));
+        return value;
+    };
+};
+
+#endif //PROJECT_1_INPUT_RECORDING_H
@@ -0,0 +1,19 @@
+#ifndef PROJECT_1_JSON_WRITER_H
+#define PROJECT_1_JSON_WRITER_H
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+// Helpers of the JSON files written by the application (trace, memory report). Numbers are written with the stream
+// operator directly; only strings need escaping.
+namespace json
+{
+void writeString(std::ostream& stream, const char* text, size_t length);
+
+inline void writeString(std::ostream& stream, const char* text){writeString(stream, text, std::strlen(text));};
+inline void writeString(std::ostream& stream, const std::string& text){writeString(stream, text.data(), text.size());};
+}
+
+#endif //PROJECT_1_JSON_WRITER_H
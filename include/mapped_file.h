@@ -0,0 +1,27 @@
+#ifndef PROJECT_1_MAPPED_FILE_H
+#define PROJECT_1_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+
+class MappedFile
+/** Read-only memory mapping of a whole file. Pages are loaded by the OS on first access, so opening a large file
+costs almost nothing until its data is used. The mapping is released when the instance is destroyed. */
+{
+public:
+    explicit MappedFile(const std::string& file_path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const{return data_;}
+    size_t size() const{return size_;}
+
+private:
+    const unsigned char* data_{nullptr};
+    size_t size_{0};
+};
+
+#endif //PROJECT_1_MAPPED_FILE_H
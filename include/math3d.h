@@ -0,0 +1,389 @@
+#ifndef PROJECT_1_MATH3D_H
+#define PROJECT_1_MATH3D_H
+
+#include <cmath>
+
+// SSE is part of every x86-64 target; on other architectures the same types fall back to scalar code.
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PROJECT_1_MATH3D_SSE
+#include <xmmintrin.h>
+#endif
+
+// Small vector/matrix library for the CPU side of rendering. Vectors and matrices are 16-byte aligned,
+// so they are loaded into SSE registers directly. Matrices are column-major, as OpenGL expects them
+// in glLoadMatrixf; rotations of Objects stay row-major 3x3 arrays (see Object::rotation_).
+namespace math3d
+{
+constexpr float kPi = 3.14159265359f;
+
+constexpr float radians(float degrees){return degrees * kPi / 180.0f;}
+
+struct alignas(16) Vec3
+{
+    float x, y, z;
+    // Keeps the size of Vec3 equal to one SSE register, so it can be loaded with a single aligned load.
+    float padding_;
+
+    constexpr Vec3() : x(0.0f), y(0.0f), z(0.0f), padding_(0.0f){};
+    constexpr Vec3(float x, float y, float z) : x(x), y(y), z(z), padding_(0.0f){};
+    explicit Vec3(const float values[3]) : x(values[0]), y(values[1]), z(values[2]), padding_(0.0f){};
+};
+
+struct alignas(16) Vec4
+{
+    float x, y, z, w;
+
+    constexpr Vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f){};
+    constexpr Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w){};
+    constexpr Vec4(const Vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w){};
+
+    constexpr Vec3 xyz() const{return {x, y, z};};
+};
+
+#ifdef PROJECT_1_MATH3D_SSE
+inline __m128 load(const Vec3& v){return _mm_load_ps(&v.x);}
+inline __m128 load(const Vec4& v){return _mm_load_ps(&v.x);}
+#endif
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b)
+{
+#ifdef PROJECT_1_MATH3D_SSE
+    Vec3 result;
+    _mm_store_ps(&result.x, _mm_add_ps(load(a), load(b)));
+    return result;
+#else
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+#endif
+}
+
+inline Vec3 operator-(const Vec3& a, const Vec3& b)
+{
+#ifdef PROJECT_1_MATH3D_SSE
+    Vec3 result;
+    _mm_store_ps(&result.x, _mm_sub_ps(load(a), load(b)));
+    return result;
+#else
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+#endif
+}
+
+inline Vec3 operator*(const Vec3& v, float s)
+{
+#ifdef PROJECT_1_MATH3D_SSE
+    Vec3 result;
+    _mm_store_ps(&result.x, _mm_mul_ps(load(v), _mm_set1_ps(s)));
+    return result;
+#else
+    return {v.x * s, v.y * s, v.z * s};
+#endif
+}
+
+inline float dot(const Vec3& a, const Vec3& b){return a.x * b.x + a.y * b.y + a.z * b.z;}
+
+inline Vec3 cross(const Vec3& a, const Vec3& b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline float length(const Vec3& v){return std::sqrt(dot(v, v));}
+
+inline Vec3 normalize(const Vec3& v)
+{
+    float len = length(v);
+    return len > 0.0f ? v * (1.0f / len) : v;
+}
+
+/** Multiplies two rotation matrices stored as row-major 3x3 arrays: result = a * b, i.e. b is applied first.
+result may not alias a or b. */
+inline void multiplyRotation(const float a[9], const float b[9], float result[9])
+{
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 3; col++)
+        {
+            result[row * 3 + col] = a[row * 3] * b[col] + a[row * 3 + 1] * b[3 + col] + a[row * 3 + 2] * b[6 + col];
+        }
+    }
+}
+
+struct alignas(16) Quat
+/** Unit quaternion (x, y, z - vector part, w - scalar part) that represents a rotation. */
+{
+    float x, y, z, w;
+
+    constexpr Quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f){};
+    constexpr Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w){};
+
+    static Quat fromAxisAngle(const Vec3& axis, float radians)
+    /** Rotation by `radians` counterclockwise around `axis` (looking from its end to the origin). */
+    {
+        Vec3 unit_axis = normalize(axis);
+        float s = std::sin(radians * 0.5f);
+        return {unit_axis.x * s, unit_axis.y * s, unit_axis.z * s, std::cos(radians * 0.5f)};
+    }
+
+    void toRotation(float rotation[9]) const
+    /** Writes the rotation as a row-major 3x3 matrix, the format of Object's rotation. */
+    {
+        rotation[0] = 1.0f - 2.0f * (y * y + z * z);
+        rotation[1] = 2.0f * (x * y - z * w);
+        rotation[2] = 2.0f * (x * z + y * w);
+        rotation[3] = 2.0f * (x * y + z * w);
+        rotation[4] = 1.0f - 2.0f * (x * x + z * z);
+        rotation[5] = 2.0f * (y * z - x * w);
+        rotation[6] = 2.0f * (x * z - y * w);
+        rotation[7] = 2.0f * (y * z + x * w);
+        rotation[8] = 1.0f - 2.0f * (x * x + y * y);
+    }
+};
+
+/** Hamilton product: the rotation of a * b applies b first, like the product of their rotation matrices. */
+inline Quat operator*(const Quat& a, const Quat& b)
+{
+    return {a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+            a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+struct alignas(16) Mat4
+/** 4x4 matrix stored column-major: m[col * 4 + row]. Default constructed matrix is the identity. */
+{
+    float m[16];
+
+    constexpr Mat4() : m{1.0f, 0.0f, 0.0f, 0.0f,
+                         0.0f, 1.0f, 0.0f, 0.0f,
+                         0.0f, 0.0f, 1.0f, 0.0f,
+                         0.0f, 0.0f, 0.0f, 1.0f}{};
+
+    const float* data() const{return m;};
+    float& operator()(int row, int col){return m[col * 4 + row];};
+    float operator()(int row, int col) const{return m[col * 4 + row];};
+
+    static Mat4 translation(float x, float y, float z)
+    {
+        Mat4 result;
+        result.m[12] = x;
+        result.m[13] = y;
+        result.m[14] = z;
+        return result;
+    }
+
+    static Mat4 scaling(float x, float y, float z)
+    {
+        Mat4 result;
+        result.m[0] = x;
+        result.m[5] = y;
+        result.m[10] = z;
+        return result;
+    }
+
+    static Mat4 rotation(const float rotation[9])
+    /** Matrix of a row-major 3x3 rotation without translation. */
+    {
+        Mat4 result;
+        for (int row = 0; row < 3; row++)
+        {
+            for (int col = 0; col < 3; col++)
+            {
+                result(row, col) = rotation[row * 3 + col];
+            }
+        }
+        return result;
+    }
+
+    static Mat4 rotationAround(const float rotation[9], const float pivot[3], const float translation[3],
+                               float scale = 1.0f)
+    /** Rotates points around pivot (row-major 3x3 rotation), then translates and scales them:
+    p' = scale * (rotation * (p - pivot) + pivot + translation). It is written out element by element:
+    this runs for every Object in every snapshot, and it is faster than composing it from matrix products. */
+    {
+        Mat4 result;
+        for (int row = 0; row < 3; row++)
+        {
+            for (int col = 0; col < 3; col++)
+            {
+                result.m[col * 4 + row] = rotation[row * 3 + col] * scale;
+            }
+            result.m[12 + row] = (pivot[row] + translation[row] - (rotation[row * 3] * pivot[0] +
+                                                                   rotation[row * 3 + 1] * pivot[1] +
+                                                                   rotation[row * 3 + 2] * pivot[2])) * scale;
+        }
+        return result;
+    }
+
+    static Mat4 rotationAround(const float rotation[9], const float pivot[3], const float translation[3],
+                               float scale, const float decode_scale[3], const float decode_offset[3])
+    /** The same as above for quantized points q, which are decoded first: p = decode_scale * q + decode_offset
+    (per axis). Used for meshes in VertexFormat::kCompact, so the decoding costs nothing per vertex. */
+    {
+        Mat4 result;
+        for (int row = 0; row < 3; row++)
+        {
+            float translated = pivot[row] + translation[row];
+            for (int col = 0; col < 3; col++)
+            {
+                result.m[col * 4 + row] = rotation[row * 3 + col] * decode_scale[col] * scale;
+                translated += rotation[row * 3 + col] * (decode_offset[col] - pivot[col]);
+            }
+            result.m[12 + row] = translated * scale;
+        }
+        return result;
+    }
+
+    static Mat4 frustum(float left, float right, float bottom, float top, float near_plane, float far_plane)
+    /** Perspective projection, the same matrix that glFrustum multiplies with. */
+    {
+        Mat4 result;
+        result(0, 0) = 2.0f * near_plane / (right - left);
+        result(1, 1) = 2.0f * near_plane / (top - bottom);
+        result(0, 2) = (right + left) / (right - left);
+        result(1, 2) = (top + bottom) / (top - bottom);
+        result(2, 2) = -(far_plane + near_plane) / (far_plane - near_plane);
+        result(3, 2) = -1.0f;
+        result(2, 3) = -2.0f * far_plane * near_plane / (far_plane - near_plane);
+        result(3, 3) = 0.0f;
+        return result;
+    }
+
+    static Mat4 ortho(float left, float right, float bottom, float top, float near_plane, float far_plane)
+    /** Orthographic projection, the same matrix that glOrtho multiplies with. */
+    {
+        Mat4 result;
+        result(0, 0) = 2.0f / (right - left);
+        result(1, 1) = 2.0f / (top - bottom);
+        result(2, 2) = -2.0f / (far_plane - near_plane);
+        result(0, 3) = -(right + left) / (right - left);
+        result(1, 3) = -(top + bottom) / (top - bottom);
+        result(2, 3) = -(far_plane + near_plane) / (far_plane - near_plane);
+        return result;
+    }
+
+    void setTranslation(const Vec3& translation)
+    {
+        m[12] = translation.x;
+        m[13] = translation.y;
+        m[14] = translation.z;
+    }
+
+    Vec4 transform(const Vec4& v) const
+    {
+#ifdef PROJECT_1_MATH3D_SSE
+        __m128 result = _mm_mul_ps(_mm_load_ps(m), _mm_set1_ps(v.x));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(m + 4), _mm_set1_ps(v.y)));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(m + 8), _mm_set1_ps(v.z)));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_load_ps(m + 12), _mm_set1_ps(v.w)));
+        Vec4 out;
+        _mm_store_ps(&out.x, result);
+        return out;
+#else
+        Vec4 out;
+        float* values = &out.x;
+        for (int row = 0; row < 4; row++)
+        {
+            values[row] = m[row] * v.x + m[4 + row] * v.y + m[8 + row] * v.z + m[12 + row] * v.w;
+        }
+        return out;
+#endif
+    }
+
+    Vec3 transformPoint(const Vec3& p) const{return transform(Vec4(p, 1.0f)).xyz();};
+    Vec3 transformVector(const Vec3& v) const{return transform(Vec4(v, 0.0f)).xyz();};
+};
+
+inline Mat4 operator*(const Mat4& a, const Mat4& b)
+/** Matrix product: every column of the result is a linear combination of the columns of a. */
+{
+    Mat4 result;
+#ifdef PROJECT_1_MATH3D_SSE
+    const __m128 a0 = _mm_load_ps(a.m);
+    const __m128 a1 = _mm_load_ps(a.m + 4);
+    const __m128 a2 = _mm_load_ps(a.m + 8);
+    const __m128 a3 = _mm_load_ps(a.m + 12);
+    for (int col = 0; col < 4; col++)
+    {
+        const float* b_col = b.m + col * 4;
+        __m128 sum = _mm_mul_ps(a0, _mm_set1_ps(b_col[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(b_col[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(b_col[2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(b_col[3])));
+        _mm_store_ps(result.m + col * 4, sum);
+    }
+#else
+    for (int col = 0; col < 4; col++)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            result.m[col * 4 + row] = a.m[row] * b.m[col * 4] + a.m[4 + row] * b.m[col * 4 + 1] +
+                                      a.m[8 + row] * b.m[col * 4 + 2] + a.m[12 + row] * b.m[col * 4 + 3];
+        }
+    }
+#endif
+    return result;
+}
+
+inline bool inverse(const Mat4& matrix, Mat4& result)
+/** Inverts a general 4x4 matrix by cofactors. Returns false (and leaves result unchanged) if it is singular. */
+{
+    const float* m = matrix.m;
+    float inv[16];
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float determinant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (determinant == 0.0f)
+    {
+        return false;
+    }
+    float inverse_determinant = 1.0f / determinant;
+    for (int i = 0; i < 16; i++)
+    {
+        result.m[i] = inv[i] * inverse_determinant;
+    }
+    return true;
+}
+
+// Viewport in window pixels, as set with glViewport (origin in the bottom-left corner).
+struct Viewport
+{
+    float x, y, width, height;
+};
+
+inline Vec3 project(const Vec3& point, const Mat4& view_projection, const Viewport& viewport)
+/** Window coordinates (x, y in pixels, depth in [0, 1]) of a point, like gluProject. */
+{
+    Vec4 clip = view_projection.transform(Vec4(point, 1.0f));
+    float inverse_w = 1.0f / clip.w;
+    return {viewport.x + (clip.x * inverse_w + 1.0f) * 0.5f * viewport.width,
+            viewport.y + (clip.y * inverse_w + 1.0f) * 0.5f * viewport.height,
+            (clip.z * inverse_w + 1.0f) * 0.5f};
+}
+
+inline Vec3 unproject(const Vec3& window, const Mat4& inverse_view_projection, const Viewport& viewport)
+/** Point in the scene that is drawn at window coordinates (x, y in pixels, depth in [0, 1]), like gluUnProject.
+Takes the inverse of the view-projection matrix, so it is inverted once for many points. */
+{
+    Vec4 ndc((window.x - viewport.x) / viewport.width * 2.0f - 1.0f,
+             (window.y - viewport.y) / viewport.height * 2.0f - 1.0f,
+             window.z * 2.0f - 1.0f,
+             1.0f);
+    Vec4 point = inverse_view_projection.transform(ndc);
+    return point.xyz() * (1.0f / point.w);
+}
+}
+
+#endif //PROJECT_1_MATH3D_H
@@ -0,0 +1,68 @@
+#ifndef PROJECT_1_MEMORY_REPORT_H
+#define PROJECT_1_MEMORY_REPORT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../include/session.h"
+
+enum class MemoryCategory : int
+{
+    // Host (CPU) memory
+    kObjects,             // Object instances themselves (fixed-size part)
+    kObjectVertices,      // copies of mesh vertices in every Object
+    kObjectIndices,       // copies of mesh indices in every Object
+    kRegisteredMeshes,    // imported and generated meshes in MeshRegistry
+    kUndoHistory,         // undo and redo steps
+    // OpenGL buffers
+    kMeshBuffers,         // vertices and indices of meshes shared per ObjectType (MeshBufferCache)
+    kMeshBufferFreeSpace, // unused bytes of the shared mesh buffers: free blocks and alignment
+    kCount
+};
+
+struct ObjectMemory
+{
+    int object_id;
+    ObjectType object_type;
+    // Objects have no OpenGL buffers of their own.
+    size_t host_bytes;
+};
+
+struct MeshMemory
+{
+    ObjectType object_type;
+    std::string name;
+    size_t object_count;
+    // Copies of the mesh in Objects and in MeshRegistry; built-in meshes are constant tables and not counted.
+    size_t host_bytes;
+    size_t gl_bytes;
+    // What the mesh buffers would take with VertexFormat::kFloat; equal to gl_bytes in that format.
+    size_t gl_float_bytes;
+};
+
+struct MemoryReport
+{
+    size_t category_bytes[static_cast<int>(MemoryCategory::kCount)]{};
+    size_t host_bytes{0};
+    size_t gl_bytes{0};
+    // Sorted by host + OpenGL bytes, the largest first.
+    std::vector<ObjectMemory> objects;
+    std::vector<MeshMemory> meshes;
+};
+
+class MemoryAccounting
+/** MemoryAccounting adds up memory used by the scene: host memory of Objects, meshes and undo history, and sizes of
+OpenGL buffers, per Object, per mesh (ObjectType) and per category. Sizes are counted from the data structures when
+a report is collected, so nothing has to be updated when Objects change. Host sizes are capacities of containers,
+OpenGL sizes are the sizes of uploaded data and the unused rest of the buffers (the driver may allocate more). */
+{
+public:
+    static MemoryReport collect(const Session& session);
+    static void writeJson(const MemoryReport& report, const std::string& path);
+
+    static const char* getCategoryName(MemoryCategory category);
+    static bool isGlCategory(MemoryCategory category){return category >= MemoryCategory::kMeshBuffers;};
+};
+
+#endif //PROJECT_1_MEMORY_REPORT_H
@@ -0,0 +1,108 @@
+#ifndef PROJECT_1_MESH_BUFFER_CACHE_H
+#define PROJECT_1_MESH_BUFFER_CACHE_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <GL/glew.h>
+
+#include "../include/buffer_allocator.h"
+#include "../include/object.h"
+#include "../include/polyhedron.h"
+
+// Layout of vertex and index buffers of meshes.
+enum class VertexFormat : int
+{
+    kFloat,    // positions as 3 floats (12 bytes), 32-bit indices
+    kCompact   // positions as 3 16-bit integers relative to the bounds of the mesh, padded to 8 bytes; 16-bit indices
+               // for meshes of up to 65536 vertices
+};
+
+// Where the vertices and indices of one mesh are, shared by all Objects of its ObjectType.
+struct SharedMeshBuffers
+{
+    // The buffers of all meshes, the mesh starts at the byte offsets; its indices count from its first vertex.
+    GLuint vertex_buffer_object;
+    GLuint index_buffer_object;
+    size_t vertex_offset;
+    size_t index_offset;
+    // GL_FLOAT or GL_SHORT, with the stride of one vertex in bytes.
+    GLenum position_type;
+    GLsizei position_stride;
+    // GL_UNSIGNED_INT or GL_UNSIGNED_SHORT.
+    GLenum index_type;
+    // A position in the buffer p stands for position_offset + position_scale * p (per axis). The model matrix of an
+    // Object decodes it (see Object::fillDrawItem), so drawing costs the same as with floats.
+    float position_scale[3];
+    float position_offset[3];
+};
+
+struct MeshBufferStats
+{
+    size_t mesh_count;       // meshes that have buffers now
+    size_t object_count;     // Objects that use them
+    size_t upload_count;     // meshes uploaded since start
+    size_t byte_size;        // vertices and indices of all meshes
+    size_t float_byte_size;  // size of the same meshes with VertexFormat::kFloat
+    // Fragmentation of the vertex and the index buffer together: their size, free bytes between and after meshes,
+    // in how many blocks, and the largest one (a new mesh larger than that makes a buffer grow).
+    size_t buffer_capacity;
+    size_t free_bytes;
+    size_t free_block_count;
+    size_t largest_free_block;
+};
+
+class MeshBufferCache
+/** MeshBufferCache keeps the vertices and indices of meshes per ObjectType. Vertices of an Object never change (its
+transform is a matrix), so all Objects of one type draw the same mesh: it is uploaded once, when the first Object of
+the type is created, and freed with the last one.
+All meshes share one vertex buffer and one index buffer, each mesh is a range of them given out by a BufferAllocator,
+so drawing never switches buffers and a scene of many imported or generated meshes doesn't have two buffers per mesh.
+A buffer that has no free block large enough for a new mesh grows to twice its size, keeping the offsets of meshes.
+Removed meshes leave free blocks between the others; compact moves the meshes together and shrinks the buffers.
+Meshes are uploaded in the current VertexFormat. Objects keep the pointer returned by acquire until they release
+the mesh, it stays valid when the format changes or the buffers are compacted, but offsets in it change.
+Must be used on the thread that owns the OpenGL context. */
+{
+public:
+    static const SharedMeshBuffers* acquire(ObjectType object_type, const MeshView& mesh);
+    static void release(ObjectType object_type);
+    static MeshBufferStats getStats();
+    static size_t getByteSize(ObjectType object_type);
+    static size_t getFloatByteSize(ObjectType object_type);
+
+    static VertexFormat getVertexFormat(){return vertex_format_;};
+    static void setVertexFormat(VertexFormat vertex_format);
+    static void compact();
+
+private:
+    // Size of a buffer when the first mesh is uploaded into it, and the smallest size compact shrinks it to.
+    static constexpr size_t kInitialCapacity = 64 * 1024;
+
+    struct Entry
+    {
+        SharedMeshBuffers buffers;
+        size_t object_count;
+        size_t vertex_byte_size;
+        size_t index_byte_size;
+        size_t float_byte_size;
+    };
+    // One shared buffer and the ranges of it that are in use.
+    struct Arena
+    {
+        GLenum target;
+        GLuint buffer_object;
+        BufferAllocator allocator;
+    };
+    static std::unordered_map<int, Entry> entries_;
+    static Arena vertex_arena_;
+    static Arena index_arena_;
+    static size_t upload_count_;
+    static VertexFormat vertex_format_;
+
+    static void upload_(Entry& entry, const MeshView& mesh);
+    static size_t allocate_(Arena& arena, size_t size);
+    static void resize_(Arena& arena, size_t capacity);
+    static void compact_(Arena& arena, bool vertices);
+};
+
+#endif //PROJECT_1_MESH_BUFFER_CACHE_H
@@ -0,0 +1,58 @@
+#ifndef PROJECT_1_MESH_IMPORTER_H
+#define PROJECT_1_MESH_IMPORTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../include/polyhedron.h"
+
+struct MeshImportStats
+{
+    size_t file_size{0};
+    size_t triangle_count{0};
+    size_t parsed_vertex_count{0};
+    size_t welded_vertex_count{0};
+    unsigned thread_count{0};
+    double parse_seconds{0};
+    double weld_seconds{0};
+
+    double parseMegabytesPerSecond() const
+    {
+        return parse_seconds > 0 ? static_cast<double>(file_size) / (1024.0 * 1024.0) / parse_seconds : 0;
+    }
+};
+
+class MeshImporter
+/** MeshImporter reads triangle meshes from OBJ, PLY (ascii and binary little-endian) and STL (ascii and binary) files.
+The file is memory-mapped and split into chunks at line (or record) boundaries that are parsed in parallel.
+Afterwards vertices that are closer than weld_epsilon are merged with a hash grid, so that formats that store
+every triangle separately (STL) produce an indexed mesh. The result is centered and scaled to the size of
+built-in objects, so it can be registered in MeshRegistry as a new object type. */
+{
+public:
+    explicit MeshImporter(float weld_epsilon = 1e-6f, unsigned thread_count = 0);
+
+    Polyhedron importFile(const std::string& file_path);
+    const MeshImportStats& getStats() const{return stats_;}
+
+private:
+    // Vertices (x, y, z) and triangle indices as they are read from a file, before welding.
+    struct RawMesh
+    {
+        std::vector<GLfloat> positions;
+        std::vector<GLuint> indices;
+    };
+
+    float weld_epsilon_;
+    unsigned thread_count_;
+    MeshImportStats stats_;
+
+    RawMesh parseObj_(const char* begin, const char* end) const;
+    RawMesh parseStl_(const char* begin, const char* end) const;
+    RawMesh parsePly_(const char* begin, const char* end) const;
+    Polyhedron weld_(const RawMesh& raw_mesh) const;
+    static void normalize_(Polyhedron& mesh);
+};
+
+#endif //PROJECT_1_MESH_IMPORTER_H
@@ -0,0 +1,33 @@
+#ifndef PROJECT_1_MESH_REGISTRY_H
+#define PROJECT_1_MESH_REGISTRY_H
+
+#include <string>
+#include <vector>
+
+#include "../include/object.h"
+#include "../include/polyhedron.h"
+
+class MeshRegistry
+/** MeshRegistry keeps meshes that are added to the application at runtime (e.g. imported from OBJ/PLY/STL files).
+Every registered mesh gets a new ObjectType id right after the built-in types, so Objects are created from it
+exactly like from the built-in library. */
+{
+public:
+    static ObjectType registerMesh(const std::string& name, Polyhedron mesh);
+    static bool contains(int type_id);
+    static const Polyhedron& getMesh(ObjectType object_type);
+    static const std::string& getName(ObjectType object_type);
+    static int findByName(const std::string& name);
+
+    static size_t size(){return meshes_.size();}
+
+private:
+    struct Entry
+    {
+        std::string name;
+        Polyhedron mesh;
+    };
+    static std::vector<Entry> meshes_;
+};
+
+#endif //PROJECT_1_MESH_REGISTRY_H
@@ -7,8 +7,13 @@
 #include "tuple"
 #include <GLFW/glfw3.h>
 
+#include "../include/math3d.h"
+#include "../include/polyhedron.h"
 
-enum ObjectType
+struct SharedMeshBuffers;
+
+// Ids after the built-in types are assigned to meshes registered in MeshRegistry at runtime.
+enum ObjectType : int
 {
     kCube = 0,
     kPyramid = 1,
@@ -16,6 +21,9 @@ enum ObjectType
     kIcosahedron = 3
 };
 
+// Number of object types in the built-in library (library.h).
+constexpr int kBuiltinObjectTypeCount = 4;
+
 enum PolygonMode
 {
     kPolygonModeLine  = GL_LINE,
@@ -28,6 +36,64 @@ struct BoundingBox
     float maxX;
     float minY;
     float maxY;
+    float minZ;
+    float maxZ;
+};
+
+// How much of an Object is drawn, chosen per view from its size on the screen (see SceneView::cull).
+enum class ObjectDetail
+{
+    kFull,          // faces and the line pass of edges
+    kWithoutEdges   // faces only, edges of a few pixels can't be told apart anyway
+};
+
+// Everything that is needed to draw an Object: its buffers and the values of its state at one moment.
+// Render snapshots (scene_updater.h) are lists of draw items, so drawing doesn't read Objects themselves.
+struct ObjectDrawItem
+{
+    // Shared buffers of all meshes and where the mesh of the Object starts in them (see MeshBufferCache).
+    GLuint vertex_buffer_object;
+    GLuint index_buffer_object;
+    size_t vertex_offset;
+    size_t index_offset;
+    GLsizei index_count;
+    // An Object has one colour, it is set for the whole draw instead of per vertex.
+    GLubyte color[4];
+    GLubyte pick_color[3];
+    // Formats of the shared mesh buffers (see VertexFormat in mesh_buffer_cache.h).
+    GLenum position_type;
+    GLsizei position_stride;
+    GLenum index_type;
+    // Model matrix with the zoom factor of the Object applied; it also decodes compact positions.
+    math3d::Mat4 model_matrix;
+    PolygonMode polygon_mode;
+    // Bounding box in scene coordinates, to skip Objects without drawing them (see HoverPicker).
+    BoundingBox bounding_box;
+    // Filled by Session, which keeps the selection (see SelectionSet).
+    bool selected;
+    // Filled by DrawingLib for the Object under the cursor.
+    bool hovered;
+    // Filled convex Objects hide what is behind them (see OcclusionCuller). The occluder box is inside the mesh, in the
+    // coordinates of its vertex buffer like the model matrix expects them.
+    bool occluder;
+    BoundingBox occluder_box;
+};
+
+// Bytes that belong to one Object besides the Object itself: CPU copies of its mesh. Vertex and index buffers are
+// shared by all Objects of a type and counted by MeshBufferCache.
+struct ObjectMemoryUsage
+{
+    size_t vertices;
+    size_t indices;
+};
+
+// What is derived from a mesh once for all Objects of its type: the pivot of rotations, the bounds in mesh space and
+// how much the bounds can be scaled around their center to lie inside the mesh (0 if it isn't convex).
+struct MeshSummary
+{
+    std::array<float, 3> center;
+    BoundingBox bounds;
+    float inner_box_scale;
 };
 
 struct GuiParameters
@@ -43,66 +109,96 @@ class Object
 {
 public:
     explicit Object(int id, int pick_id, ObjectType object_type, GLfloat r, GLfloat g, GLfloat b, GLubyte pick_r, GLubyte pick_g, GLubyte pick_b);
-    void draw(bool get_pick_color = false);
+    Object(int id, int pick_id, ObjectType object_type, GLfloat r, GLfloat g, GLfloat b, GLubyte pick_r, GLubyte pick_g,
+           GLubyte pick_b, const MeshSummary& mesh_summary);
+    static MeshSummary summarizeMesh(ObjectType object_type);
+    void fillDrawItem(ObjectDrawItem& item) const;
+    static void drawItem(const ObjectDrawItem& item, const math3d::Mat4& view_matrix, bool get_pick_color = false,
+                         ObjectDetail detail = ObjectDetail::kFull);
     void drawMetadataText() const;
 
     void reset();
     void loadObjectBuffers();
-    bool checkPickColor(int pick_color_id) const;
 
     std::string ObjectTypeToString() const;
     std::string ObjectIdToString() const;
 
     void updateObjectCoordinates(double delta_x, double delta_y);
     void updateObjectRotation(double delta_x, double delta_y);
-    void updateObjectColor();
+    static void calculateRotationDelta(double delta_x, double delta_y, float delta_rotation[9]);
+    void applyRotation(const float delta_rotation[9]);
+    void translate(const float delta[3]);
     void resetObjectVertices();
 
+    int getId() const{return id_;}
+    int getPickId() const{return pick_id_;}
+    ObjectType getObjectType() const{return object_type_;}
+    MeshView getMesh() const;
+    ObjectMemoryUsage getMemoryUsage() const;
+    // A GPU-resident Object keeps no copy of its mesh in host memory (see setGpuResident).
+    bool isGpuResident() const{return gpu_resident_;}
+    void setGpuResident(bool gpu_resident);
+
+    const float* getTranslation() const{return translation_;}
+    const float* getRotation() const{return rotation_;}
+    void setTransform(const float translation[3], const float rotation[9]);
+    math3d::Mat4 getModelMatrix() const;
+
     float* getObjectColor(){return rgb_;}
-    bool& getSelected(){return selected_;}
+    const float* getObjectColor() const{return rgb_;}
     PolygonMode& getPolygonMode(){return polygon_mode_;}
+    PolygonMode getPolygonMode() const{return polygon_mode_;}
 
-    void switchSelected(){selected_ = !selected_;}
     void switchGuiEnabled(){gui_parameters_.object_gui_ = !gui_parameters_.object_gui_; is_position_initialized_ = false;}
 
     void calculateBoundingBox();
+    const BoundingBox& getBoundingBox() const{return bounding_box_;}
 
     void setGuiWindowCoordinates(float window_width, float window_height, double x, double y);
     void updateGuiWindowDeltaCoordinates(float window_width, float window_height, double delta_x, double delta_y);
 
     GuiParameters& getObjectGuiParameters(){return gui_parameters_;}
+    const GuiParameters& getObjectGuiParameters() const{return gui_parameters_;}
     void initializePosition(){is_position_initialized_ = true;}
     bool isPositionInitialized() const{return is_position_initialized_;}
 
 private:
-    float pi_ = 3.14159265359f;
-
     int id_;
     int pick_id_;
     float rgb_[3];
-    bool selected_{false};
 
+    // Vertices are kept in mesh space. Moving and rotating an Object only changes its transform:
+    // world = rotation_ * (vertex - mesh_center_) + mesh_center_ + translation_.
+    float translation_[3]{0.0f, 0.0f, 0.0f};
+    float rotation_[9]{1.0f, 0.0f, 0.0f,
+                       0.0f, 1.0f, 0.0f,
+                       0.0f, 0.0f, 1.0f};
+    std::array<float, 3> mesh_center_{};
+    // Bounds of the mesh in mesh space; without rotation the bounding box is computed from them alone.
+    BoundingBox mesh_bounds_{};
+    float inner_box_scale_{0.0f};
+
+    // Host copy of the mesh, only kept when the Object is not GPU-resident.
+    bool gpu_resident_{true};
     std::vector<GLfloat> vertices_{};
     std::vector<GLuint> indices_{};
-    std::vector<GLfloat> colours_{};
-    std::vector<GLubyte> pick_colours_{};
+    GLubyte pick_rgb_[3];
 
     ObjectType object_type_;
     BoundingBox bounding_box_;
 
-    GLuint vertex_buffer_object_{};
-    GLuint index_buffer_object_{};
-    GLuint color_buffer_object_{};
-    GLuint pick_color_buffer_object_{};
+    // Vertex and index buffers shared with other Objects of the type, null until loadObjectBuffers.
+    const SharedMeshBuffers* mesh_buffers_{nullptr};
 
     PolygonMode polygon_mode_;
     GuiParameters gui_parameters_;
 
     bool is_position_initialized_ = false;
 
-    void drawDefault_();
-    void drawWithPick_();
-    std::array<float, 3>  calculateCenter();
+    static void drawDefault_(const ObjectDrawItem& item, ObjectDetail detail);
+    static void drawWithPick_(const ObjectDrawItem& item);
+    bool hasRotation_() const;
+    void applyZoomToBoundingBox_();
 };
 
 #endif //PROJECT_1_OBJECT_H
@@ -0,0 +1,59 @@
+#ifndef PROJECT_1_OCCLUSION_CULLER_H
+#define PROJECT_1_OCCLUSION_CULLER_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "../include/config.h"
+#include "../include/library.h"
+#include "../include/math3d.h"
+#include "../include/object.h"
+#include "../include/scene_view.h"
+
+class OcclusionCuller
+/** OcclusionCuller skips Objects hidden behind other Objects before they are drawn, on the CPU. Every frame and view,
+the largest filled Objects with a convex mesh (occluders) are drawn into a small depth buffer: a box inside the mesh,
+at the depth of its farthest corner, only into pixels it covers completely. The buffer keeps inverse depth (1/w,
+0 where nothing was drawn), so the nearest occluder wins with max and a hierarchy of coarser levels keeps the minimum
+of 2x2 pixels - the farthest occluder depth in the area. An Object is hidden if the nearest point of its bounding box
+is behind the hierarchy over the pixels of the box; the test is conservative, an Object is never skipped if any part
+of it could be seen. Rows of the buffer are drawn and reduced four pixels at a time with SSE where available. */
+{
+public:
+    // Size of the depth buffer; it spans the view, so pixels follow the aspect ratio of the view.
+    static constexpr int kWidth = 256;
+    static constexpr int kHeight = 128;
+    // The finest level and five coarser ones, down to 8x4 pixels.
+    static constexpr int kLevelCount = 6;
+    // Occluders per view and frame, the largest ones on the screen, and the smallest area of one in pixels.
+    static constexpr int kMaxOccluders = 16;
+    static constexpr float kMinOccluderArea = 16.0f;
+
+    void cull(const SceneView& view, const std::vector<ObjectDrawItem>& items, std::vector<VisibleItem>& visible_items,
+              ViewStats& stats);
+
+    static float getInnerBoxScale(ObjectType object_type);
+
+private:
+    // Bounding box of a visible Object on the screen, in pixels of the depth buffer.
+    struct ScreenRect
+    {
+        float min_x, min_y, max_x, max_y;
+        float nearest_inverse_depth;
+        // False if the box reaches the camera plane, such Objects are never hidden nor occluders.
+        bool valid;
+    };
+
+    std::vector<float> levels_[kLevelCount];
+    std::vector<ScreenRect> rects_;
+    std::vector<int> occluders_;
+
+    static std::unordered_map<int, float> inner_box_scales_;
+
+    void drawOccluder_(const ObjectDrawItem& item, const math3d::Mat4& view_projection);
+    void buildHierarchy_();
+    bool isOccluded_(const ScreenRect& rect) const;
+    static float computeInnerBoxScale_(const MeshView& mesh);
+};
+
+#endif //PROJECT_1_OCCLUSION_CULLER_H
@@ -0,0 +1,38 @@
+#ifndef PROJECT_1_PICK_ID_ALLOCATOR_H
+#define PROJECT_1_PICK_ID_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class PickIdAllocator
+/** PickIdAllocator hands out pick ids - unique numbers that Objects are drawn with in the pick pass and that are read
+back from the framebuffer as colours (R - bits 16-23, G - bits 8-15, B - bits 0-7). Id 0 is the black background and
+is never allocated, so there are 2^24 - 1 ids. Released ids are reused (last released first), so ids of removed
+Objects don't run out, and no two live Objects ever share an id: releasing an id that is not in use throws. */
+{
+public:
+    static constexpr uint32_t kMaxPickId = 0xFFFFFF;
+
+    explicit PickIdAllocator(uint32_t max_id = kMaxPickId) : max_id_(max_id){};
+
+    uint32_t acquire();
+    void release(uint32_t pick_id);
+    void clear();
+
+    // Number of ids in use and the largest id ever allocated (ids in use are never greater).
+    size_t size() const{return (next_id_ - 1) - free_ids_.size();};
+    uint32_t highestId() const{return next_id_ - 1;};
+
+    static void toColor(uint32_t pick_id, unsigned char rgb[3]);
+    static uint32_t fromColor(const unsigned char rgb[3]);
+
+private:
+    uint32_t max_id_;
+    uint32_t next_id_{1};
+    std::vector<uint32_t> free_ids_;
+    // Indexed by id, true for ids that are acquired and not released.
+    std::vector<bool> in_use_;
+};
+
+#endif //PROJECT_1_PICK_ID_ALLOCATOR_H
@@ -0,0 +1,22 @@
+#ifndef PROJECT_1_POLYHEDRON_H
+#define PROJECT_1_POLYHEDRON_H
+
+#include <cstddef>
+#include "vector"
+#include <GL/gl.h>
+
+// Polyhedron struct contains vertices and indices to create Object class instances and draw with OpenGL functions.
+struct Polyhedron{
+    std::vector<GLfloat> vertices;
+    std::vector<GLuint> indices;
+};
+
+// Read-only view of vertices and indices of a mesh: a baked built-in mesh (library.h) or a Polyhedron.
+struct MeshView{
+    const GLfloat* vertices;
+    size_t vertices_size;
+    const GLuint* indices;
+    size_t indices_size;
+};
+
+#endif //PROJECT_1_POLYHEDRON_H
@@ -0,0 +1,74 @@
+#ifndef PROJECT_1_PRIMITIVE_GENERATOR_H
+#define PROJECT_1_PRIMITIVE_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "../include/object.h"
+#include "../include/polyhedron.h"
+
+enum class PrimitiveKind : uint8_t
+{
+    kUvSphere,
+    kIcoSphere,
+    kTorus,
+    kCylinder,
+    kCone,
+    kBox
+};
+
+constexpr int kPrimitiveKindCount = 6;
+
+// Parameters of a generated primitive. Only some of them are used by every kind:
+//   kUvSphere  - radius, segments (around the y-axis), rings (from pole to pole);
+//   kIcoSphere - radius, subdivisions of the icosahedron;
+//   kTorus     - radius (of the ring), minor_radius (of the tube), segments (around the ring), rings (around the tube);
+//   kCylinder, kCone - radius, height, segments;
+//   kBox       - radius (half of width and depth), height, subdivisions (of every edge).
+struct PrimitiveParameters
+{
+    PrimitiveKind kind{PrimitiveKind::kUvSphere};
+    float radius{0.5f};
+    float minor_radius{0.15f};
+    float height{1.0f};
+    int segments{32};
+    int rings{16};
+    int subdivisions{2};
+
+    bool operator==(const PrimitiveParameters& other) const;
+};
+
+struct PrimitiveParametersHash
+{
+    size_t operator()(const PrimitiveParameters& parameters) const;
+};
+
+struct PrimitiveCacheStats
+{
+    size_t mesh_count;
+    unsigned long long hits;
+    unsigned long long misses;
+    size_t byte_size;  // vertices and indices of cached meshes
+};
+
+class PrimitiveGenerator
+/** PrimitiveGenerator creates meshes of parametric primitives and registers them in MeshRegistry, so Objects are
+created from them like from imported meshes. Results are cached by (kind, parameters): a primitive with the same
+parameters is generated once, and all its Objects share one mesh (and its GPU buffers, see MeshBufferCache). */
+{
+public:
+    static ObjectType getObjectType(const PrimitiveParameters& parameters);
+    static Polyhedron generate(const PrimitiveParameters& parameters);
+    static PrimitiveParameters normalize(const PrimitiveParameters& parameters);
+    static std::string getName(const PrimitiveParameters& parameters);
+    static const char* getKindName(PrimitiveKind kind);
+    static PrimitiveCacheStats getStats();
+
+private:
+    static std::unordered_map<PrimitiveParameters, ObjectType, PrimitiveParametersHash> cache_;
+    static PrimitiveCacheStats stats_;
+};
+
+#endif //PROJECT_1_PRIMITIVE_GENERATOR_H
@@ -0,0 +1,126 @@
+#ifndef PROJECT_1_SCENE_FILE_H
+#define PROJECT_1_SCENE_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+#include "../include/mapped_file.h"
+#include "../include/session.h"
+
+// Layout of a scene file. All values are stored in the byte order of the host (little-endian on supported platforms).
+//   SceneFileHeader
+//   SceneMeshEntry    x mesh_count    - meshes that are not part of the built-in library
+//   SceneObjectRecord x object_count  - one fixed-size record per Object
+//   comment pool                      - comments of all Objects, referenced by offset and length
+//   mesh blocks                       - vertices followed by indices, every block is aligned to 16 bytes
+// Tables are fixed-size records, so after mapping the file they are read in place without parsing.
+
+constexpr char kSceneFileMagic[4] = {'P', '1', 'S', 'C'};
+constexpr uint32_t kSceneFileVersion = 1;
+
+enum SceneMeshCodec : uint32_t
+{
+    kSceneMeshRaw = 0,
+    kSceneMeshDeflate = 1
+};
+
+enum SceneObjectFlags : uint32_t
+{
+    kSceneObjectSelected = 1u << 0,
+    kSceneObjectPanelOpen = 1u << 1
+};
+
+struct SceneFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t mesh_count;
+    uint32_t reserved;
+    uint64_t object_count;
+    uint64_t mesh_table_offset;
+    uint64_t object_table_offset;
+    uint64_t comment_pool_offset;
+    uint64_t comment_pool_size;
+    uint64_t file_size;
+};
+
+struct SceneMeshEntry
+{
+    char name[32];
+    uint32_t object_type;
+    uint32_t codec;
+    uint32_t vertex_count;   // number of GLfloat values, 3 per vertex
+    uint32_t index_count;
+    uint64_t block_offset;
+    uint64_t stored_size;    // size of the block in the file
+    uint64_t raw_size;       // size of the block after decompression
+};
+
+struct SceneObjectRecord
+{
+    int32_t id;
+    uint32_t object_type;
+    float rgb[3];
+    float translation[3];
+    float rotation[9];
+    float zoom_factor;
+    uint32_t polygon_mode;
+    uint32_t flags;
+    float panel_x;
+    float panel_y;
+    uint32_t comment_offset;
+    uint32_t comment_length;
+};
+
+struct SceneFileStats
+{
+    size_t object_count{0};
+    size_t mesh_count{0};
+    size_t file_size{0};
+    double read_seconds{0};   // time to map and validate the file
+    double total_seconds{0};  // time including creation of Objects and their buffers
+};
+
+class SceneReader
+/** Maps a scene file into memory and gives access to its tables without copying them.
+Uncompressed mesh blocks are returned as pointers into the mapping; compressed blocks are decompressed once
+on first access. The header and all table bounds are validated in the constructor. */
+{
+public:
+    explicit SceneReader(const std::string& file_path);
+
+    const SceneFileHeader& header() const{return *header_;}
+
+    size_t objectCount() const{return static_cast<size_t>(header_->object_count);}
+    const SceneObjectRecord* objects() const{return objects_;}
+    std::string comment(const SceneObjectRecord& record) const;
+
+    size_t meshCount() const{return header_->mesh_count;}
+    const SceneMeshEntry& meshEntry(size_t mesh_id) const{return meshes_[mesh_id];}
+    const GLfloat* meshVertices(size_t mesh_id);
+    const GLuint* meshIndices(size_t mesh_id);
+
+private:
+    MappedFile file_;
+    const SceneFileHeader* header_{nullptr};
+    const SceneMeshEntry* meshes_{nullptr};
+    const SceneObjectRecord* objects_{nullptr};
+    const char* comments_{nullptr};
+    std::vector<std::vector<unsigned char>> decompressed_blocks_;
+
+    const unsigned char* meshBlock_(size_t mesh_id);
+};
+
+class SceneFile
+/** Saves all Objects of a Session into a scene file and restores a Session from it. */
+{
+public:
+    static SceneFileStats save(const Session& session, const std::string& file_path, bool compress_meshes);
+    static SceneFileStats load(Session& session, const std::string& file_path);
+
+    static bool isCompressionAvailable();
+};
+
+#endif //PROJECT_1_SCENE_FILE_H
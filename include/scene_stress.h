@@ -0,0 +1,80 @@
+#ifndef PROJECT_1_SCENE_STRESS_H
+#define PROJECT_1_SCENE_STRESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "../include/session.h"
+#include "../include/frame_stats.h"
+
+enum class StressDistribution : uint8_t
+{
+    kUniform,  // positions are spread evenly over the area
+    kNormal    // positions are denser in the middle of the area (standard deviation - a third of the area)
+};
+
+enum class StressColoring : uint8_t
+{
+    kRandom,    // every Object gets its own colour
+    kPerType,   // Objects of one type share a colour
+    kPerCluster // Objects of one cluster share a colour (kRandom without clusters)
+};
+
+struct StressParameters
+{
+    int object_count{1000};
+    unsigned seed{1};
+
+    // Relative frequency of every built-in type and of all registered meshes (imported meshes and primitives)
+    // together; a registered mesh is picked evenly among them.
+    float type_weights[kBuiltinObjectTypeCount]{1.0f, 1.0f, 1.0f, 1.0f};
+    float registered_weight{0.0f};
+
+    // Objects are placed in [-spread, spread] along every axis, around cluster centers if clusters are enabled.
+    StressDistribution distribution{StressDistribution::kUniform};
+    float spread[3]{7.0f, 3.5f, 0.0f};
+    int cluster_count{0};
+    float cluster_radius{0.5f};
+
+    bool random_rotation{true};
+    StressColoring coloring{StressColoring::kRandom};
+};
+
+struct StressStats
+{
+    size_t object_count;
+    double seconds;
+};
+
+class SceneStress
+/** SceneStress replaces the scene with a generated one to reproduce large scenes: N Objects with a mix of types,
+random positions, rotations and colours. The same parameters and seed always generate the same scene. */
+{
+public:
+    static StressStats populate(Session& session, const StressParameters& parameters);
+};
+
+class ZoomFlythrough
+/** ZoomFlythrough zooms the camera into the scene and back out over a fixed number of frames and records the frame
+time of every frame on the way. The camera ends where it started. */
+{
+public:
+    // Zoom in during the first half of frames by this much in total (see DrawingLib::zoom), out during the second.
+    static constexpr double kZoomDepth = 0.9;
+
+    void start(int frame_count);
+    bool isRunning() const{return frames_left_ > 0;};
+    double nextZoomStep();
+    bool addFrameTime(double milliseconds);
+
+    const FrameStats& getStats() const{return stats_;};
+    std::string summary() const;
+
+private:
+    int frame_count_{0};
+    int frames_left_{0};
+    FrameStats stats_;
+};
+
+#endif //PROJECT_1_SCENE_STRESS_H
@@ -0,0 +1,88 @@
+#ifndef PROJECT_1_SCENE_UPDATER_H
+#define PROJECT_1_SCENE_UPDATER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../include/session.h"
+#include "../include/triple_buffer.h"
+
+// Immutable state of the scene that the render thread draws: one draw item per Object, in Session order.
+struct RenderSnapshot
+{
+    // Session::getStructureVersion() when the snapshot was made. If it differs from the current one,
+    // buffers in the snapshot may already be deleted, and the snapshot must not be drawn.
+    uint64_t structure_version{UINT64_MAX};
+    std::vector<ObjectDrawItem> items;
+};
+
+// Change of the scene requested by input handling and applied on the update thread.
+struct SceneCommand
+{
+    enum Type
+    {
+        kMove,
+        kRotate,
+        kMoveGuiPanels,
+        kCloseHistoryEntry
+    };
+
+    Type type;
+    // Objects the command applies to, as bits over indices in Session. Commands are always applied before Objects
+    // are added or removed, so indices stay valid (see SceneUpdater::applyQueuedCommands).
+    SelectionSet objects;
+    double delta_x;
+    double delta_y;
+    float window_width;
+    float window_height;
+};
+
+class SceneUpdater
+/** SceneUpdater moves scene mutation off the render thread. Input handling queues SceneCommands; the update thread
+applies them to Session (under Session's mutex) and publishes a RenderSnapshot through a triple buffer, so the
+render thread takes the newest snapshot without waiting and only submits it to OpenGL.
+The update thread never calls OpenGL: creating/removing Objects, colours and undo stay on the render thread.
+The render thread must call applyQueuedCommands (holding Session's mutex) before it changes Session itself. */
+{
+public:
+    explicit SceneUpdater(Session& session) : session_(session){};
+    ~SceneUpdater(){stop();};
+
+    SceneUpdater(const SceneUpdater&) = delete;
+    SceneUpdater& operator=(const SceneUpdater&) = delete;
+
+    // on_scene_changed is called on the update thread after a snapshot with applied commands is published.
+    void start(std::function<void()> on_scene_changed);
+    void stop();
+
+    void enqueue(SceneCommand command);
+    void requestSnapshot();
+
+    // Applies queued commands on the calling thread; the caller must hold Session's mutex.
+    bool applyQueuedCommands();
+    static void applyCommand(Session& session, const SceneCommand& command);
+
+    // Newest published snapshot, only for the render thread.
+    const RenderSnapshot& latestSnapshot();
+
+private:
+    Session& session_;
+    std::thread thread_;
+    std::function<void()> on_scene_changed_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable wake_up_;
+    std::vector<SceneCommand> commands_;
+    bool snapshot_requested_{false};
+    bool running_{false};
+
+    TripleBuffer<RenderSnapshot> snapshots_;
+
+    void run_();
+};
+
+#endif //PROJECT_1_SCENE_UPDATER_H
@@ -0,0 +1,81 @@
+#ifndef PROJECT_1_SCENE_VIEW_H
+#define PROJECT_1_SCENE_VIEW_H
+
+#include <vector>
+
+#include "../include/math3d.h"
+#include "../include/object.h"
+#include "../include/config.h"
+
+// An Object that passed SceneView::cull: its index in the draw items and how much of it is drawn.
+struct VisibleItem
+{
+    int index;
+    ObjectDetail detail;
+};
+
+class SceneView
+/** SceneView is one view of the scene in a rectangle of the window with its own camera: viewing boundaries (zoom)
+and an orbit around the scene origin (yaw and pitch). All views draw the same draw items with the same buffers, only
+their matrices differ. cull finds the Objects a view has to draw, so several small views cost less than drawing the
+whole scene several times: Objects outside of the view frustum or smaller than a pixel are skipped, and small ones
+are drawn without their edges. */
+{
+public:
+    // Objects smaller than this on the screen (diameter of the bounding sphere in pixels) are not drawn.
+    static constexpr float kMinPixelSize = 1.0f;
+    // Objects smaller than this are drawn without the line pass of their edges, unless they are selected or hovered.
+    static constexpr float kEdgePixelSize = 12.0f;
+
+    SceneView(){updateMatrices_();};
+
+    void setRect(int x, int y, int width, int height, int window_height);
+    void zoom(double zooming_factor);
+    void orbit(double delta_yaw, double delta_pitch);
+    void setOrbit(float yaw, float pitch);
+
+    // The rectangle in window coordinates with y pointing down, like cursor coordinates.
+    int getX() const{return x_;};
+    int getY() const{return y_;};
+    int getWidth() const{return width_;};
+    int getHeight() const{return height_;};
+    bool contains(double x, double y) const;
+    // The same rectangle as glViewport expects it, with the origin in the bottom-left corner of the window.
+    math3d::Viewport getGlViewport() const;
+
+    const math3d::Mat4& getProjectionMatrix() const{return projection_matrix_;};
+    const math3d::Mat4& getViewMatrix() const{return view_matrix_;};
+    const math3d::Mat4& getInverseViewProjection() const{return inverse_view_projection_;};
+
+    void cull(const std::vector<ObjectDrawItem>& items, std::vector<VisibleItem>& visible_items,
+              ViewStats& stats) const;
+
+private:
+    int x_{0};
+    int y_{0};
+    int width_{1920};
+    int height_{1080};
+    int window_height_{1080};
+
+    double left_{-1};
+    double right_{1};
+    double bottom_{-1};
+    double top_{1};
+    double near_{1};
+    double far_{50};
+    double depth_correction_factor_{8.0f};
+
+    // Orbit of the camera around the scene origin in degrees: yaw around the y-axis, then pitch around the x-axis.
+    float yaw_{0.0f};
+    float pitch_{0.0f};
+
+    math3d::Mat4 projection_matrix_;
+    math3d::Mat4 view_matrix_;
+    math3d::Mat4 inverse_view_projection_;
+    // Planes of the view frustum in scene coordinates (a, b, c, d with a*x + b*y + c*z + d >= 0 inside).
+    math3d::Vec4 frustum_planes_[6];
+
+    void updateMatrices_();
+};
+
+#endif //PROJECT_1_SCENE_VIEW_H
@@ -0,0 +1,159 @@
+#ifndef PROJECT_1_SELECTION_SET_H
+#define PROJECT_1_SELECTION_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+class SelectionSet
+/** SelectionSet is a dense bitset with one bit per Object index in Session. Bulk operations (set/reset all, invert,
+intersect, count) work a 64-bit word at a time, and iteration visits only set bits, skipping empty words, so the
+cost of a selection depends on the number of selected Objects rather than on the size of the scene. */
+{
+public:
+    class const_iterator
+    /** Forward iterator over indices of set bits in increasing order. */
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        const_iterator(const SelectionSet& set, size_t word_index) : set_(&set), word_index_(word_index)
+        {
+            if (word_index_ < set_->words_.size())
+            {
+                word_ = set_->words_[word_index_];
+                skipEmptyWords_();
+            }
+        };
+
+        int operator*() const
+        {
+            return static_cast<int>(word_index_ * kWordBits) + countTrailingZeros_(word_);
+        };
+        const_iterator& operator++()
+        {
+            // Clears the lowest set bit.
+            word_ &= word_ - 1;
+            skipEmptyWords_();
+            return *this;
+        };
+        const_iterator operator++(int)
+        {
+            const_iterator previous = *this;
+            ++(*this);
+            return previous;
+        };
+        bool operator==(const const_iterator& other) const
+        {
+            return word_index_ == other.word_index_ && word_ == other.word_;
+        };
+        bool operator!=(const const_iterator& other) const{return !(*this == other);};
+
+    private:
+        const SelectionSet* set_;
+        size_t word_index_;
+        uint64_t word_{0};
+
+        void skipEmptyWords_()
+        {
+            while (word_ == 0 && ++word_index_ < set_->words_.size())
+            {
+                word_ = set_->words_[word_index_];
+            }
+            if (word_ == 0)
+            {
+                word_index_ = set_->words_.size();
+            }
+        };
+    };
+
+    SelectionSet() = default;
+    explicit SelectionSet(size_t size){resize(size);};
+
+    size_t size() const{return size_;};
+    void resize(size_t size);
+    void pushBack(bool value);
+    void erase(size_t index);
+
+    bool test(size_t index) const{return (words_[index / kWordBits] >> (index % kWordBits)) & 1u;};
+    void set(size_t index, bool value = true)
+    {
+        uint64_t mask = uint64_t{1} << (index % kWordBits);
+        if (value)
+        {
+            words_[index / kWordBits] |= mask;
+        }
+        else
+        {
+            words_[index / kWordBits] &= ~mask;
+        }
+    };
+
+    void setAll();
+    void resetAll();
+    void invert();
+    void intersect(const SelectionSet& other);
+    void unite(const SelectionSet& other);
+    size_t count() const;
+    bool any() const;
+    bool none() const{return !any();};
+
+    const_iterator begin() const{return {*this, 0};};
+    const_iterator end() const{return {*this, words_.size()};};
+    std::vector<int> toIndices() const;
+
+    bool operator==(const SelectionSet& other) const{return size_ == other.size_ && words_ == other.words_;};
+    bool operator!=(const SelectionSet& other) const{return !(*this == other);};
+
+private:
+    static constexpr size_t kWordBits = 64;
+
+    std::vector<uint64_t> words_;
+    size_t size_{0};
+
+    void clearUnusedBits_();
+
+    static int countTrailingZeros_(uint64_t word)
+    /** Index of the lowest set bit, word must not be zero. */
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return static_cast<int>(index);
+#elif defined(__GNUC__)
+        return __builtin_ctzll(word);
+#else
+        int index = 0;
+        while ((word & 1u) == 0)
+        {
+            word >>= 1;
+            index++;
+        }
+        return index;
+#endif
+    };
+
+    static int popCount_(uint64_t word)
+    {
+#if defined(__GNUC__)
+        return __builtin_popcountll(word);
+#else
+        // Counts bits of all bytes in parallel.
+        word = word - ((word >> 1) & 0x5555555555555555ull);
+        word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+        word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return static_cast<int>((word * 0x0101010101010101ull) >> 56);
+#endif
+    };
+};
+
+#endif //PROJECT_1_SELECTION_SET_H
@@ -1,7 +1,27 @@
 #ifndef PROJECT_1_SESSION_H
 #define PROJECT_1_SESSION_H
 
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 #include "../include/object.h"
+#include "../include/history.h"
+#include "../include/selection_set.h"
+#include "../include/pick_id_allocator.h"
+
+enum class VertexFormat : int;
+
+// Placement of Objects created together by Session::addObjects: a grid of `columns` columns, filled row by row from
+// the top, with `spacing` between neighbours and centered on `center`. With columns = 0 all Objects are placed at
+// `center`, like add_object places a single one.
+struct ObjectLayout
+{
+    int columns{0};
+    float spacing{0.5f};
+    float center[2]{0.0f, 0.0f};
+};
 
 class Session
 /* Class Session contains all Object instances created in a session of application. Application manipulates objects
@@ -9,35 +29,81 @@ through Session by object id.*/
 {
 public:
     void add_object(ObjectType object_type);
+    void addObjects(ObjectType object_type, int count, const ObjectLayout& layout = ObjectLayout());
+    Object& restore_object(int id, ObjectType object_type, const GLfloat rgb[3]);
     void remove_object(int object_id);
+    void clear();
+    void reserve(size_t object_count){objects_.reserve(object_count);}
+    void setVertexFormat(VertexFormat vertex_format);
+    void compactMeshBuffers();
+    // Objects are GPU-resident by default; otherwise each keeps host copies of its mesh and colours.
+    bool getGpuResidentObjects() const{return gpu_resident_objects_;};
+    void setGpuResidentObjects(bool gpu_resident);
 
     void loadAllObjectsBuffers();
-    void drawAllObjects(bool get_pick_color);
+    void fillDrawItems(std::vector<ObjectDrawItem>& items) const;
     void drawAllObjectsMetadata();
-    int getObjectIdByPickColor(const unsigned char* pick_color);
+    int getObjectIdByPickColor(const unsigned char* pick_color) const;
 
     void reset();
 
-    void updateObjectsCoordinates(const std::vector<int>& object_ids, double delta_x, double delta_y);
-    void updateObjectsRotation(const std::vector<int>& object_ids, double delta_x, double delta_y);
-    void updateObjectsGuiCoordinates(const std::vector<int>& object_ids, float window_width, float window_height, double delta_x, double delta_y);
+    void updateObjectsCoordinates(const SelectionSet& objects, double delta_x, double delta_y);
+    void updateObjectsRotation(const SelectionSet& objects, double delta_x, double delta_y);
+    void updateObjectsGuiCoordinates(const SelectionSet& objects, float window_width, float window_height, double delta_x, double delta_y);
 
     std::vector<Object>& getObjects(){return objects_;};
-    std::vector<int> getSelectedObjects();
+    const std::vector<Object>& getObjects() const{return objects_;};
+    // Selection is a bitset over indices in objects_, it is kept in sync when Objects are added or removed.
+    const SelectionSet& getSelection() const{return selection_;};
+    bool isSelected(size_t object_index) const{return selection_.test(object_index);};
+    void setSelected(size_t object_index, bool selected);
 
     void selectAllObjects();
     void deSelectAllObjects();
+    void invertSelection();
 
     void selectObjectsInFrame(const std::vector<int> &object_ids);
 
+    // The mutex guards Objects when the scene is updated on a separate thread (see SceneUpdater).
+    std::mutex& getMutex(){return mutex_;};
+    // Changes whenever Objects are added or removed, i.e. when indices in objects_ and GL buffers change.
+    uint64_t getStructureVersion() const{return structure_version_;};
+
+    History& getHistory(){return history_;};
+    const History& getHistory() const{return history_;};
+    bool undo();
+    bool redo();
+    void recordColorChange(int object_index, const float rgb_before[3]);
+    void recordCommentChange(int object_index, const std::string& comment_before);
+    void resetObjectTransform(int object_index);
+
+    // Full state of an Object and creating an Object from it (with the same id), for undo and input replay.
+    ObjectState captureObjectState(const Object& object) const;
+    void restoreObjectState(const ObjectState& state);
+    void applyObjectState(size_t object_index, const ObjectState& state);
+    // Changes whenever the session is cleared, i.e. when ids of removed Objects may be used again.
+    uint64_t getClearCount() const{return clear_count_;};
 
 private:
     std::vector<Object> objects_;
+    SelectionSet selection_;
     int current_object_id_{0};
-    int current_pick_color_[3]{0, 0, 0};
+    // Index in objects_ of the Object with a pick id, -1 for free ids.
+    PickIdAllocator pick_ids_;
+    std::vector<int> object_index_by_pick_id_;
+
+    History history_;
+    std::mutex mutex_;
+    uint64_t structure_version_{0};
+    uint64_t clear_count_{0};
+    bool gpu_resident_objects_{true};
+
+    uint32_t acquirePickId_(size_t object_index);
 
-    int generatePickColorID_();
-    void generateNewPickColor_();
+    std::vector<int> objectIdsByIndices_(const SelectionSet& objects) const;
+    std::unordered_map<int, size_t> indicesById_() const;
+    void eraseObject_(size_t object_index);
+    void applyHistoryEntry_(const HistoryEntry& entry, bool undo);
 };
 
 
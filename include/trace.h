@@ -0,0 +1,52 @@
+#ifndef PROJECT_1_TRACE_H
+#define PROJECT_1_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Scoped CPU trace zones. PROJECT_1_TRACE_ZONE("name") measures the time until the end of the enclosing scope and
+// stores it in a ring buffer of the calling thread. The name must be a string literal (only the pointer is stored).
+// When PROJECT_1_ENABLE_TRACING is not defined, zones are compiled out completely.
+#ifdef PROJECT_1_ENABLE_TRACING
+#define PROJECT_1_TRACE_CONCAT_IMPL(a, b) a##b
+#define PROJECT_1_TRACE_CONCAT(a, b) PROJECT_1_TRACE_CONCAT_IMPL(a, b)
+#define PROJECT_1_TRACE_ZONE(name) TraceZone PROJECT_1_TRACE_CONCAT(trace_zone_, __LINE__)(name)
+#else
+#define PROJECT_1_TRACE_ZONE(name) do {} while (false)
+#endif
+
+
+class Trace
+/** Trace collects finished zones of all threads. Every thread writes to its own buffer, so recording a zone
+doesn't wait for other threads; the buffers are only read when a trace is exported. */
+{
+public:
+    static bool isEnabled();
+
+    // Time in microseconds since the start of the application.
+    static uint64_t nowMicroseconds();
+
+    static void recordZone(const char* name, uint64_t start_us, uint64_t end_us);
+    static void setThreadName(const char* name);
+
+    // Writes zones of the last `seconds` seconds to a Chrome/Perfetto JSON trace, returns the number of zones.
+    static size_t exportChromeTrace(const std::string& path, double seconds);
+};
+
+class TraceZone
+/** TraceZone records a zone from its construction to its destruction, it's created by PROJECT_1_TRACE_ZONE. */
+{
+public:
+    explicit TraceZone(const char* name) : name_(name), start_us_(Trace::nowMicroseconds()){};
+    ~TraceZone(){Trace::recordZone(name_, start_us_, Trace::nowMicroseconds());};
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+private:
+    const char* name_;
+    uint64_t start_us_;
+};
+
+#endif //PROJECT_1_TRACE_H
@@ -0,0 +1,47 @@
+#ifndef PROJECT_1_TRIPLE_BUFFER_H
+#define PROJECT_1_TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+template <typename T>
+class TripleBuffer
+/** TripleBuffer hands the latest value over from one writer thread to one reader thread without locks.
+The writer fills writeBuffer() and calls publish(); the reader calls update() to take the newest published value
+and reads it with readBuffer(). Neither side waits for the other: the writer always has a free buffer and the reader
+keeps its buffer until it takes a newer one. Values that were published but never taken are overwritten. */
+{
+public:
+    T& writeBuffer(){return buffers_[write_index_];};
+
+    void publish()
+    {
+        // The written buffer becomes the middle one (marked as new) and the previous middle one is written next.
+        uint8_t previous = middle_.exchange(static_cast<uint8_t>(write_index_ | kNewValueFlag), std::memory_order_acq_rel);
+        write_index_ = previous & kIndexMask;
+    };
+
+    bool update()
+    {
+        if ((middle_.load(std::memory_order_acquire) & kNewValueFlag) == 0)
+        {
+            return false;
+        }
+        uint8_t previous = middle_.exchange(read_index_, std::memory_order_acq_rel);
+        read_index_ = previous & kIndexMask;
+        return true;
+    };
+
+    const T& readBuffer() const{return buffers_[read_index_];};
+
+private:
+    static constexpr uint8_t kIndexMask = 3;
+    static constexpr uint8_t kNewValueFlag = 4;
+
+    T buffers_[3];
+    uint8_t write_index_{0};
+    std::atomic<uint8_t> middle_{1};
+    uint8_t read_index_{2};
+};
+
+#endif //PROJECT_1_TRIPLE_BUFFER_H
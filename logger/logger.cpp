@@ -2,6 +2,12 @@
 #include <stdexcept>
 #include "imgui.h"
 
+
+ImGuiAl::Log* Logger::log_panel_;
+bool Logger::p_open_{true};
+char Logger::log_buffer_[kBufferSize];
+
+
 void Logger::drawLogger()
 /** Prints all logger messages. */
 {
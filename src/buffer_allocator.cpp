@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "../include/buffer_allocator.h"
+
+
+size_t BufferAllocator::allocate(size_t size)
+/** Returns the offset of a free range of size bytes (rounded up to kAlignment), or kNoSpace if no free block is
+large enough; the caller can grow the buffer and try again. */
+{
+    // An empty range still takes kAlignment bytes, so it has an offset of its own and can be freed.
+    size = alignedSize(std::max<size_t>(size, 1));
+    for (auto it = free_blocks_.begin(); it != free_blocks_.end(); ++it)
+    {
+        if (it->size < size)
+        {
+            continue;
+        }
+        size_t offset = it->offset;
+        it->offset += size;
+        it->size -= size;
+        if (it->size == 0)
+        {
+            free_blocks_.erase(it);
+        }
+        used_bytes_ += size;
+        return offset;
+    }
+    return kNoSpace;
+}
+
+void BufferAllocator::free(size_t offset, size_t size)
+/** Returns a range given by allocate with the same size. Throws std::runtime_error if the range is not allocated. */
+{
+    size = alignedSize(std::max<size_t>(size, 1));
+    auto next = std::lower_bound(free_blocks_.begin(), free_blocks_.end(), offset,
+                                 [](const Block& block, size_t value) { return block.offset < value; });
+    bool overlaps_previous = next != free_blocks_.begin() && std::prev(next)->offset + std::prev(next)->size > offset;
+    bool overlaps_next = next != free_blocks_.end() && offset + size > next->offset;
+    if (offset + size > capacity_ || overlaps_previous || overlaps_next)
+    {
+        throw std::runtime_error("Buffer range at " + std::to_string(offset) + " of " + std::to_string(size) +
+                                 " bytes was not allocated.");
+    }
+    used_bytes_ -= size;
+
+    bool joins_previous = next != free_blocks_.begin() && std::prev(next)->offset + std::prev(next)->size == offset;
+    bool joins_next = next != free_blocks_.end() && offset + size == next->offset;
+    if (joins_previous && joins_next)
+    {
+        std::prev(next)->size += size + next->size;
+        free_blocks_.erase(next);
+    }
+    else if (joins_previous)
+    {
+        std::prev(next)->size += size;
+    }
+    else if (joins_next)
+    {
+        next->offset = offset;
+        next->size += size;
+    }
+    else
+    {
+        free_blocks_.insert(next, {offset, size});
+    }
+}
+
+void BufferAllocator::grow(size_t capacity)
+/** Adds free space at the end, allocated ranges keep their offsets. A smaller capacity is ignored. */
+{
+    capacity = alignedSize(capacity);
+    if (capacity <= capacity_)
+    {
+        return;
+    }
+    if (!free_blocks_.empty() && free_blocks_.back().offset + free_blocks_.back().size == capacity_)
+    {
+        free_blocks_.back().size += capacity - capacity_;
+    } else {
+        free_blocks_.push_back({capacity_, capacity - capacity_});
+    }
+    capacity_ = capacity;
+}
+
+void BufferAllocator::reset(size_t capacity)
+/** Frees all ranges at once and sets the capacity, e.g. before all ranges are allocated again packed. */
+{
+    capacity_ = alignedSize(capacity);
+    used_bytes_ = 0;
+    free_blocks_.clear();
+    if (capacity_ > 0)
+    {
+        free_blocks_.push_back({0, capacity_});
+    }
+}
+
+size_t BufferAllocator::getLargestFreeBlock() const
+{
+    size_t largest = 0;
+    for (const auto& block: free_blocks_)
+    {
+        largest = std::max(largest, block.size);
+    }
+    return largest;
+}
@@ -0,0 +1,7 @@
+#include "../include/config.h"
+
+
+Parameters Config::parameters_;
+InputStats Config::input_stats_;
+HoverPickStats Config::hover_pick_stats_;
+ViewStats Config::view_stats_;
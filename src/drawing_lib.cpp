@@ -4,9 +4,23 @@
 #include "backends/imgui_impl_opengl3.h"
 
 #include "../include/drawing_lib.h"
+#include "../include/input_recording.h"
+#include "../include/frame_capture.h"
 #include "../include/config.h"
+#include "../include/trace.h"
+#include "../include/frame_scheduler.h"
 
 
+DrawingLib::DrawingLib(Session& session) : session_(session)
+/** Views after the first one start turned, so a layout with several views shows the scene from other angles right
+away: from the side, from above and from an oblique angle. */
+{
+    views_[1].setOrbit(90.0f, 0.0f);
+    views_[2].setOrbit(0.0f, 90.0f);
+    views_[3].setOrbit(45.0f, 30.0f);
+    updateMatrices_();
+}
+
 GLFWwindow* DrawingLib::createWindow() const
 /** Creates and returns a new GLFW window with the specified width, height, and title. */
 {
@@ -14,23 +28,111 @@ GLFWwindow* DrawingLib::createWindow() const
 }
 
 void DrawingLib::getWindowSize(GLFWwindow* window)
-/** Retrieves the size of the specified GLFW window and updates the class variables for width, height, and dimension ratio. */
+/** Retrieves the size of the specified GLFW window and updates the class variables for width and height, and the views. */
 {
     int w, h;
     glfwGetFramebufferSize(window, &w, &h);
     window_width_  = w;
     window_height_ = h;
-    dim_ratio_ = static_cast<float>(window_height_) / static_cast<float>(window_width_);
+    updateMatrices_();
+}
+
+void DrawingLib::setWindowSize(int width, int height)
+/** Sets the size of the drawing area directly, e.g. for an off-screen framebuffer that has no GLFW window. */
+{
+    window_width_  = width;
+    window_height_ = height;
+    updateMatrices_();
 }
 
 void DrawingLib::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
-/** Handles mouse button events in a GLFW window. If the cursor position is not on any of ImGui elements,
-it performs actions on left-click, double left-click and right-click. */
+/** GLFW callback of mouse buttons, the event is handled by handleInput with the current cursor position. */
+{
+    InputEvent event{InputEvent::kMouseButton, glfwGetTime()};
+    glfwGetCursorPos(window, &event.x, &event.y);
+    event.button = button;
+    event.action = action;
+    event.mods = mods;
+    handleInput(event);
+}
+
+void DrawingLib::cursorPositionCallback(GLFWwindow* window, double xpos, double ypos)
+/** GLFW callback of cursor movements, see handleInput. */
+{
+    InputEvent event{InputEvent::kCursorPosition, glfwGetTime()};
+    event.x = xpos;
+    event.y = ypos;
+    handleInput(event);
+}
+
+void DrawingLib::scrollCallback(GLFWwindow* window, double yoffset)
+/** GLFW callback of the mouse wheel, see handleInput. */
+{
+    InputEvent event{InputEvent::kScroll, glfwGetTime()};
+    event.scroll_y = yoffset;
+    handleInput(event);
+}
+
+void DrawingLib::cursorEnterCallback(GLFWwindow* window, int entered)
+/** GLFW callback of the cursor entering or leaving the window, see handleInput. */
+{
+    InputEvent event{InputEvent::kCursorEnter, glfwGetTime()};
+    event.action = entered;
+    handleInput(event);
+}
+
+void DrawingLib::handleInput(const InputEvent& event)
+/** Handles one mouse event. GLFW callbacks and InputReplay both come here, so a replayed session goes through
+the same code as the recorded one; nothing here asks GLFW for the time or the cursor position, they are in the event.
+If an InputRecorder is set, the event is recorded first. */
+{
+    if (input_recorder_ != nullptr)
+    {
+        input_recorder_->recordInput(event);
+    }
+    switch (event.type)
+    {
+        case InputEvent::kMouseButton:
+            handleMouseButton_(event);
+            break;
+        case InputEvent::kCursorPosition:
+            handleCursorPosition_(event);
+            break;
+        case InputEvent::kScroll:
+            handleScroll_(event);
+            break;
+        case InputEvent::kCursorEnter:
+            // Nothing is hovered while the cursor is outside of the window.
+            cursor_in_window_ = event.action == GLFW_TRUE;
+            FrameScheduler::requestRedraw();
+            break;
+    }
+}
+
+void DrawingLib::handleMouseButton_(const InputEvent& event)
+/** Handles mouse button events. If the cursor position is not on any of ImGui elements,
+it performs actions on left-click, double left-click, right-click and middle-click in the view under the cursor. */
 {
+    FrameScheduler::requestRedraw();
+    // Movements made before the button changed belong to the previous selection, so they are applied first.
+    applyPendingInput();
+    // A drag or rotation ends (or a new one starts), so it becomes a separate undo step.
+    submitSceneCommand_({SceneCommand::kCloseHistoryEntry});
+    // The pick pass reads the pixel under the cursor where the button changed.
+    current_pos_x_ = event.x;
+    current_pos_y_ = event.y;
+    const int button = event.button;
+    const int action = event.action;
     // this boolean is initialized in main.py and checks if mouse position is on any of ImGui elements
     if (!imgui_capture_mouse_)
     {
-        double currentTime = glfwGetTime();
+        // The clicked view is picked, dragged in or turned until the next press, wherever the cursor moves meanwhile.
+        if (action == GLFW_PRESS && !left_button_down_ && !right_button_down_ && !middle_button_down_)
+        {
+            int view = getViewAt_(event.x, event.y);
+            active_view_ = view >= 0 ? view : active_view_;
+        }
+        double currentTime = event.time;
         if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
         {
             // get_color_ boolean enables part of the code that reads pixels in cursor position and defines if you interact with Objects
@@ -44,10 +146,11 @@ it performs actions on left-click, double left-click and right-click. */
             {
                 last_click_time_ = currentTime;
                 left_button_down_ = true;
-                glfwGetCursorPos(window, &cursor_pos_x_, &cursor_pos_y_);
+                cursor_pos_x_ = event.x;
+                cursor_pos_y_ = event.y;
                 // Objects can be selected with 3 different actions: checkmark in main panel, with drawing selection rectangle, click on the Object itself.
                 // Every single click all objects need to be checked if they are selected.
-                selected_object_id_ = session_.getSelectedObjects();
+                manipulated_objects_ = session_.getSelection();
             }
         }
 
@@ -55,9 +158,10 @@ it performs actions on left-click, double left-click and right-click. */
         {
             get_color_ = true;
             right_button_down_ = true;
-            glfwGetCursorPos(window, &cursor_pos_x_, &cursor_pos_y_);
+            cursor_pos_x_ = event.x;
+            cursor_pos_y_ = event.y;
             // The same reasoning as above: if several Objects are selected, actions associated with right-click are applied to all Objects.
-            selected_object_id_ = session_.getSelectedObjects();
+            manipulated_objects_ = session_.getSelection();
         }
         if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE)
         {
@@ -73,34 +177,38 @@ it performs actions on left-click, double left-click and right-click. */
         if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_RELEASE)
         {
             right_button_down_ = false;
-            selected_object_id_.clear();
+            manipulated_objects_.resetAll();
+        }
+        // Dragging with the middle button turns the camera of the view around the scene origin.
+        if (button == GLFW_MOUSE_BUTTON_MIDDLE)
+        {
+            middle_button_down_ = action == GLFW_PRESS;
         }
     }
 }
 
-void DrawingLib::cursorPositionCallback(GLFWwindow* window,
-                                        double input_cursor_pos_x,
-                                        double input_cursor_pos_y)
-/** Handles cursor movement events in a GLFW window.*/
+void DrawingLib::handleCursorPosition_(const InputEvent& event)
+/** Handles cursor movement events. Movements are only accumulated here,
+they are applied to Objects once per frame in applyPendingInput. */
 {
+    // ImGui hover state and the selection rectangle follow the cursor, so every movement needs a new frame.
+    FrameScheduler::requestRedraw();
+    Config::getInputStats().cursor_events_received++;
+    cursor_in_window_ = true;
+
     prev_pos_x_    = current_pos_x_;
     prev_pos_y_    = current_pos_y_;
-    current_pos_x_ = input_cursor_pos_x;
-    current_pos_y_ = input_cursor_pos_y;
+    current_pos_x_ = event.x;
+    current_pos_y_ = event.y;
 
     // if any Objects are selected and left button is down -> move selected Objects
-    if (left_button_down_ && !selected_object_id_.empty())
+    if (left_button_down_ && manipulated_objects_.any())
     {
-        auto delta_coordinates = calculateCoordinatesOnMouseMove();
-        session_.updateObjectsCoordinates(selected_object_id_, std::get<0>(delta_coordinates), std::get<1>(delta_coordinates));
-
-        // if Settings parameter to lock individual gui panels to Objects is  true -> move panels of selected Objects
-        if (Config::getParameters().lock_gui_to_objects){
-            session_.updateObjectsGuiCoordinates(selected_object_id_, window_width_, window_height_, current_pos_x_ - prev_pos_x_, current_pos_y_ - prev_pos_y_);
-        }
+        pending_move_x_ += current_pos_x_ - prev_pos_x_;
+        pending_move_y_ += current_pos_y_ - prev_pos_y_;
     }
     // if any Objects are selected and right button is down -> rotate selected Objects
-    if (right_button_down_ && !selected_object_id_.empty())
+    if (right_button_down_ && manipulated_objects_.any())
     {
         double delta_x = (current_pos_x_ - prev_pos_x_);
         double delta_y = (current_pos_y_ - prev_pos_y_);
@@ -108,10 +216,16 @@ void DrawingLib::cursorPositionCallback(GLFWwindow* window,
         if (std::abs(delta_x) >= std::abs(delta_y)) {delta_y = 0;}
         else {delta_x = 0;}
 
-        session_.updateObjectsRotation(selected_object_id_, delta_x, delta_y);
+        pending_rotation_x_ += delta_x;
+        pending_rotation_y_ += delta_y;
+    }
+    if (middle_button_down_)
+    {
+        pending_orbit_x_ += current_pos_x_ - prev_pos_x_;
+        pending_orbit_y_ += current_pos_y_ - prev_pos_y_;
     }
     // if left button is down and cursor is not on any Object, starts drawing rectangle to select Objects
-    if (left_button_down_ && selected_object_id_.empty())
+    if (left_button_down_ && manipulated_objects_.none())
     {
         // if it's the first frame of drawing rectangle, saves starting coordinates of the rectangle.
         if (!frame_box_)
@@ -123,32 +237,158 @@ void DrawingLib::cursorPositionCallback(GLFWwindow* window,
     }
 }
 
-void DrawingLib::scrollCallback(GLFWwindow* window, double yoffset)
-/** Callback function that handles scroll input from the mouse wheel to zoom in or out of the scene.
-If ImGui is not capturing the mouse input and the zoom level is adjusted based on the scroll direction. */
+void DrawingLib::handleScroll_(const InputEvent& event)
+/** Handles scroll input from the mouse wheel to zoom in or out of the view under the cursor.
+If ImGui is not capturing the mouse input, the zoom step is accumulated and applied in applyPendingInput. */
 {
+    FrameScheduler::requestRedraw();
+    Config::getInputStats().scroll_events_received++;
+    int view = getViewAt_(current_pos_x_, current_pos_y_);
     // This boolean is created and initialized in main.py. It checks if mouse position is on any of ImGui elements.
-    if (!imgui_capture_mouse_)
+    if (!imgui_capture_mouse_ && view >= 0)
     {
-        if (yoffset > 0)
+        if (event.scroll_y > 0)
         {
-            zoom(0.1);   // zoom-in
+            pending_zoom_steps_[view]++;   // zoom-in
         }
-        else if (yoffset < 0)
+        else if (event.scroll_y < 0)
         {
-            zoom(-0.1);   // zoom-out
+            pending_zoom_steps_[view]--;   // zoom-out
         }
     }
 }
 
+void DrawingLib::applyPendingInput()
+/** Applies cursor movements and scroll steps accumulated since the last frame: selected Objects are moved or rotated,
+views are turned and zoomed once per frame, no matter how many events the mouse has sent. */
+{
+    PROJECT_1_TRACE_ZONE("DrawingLib::applyPendingInput");
+    auto& input_stats = Config::getInputStats();
+
+    if ((pending_move_x_ != 0 || pending_move_y_ != 0) && manipulated_objects_.any())
+    {
+        auto delta_coordinates = calculateCoordinatesOnMouseMove(pending_move_x_, pending_move_y_);
+        submitSceneCommand_({SceneCommand::kMove, manipulated_objects_,
+                             std::get<0>(delta_coordinates), std::get<1>(delta_coordinates)});
+
+        // if Settings parameter to lock individual gui panels to Objects is  true -> move panels of selected Objects
+        if (Config::getParameters().lock_gui_to_objects){
+            submitSceneCommand_({SceneCommand::kMoveGuiPanels, manipulated_objects_, pending_move_x_, pending_move_y_,
+                                 static_cast<float>(window_width_), static_cast<float>(window_height_)});
+        }
+        input_stats.cursor_updates_applied++;
+    }
+    if ((pending_rotation_x_ != 0 || pending_rotation_y_ != 0) && manipulated_objects_.any())
+    {
+        submitSceneCommand_({SceneCommand::kRotate, manipulated_objects_, pending_rotation_x_, pending_rotation_y_});
+        input_stats.cursor_updates_applied++;
+    }
+    if (pending_orbit_x_ != 0 || pending_orbit_y_ != 0)
+    {
+        views_[active_view_].orbit(pending_orbit_x_ * ORBIT_DEGREES_PER_PIXEL, pending_orbit_y_ * ORBIT_DEGREES_PER_PIXEL);
+        input_stats.cursor_updates_applied++;
+    }
+    for (int i = 0; i < kMaxViews; i++)
+    {
+        if (pending_zoom_steps_[i] != 0)
+        {
+            views_[i].zoom(0.1 * pending_zoom_steps_[i]);
+            input_stats.scroll_updates_applied++;
+        }
+        pending_zoom_steps_[i] = 0;
+    }
+
+    pending_move_x_ = pending_move_y_ = 0;
+    pending_rotation_x_ = pending_rotation_y_ = 0;
+    pending_orbit_x_ = pending_orbit_y_ = 0;
+}
+
+void DrawingLib::submitSceneCommand_(SceneCommand command)
+/** Queues a change of the scene for the update thread or, without a SceneUpdater (e.g. in the benchmark),
+applies it immediately. */
+{
+    if (scene_updater_ != nullptr)
+    {
+        scene_updater_->enqueue(std::move(command));
+    }
+    else
+    {
+        SceneUpdater::applyCommand(session_, command);
+    }
+}
+
 void DrawingLib::zoom(double zooming_factor)
-/** Adjusts the viewing boundaries of the scene to achieve zooming in or out.
-Modifies the left, right, top, and bottom boundaries of the viewing frustum based on the given zooming factor. */
+/** Zooms all shown views in or out by the given zooming factor (see SceneView::zoom), e.g. for the zoom flythrough.
+The mouse wheel zooms only the view under the cursor. */
+{
+    for (int i = 0; i < view_count_; i++)
+    {
+        views_[i].zoom(zooming_factor);
+    }
+}
+
+void DrawingLib::updateMatrices_()
+/** Divides the window into views of the current layout and re-computes the matrices that depend on the window
+size. */
+{
+    view_layout_ = Config::getParameters().view_layout;
+    int columns = 1, rows = 1;
+    if (view_layout_ == ViewLayout::kSideBySide)
+    {
+        columns = 2;
+    }
+    else if (view_layout_ == ViewLayout::kQuad)
+    {
+        columns = rows = 2;
+    }
+    view_count_ = columns * rows;
+    for (int i = 0; i < view_count_; i++)
+    {
+        int column = i % columns, row = i / columns;
+        int x = window_width_ * column / columns, y = window_height_ * row / rows;
+        views_[i].setRect(x, y, window_width_ * (column + 1) / columns - x, window_height_ * (row + 1) / rows - y,
+                          window_height_);
+    }
+    if (active_view_ >= view_count_)
+    {
+        active_view_ = 0;
+    }
+
+    // Selection box is drawn in window pixels with y-axis pointing down, like cursor coordinates.
+    frame_box_projection_ = math3d::Mat4::ortho(0.0f, static_cast<float>(window_width_),
+                                                static_cast<float>(window_height_), 0.0f, -1.0f, 1.0f);
+}
+
+void DrawingLib::updateLayout_()
+/** Lays the views out again if the layout was changed in Settings (or by a replay) since the last frame. */
+{
+    if (Config::getParameters().view_layout != view_layout_)
+    {
+        updateMatrices_();
+    }
+}
+
+int DrawingLib::getViewAt_(double x, double y) const
+/** Returns the index of the view at window coordinates (x, y), or -1 if the point is outside of the window. */
 {
-    left_ += zooming_factor;
-    right_ -= zooming_factor;
-    top_    = top_ - zooming_factor;
-    bottom_ = bottom_ + zooming_factor;
+    for (int i = 0; i < view_count_; i++)
+    {
+        if (views_[i].contains(x, y))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+std::tuple<double, double> DrawingLib::clampToActiveView_(double x, double y) const
+/** Moves a point in window coordinates into the active view, so the selection rectangle ends at its border. */
+{
+    const SceneView& view = views_[active_view_];
+    return std::make_tuple(std::min(std::max(x, static_cast<double>(view.getX())),
+                                    static_cast<double>(view.getX() + view.getWidth())),
+                           std::min(std::max(y, static_cast<double>(view.getY())),
+                                    static_cast<double>(view.getY() + view.getHeight())));
 }
 
 void DrawingLib::defineCallbackFunction(GLFWwindow* window)
@@ -173,15 +413,88 @@ void DrawingLib::defineCallbackFunction(GLFWwindow* window)
         auto* drawing_lib = static_cast<DrawingLib*>(glfwGetWindowUserPointer(win));
         drawing_lib->scrollCallback(win, yoffset);
     });
+    // Nothing is hovered while the cursor is outside of the window.
+    glfwSetCursorEnterCallback(window, [](GLFWwindow* win, int entered) {
+        auto* drawing_lib = static_cast<DrawingLib*>(glfwGetWindowUserPointer(win));
+        drawing_lib->cursorEnterCallback(win, entered);
+    });
+
+    // Other events don't change the scene directly, but ImGui reacts to them (keyboard input) or the window content
+    // has to be drawn again (resizing, exposing a hidden window), so they only request a new frame.
+    // ImGui installs its own key, char and focus callbacks later and calls these ones from them.
+    glfwSetKeyCallback(window, [](GLFWwindow* win, int key, int scancode, int action, int mods) {
+        FrameScheduler::requestRedraw();
+    });
+    glfwSetCharCallback(window, [](GLFWwindow* win, unsigned int codepoint) {
+        FrameScheduler::requestRedraw();
+    });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow* win, int focused) {
+        FrameScheduler::requestRedraw();
+    });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* win, int width, int height) {
+        FrameScheduler::requestRedraw();
+    });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow* win) {
+        FrameScheduler::requestRedraw();
+    });
 }
 
 void DrawingLib::drawScene(GLFWwindow* window, bool imGuiCaptureMouse)
 /**  Manages the rendering pipeline and interaction handling for the graphical scene using OpenGL and ImGui. */
 {
+    PROJECT_1_TRACE_ZONE("DrawingLib::drawScene");
+    bool pick_frame = renderScene(imGuiCaptureMouse);
+
+    {
+        PROJECT_1_TRACE_ZONE("ImGui::Render");
+        ImGui::Render(); // Finalizes the ImGui frame and prepares the draw data for rendering.
+        // Renders the compiled ImGui draw data using the OpenGL 3 backend.
+        // Takes the draw data and issues the necessary OpenGL commands to display the ImGui interface.
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    }
+
+    if (!pick_frame)
+    {
+        // The finished frame is copied before the swap, the back buffer is undefined afterwards.
+        if (frame_capture_ != nullptr)
+        {
+            frame_capture_->captureFrame(window_width_, window_height_);
+        }
+
+        // Swaps the front and back buffers of the specified window.
+        // In double-buffered mode, rendering is done to the back buffer while the front buffer is displayed on the screen.
+        // Buffers should be swapped only when Objects are drawn with regular colors (not pick_colors).
+        PROJECT_1_TRACE_ZONE("glfwSwapBuffers");
+        glfwSwapBuffers(window);
+    }
+}
+
+bool DrawingLib::renderScene(bool imGuiCaptureMouse)
+/** Draws the scene without ImGui and without a window: hover picking, the frame itself or the pick pass that handles
+clicks and the selection rectangle. Returns true if the frame was drawn with pick colours and must not be shown.
+InputReplay uses it directly to draw frames off-screen. */
+{
+    PROJECT_1_TRACE_ZONE("DrawingLib::renderScene");
     imgui_capture_mouse_ = imGuiCaptureMouse;
+    updateLayout_();
+
+    // The pixel under the cursor is rendered before the frame is cleared (see HoverPicker).
+    // Frames with pick colours already draw everything under the cursor, they keep the last result.
+    if (!get_color_)
+    {
+        if (Config::getParameters().hover_picking && cursor_in_window_ && !imgui_capture_mouse_ && !frame_box_)
+        {
+            updateHoverPick(current_pos_x_, current_pos_y_);
+        }
+        else
+        {
+            hover_picker_.clear();
+        }
+    }
 
     // Viewport is the region of the window where the rendered image is displayed.
-    //It's specified in screen coordinates, with (0, 0) being the bottom-left corner of the window
+    //It's specified in screen coordinates, with (0, 0) being the bottom-left corner of the window.
+    // Every view sets its own viewport when it is drawn, see drawFrame.
     glViewport(0, 0, (GLsizei)window_width_, (GLsizei) window_height_);
 
     //  Enables depth testing, which ensures that objects are rendered in the correct order based on their distance from the camera.
@@ -191,6 +504,18 @@ void DrawingLib::drawScene(GLFWwindow* window, bool imGuiCaptureMouse)
     // Clears the color and depth buffers to preset values, preparing the frame buffer for new rendering.
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    // The pick pass changes Objects (selection, panels) and metadata reads them, so the update thread has to wait
+    // until they are done. Commands queued before are applied first to keep their order.
+    std::unique_lock<std::mutex> session_lock(session_.getMutex(), std::defer_lock);
+    if (get_color_ || Config::getParameters().show_metadata || !isSnapshotCurrent_())
+    {
+        session_lock.lock();
+        if (scene_updater_ != nullptr)
+        {
+            scene_updater_->applyQueuedCommands();
+        }
+    }
+
     // Draws metadata text if 'Show metadata' is selected in Settings
     if (Config::getParameters().show_metadata)
     {
@@ -199,23 +524,20 @@ void DrawingLib::drawScene(GLFWwindow* window, bool imGuiCaptureMouse)
     // get_color_ is set to true when there is an interaction with GLFW window.
     if (get_color_)
     {
-        double x_coord, y_coord;
-        unsigned char color[3];
+        PROJECT_1_TRACE_ZONE("pick pass");
         // When get_color_ is true, Objects are drawn with pick_colors (not general colors), and every Object has a unique pick_color,
         // that allows to identify Object id.
-        drawFrame();
-        glfwGetCursorPos(window, &x_coord, &y_coord);
+        drawFrame(get_color_);
 
-        glReadPixels(x_coord, window_height_ - y_coord, 1, 1, GL_RGB, GL_UNSIGNED_BYTE, color);
-        auto object_id = session_.getObjectIdByPickColor(color);
+        auto object_id = readObjectIdAt(current_pos_x_, current_pos_y_);
 
         if (left_double_click_)
         {
             // if double left-click is on empty area and there are selected Objects, all Objects are deselected.
-            if (!selected_object_id_.empty() && object_id < 0)
+            if (manipulated_objects_.any() && object_id < 0)
             {
                 session_.deSelectAllObjects();
-                selected_object_id_.clear();
+                manipulated_objects_.resetAll();
             }
             // if double left-click is on a Object, opens individual ImGui window
             if (object_id >= 0)
@@ -230,115 +552,250 @@ void DrawingLib::drawScene(GLFWwindow* window, bool imGuiCaptureMouse)
             // get_color_ is set to true when frame_box_ and left button is released that indicates end of rectangle drawing
             if (frame_box_)
             {
-                selected_object_id_.clear();
-                // reads pixels inside the drawn rectangle to get a set of unique colors
-                auto colors = getColorsInSelection(start_pos_x_, start_pos_y_, current_pos_x_, current_pos_y_);
-
-                for (auto c : colors)
+                // reads pixels inside the drawn rectangle to get ids of all visible Objects,
+                // only the active view was drawn with pick colours
+                double end_x, end_y;
+                std::tie(end_x, end_y) = clampToActiveView_(current_pos_x_, current_pos_y_);
+                auto object_ids = Config::getParameters().box_select_occlusion_queries
+                        ? queryObjectIdsInRect(start_pos_x_, start_pos_y_, end_x, end_y)
+                        : readObjectIdsInRect(start_pos_x_, start_pos_y_, end_x, end_y);
+                frame_box_ = false;
+                session_.selectObjectsInFrame(object_ids);
+                manipulated_objects_ = SelectionSet(session_.getObjects().size());
+                for (auto id: object_ids)
                 {
-                    // same steps to identify selected Objects as when there is left-clicking on the Object
-                    auto obj_id = session_.getObjectIdByPickColor(&c[0]);
-                    if (obj_id >= 0 && std::find(selected_object_id_.begin(), selected_object_id_.end(), obj_id) == selected_object_id_.end()) {
-                        selected_object_id_.push_back(obj_id);
-                    }
+                    manipulated_objects_.set(id);
                 }
-                frame_box_ = false;
-                session_.selectObjectsInFrame(selected_object_id_);
             }
-            // if left- ot right-click on an Object, its id is added the vector selected_object_id_ and
-            // following manipulations to Objects are applied to all Objects in this vetor
-            if (object_id >= 0 && std::find(selected_object_id_.begin(), selected_object_id_.end(), object_id) == selected_object_id_.end())
+            // if left- ot right-click on an Object, it's added to manipulated_objects_ and
+            // following manipulations to Objects are applied to all Objects in this set
+            if (object_id >= 0)
             {
-                selected_object_id_.push_back(object_id);
+                manipulated_objects_.resize(session_.getObjects().size());
+                manipulated_objects_.set(object_id);
             }
         }
 
     }
     else
     {
-        drawFrame(); // draw frame with regular colours
+        drawFrame(get_color_); // draw frame with regular colours
+        if (view_count_ > 1)
+        {
+            drawViewBorders();
+        }
     }
 
     if (frame_box_)
     {
         drawFrameBox();
     }
+    if (session_lock.owns_lock())
+    {
+        session_lock.unlock();
+    }
 
-    ImGui::Render(); // Finalizes the ImGui frame and prepares the draw data for rendering.
-    // Renders the compiled ImGui draw data using the OpenGL 3 backend.
-    // Takes the draw data and issues the necessary OpenGL commands to display the ImGui interface.
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-    if (!get_color_)
+    bool pick_frame = get_color_;
+    if (pick_frame)
     {
-        // Swaps the front and back buffers of the specified window.
-        // In double-buffered mode, rendering is done to the back buffer while the front buffer is displayed on the screen.
-        // Buffers should be swapped only when Objects are drawn with regular colors (not pick_colors).
-        glfwSwapBuffers(window);
+        // A frame with pick colours is never shown, the next frame has to be drawn with regular colours.
+        FrameScheduler::requestRedraw();
     }
     get_color_ = false;
+    return pick_frame;
 }
 
-void DrawingLib::drawFrame()
-/** Sets up the projection and model-view matrices for a perspective view, then translates the scene and draws all objects.*/
+void DrawingLib::drawFrame(bool get_pick_color)
+/** Draws all Objects in every view of the layout, each view with its own viewport and matrices and all of them from the
+same draw items and buffers. If get_pick_color is true, Objects are drawn with their pick colours to identify them by
+pixel colour, only in the active view: clicks and the selection rectangle belong to it.
+With a SceneUpdater, Objects are drawn from its newest render snapshot instead of Session. */
 {
-    // Switches the current matrix mode to the projection matrix.
-    // It indicates that subsequent matrix operations (like glLoadIdentity(), glOrtho(), glFrustum(), etc.)
-    // will affect the projection matrix.
-    glMatrixMode(GL_PROJECTION);
+    PROJECT_1_TRACE_ZONE("DrawingLib::drawFrame");
+    updateLayout_();
+    // Neighbouring pick ids differ by one in the lowest bit of blue, so pick colours must be written exactly.
+    if (get_pick_color)
+    {
+        glDisable(GL_DITHER);
+    }
+    else
+    {
+        glEnable(GL_DITHER);
+    }
+    const std::vector<ObjectDrawItem>& items = currentDrawItems_();
 
-    // Resets the transformation to its initial state, meaning no transformations are applied.
-    // This is typically done before you apply any custom transformations to objects in your scene
-    glLoadIdentity();
+    if (get_pick_color)
+    {
+        // Statistics in Settings describe frames that are shown.
+        ViewStats pick_stats;
+        drawView_(views_[active_view_], items, true, -1, pick_stats);
+        return;
+    }
+    int hovered_object = getHoveredObject();
+    auto& view_stats = Config::getViewStats();
+    view_stats = ViewStats();
+    for (int i = 0; i < view_count_; i++)
+    {
+        drawView_(views_[i], items, false, hovered_object, view_stats);
+    }
+}
 
-    // Defines a perspective matrix that produces a perspective projection.
-    // This projection matrix transforms coordinates from 3D world space to 2D screen space.
-    // The resulting view frustum is a truncated pyramid.
-    glFrustum(left_, right_, bottom_ * dim_ratio_, top_ * dim_ratio_, near_, far_);
+void DrawingLib::drawView_(const SceneView& view, const std::vector<ObjectDrawItem>& items, bool get_pick_color,
+                           int hovered_object, ViewStats& stats)
+/** Draws Objects into the rectangle of one view. With 'Cull objects per view' in Settings, only the Objects that
+SceneView::cull keeps are drawn, small ones without their edges. With 'Occlusion culling', Objects hidden behind
+large ones are skipped as well (see OcclusionCuller), in the pick pass too. */
+{
+    const math3d::Viewport viewport = view.getGlViewport();
+    glViewport(static_cast<GLint>(viewport.x), static_cast<GLint>(viewport.y),
+               static_cast<GLsizei>(viewport.width), static_cast<GLsizei>(viewport.height));
+
+    // Loads the perspective projection matrix of the view. It transforms coordinates
+    // from 3D world space to 2D screen space.
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(view.getProjectionMatrix().data());
 
     // After setting up the projection matrix, switches to GL_MODELVIEW mode to handle model transformations.
+    // Every Object loads its own model-view matrix (view matrix * model matrix), see Object::drawItem.
     glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    glLoadMatrixf(view.getViewMatrix().data());
 
-    glTranslatef(0.0f, 0.0f, -depth_correction_factor_);
+    if (Config::getParameters().view_culling)
+    {
+        view.cull(items, visible_items_, stats);
+    }
+    else
+    {
+        visible_items_.clear();
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            visible_items_.push_back({static_cast<int>(i), ObjectDetail::kFull});
+        }
+        stats.views++;
+        stats.objects += items.size();
+        stats.drawn += items.size();
+    }
+    if (Config::getParameters().occlusion_culling)
+    {
+        occlusion_culler_.cull(view, items, visible_items_, stats);
+    }
 
-    session_.drawAllObjects(get_color_);
+    for (const auto& visible: visible_items_)
+    {
+        if (visible.index == hovered_object)
+        {
+            ObjectDrawItem item = items[visible.index];
+            item.hovered = true;
+            Object::drawItem(item, view.getViewMatrix(), get_pick_color, visible.detail);
+            continue;
+        }
+        Object::drawItem(items[visible.index], view.getViewMatrix(), get_pick_color, visible.detail);
+    }
 }
 
-std::tuple<double, double> DrawingLib::calculateCoordinatesOnMouseMove() const
-/** Calculates the change in object coordinates of mouse cursor, converting screen space coordinates to
- normalized device coordinates (NDC) and then to frustum coordinates, with depth correction applied. */
+const std::vector<ObjectDrawItem>& DrawingLib::currentDrawItems_()
+/** Returns the draw items of the current structure of the scene. Without a SceneUpdater they are filled from Session.
+Otherwise the newest snapshot from the update thread is used; if Objects were added or removed after it was made,
+its buffers may be deleted, so a current snapshot is made here (Session's mutex is held, see renderScene). */
 {
-    // Convert the mouse movement (delta_x and delta_y) from screen space to normalized device coordinates (NDC)
-    // where the range is [-1, 1].
-    double ndc_delta_x = (current_pos_x_ - prev_pos_x_) / (window_width_ / 2.0f);
-    double ndc_delta_y = (current_pos_y_ - prev_pos_y_) / (window_height_ / 2.0f);
+    if (scene_updater_ != nullptr)
+    {
+        const RenderSnapshot& snapshot = scene_updater_->latestSnapshot();
+        if (snapshot.structure_version == session_.getStructureVersion())
+        {
+            return snapshot.items;
+        }
+    }
+    local_snapshot_.structure_version = session_.getStructureVersion();
+    session_.fillDrawItems(local_snapshot_.items);
+    return local_snapshot_.items;
+}
+
+void DrawingLib::updateHoverPick(double cursor_x, double cursor_y)
+/** Finds the Object under the cursor (window coordinates) in the view under it for highlighting, the result is
+available in the next frame (see HoverPicker). Must be called before the frame is cleared. */
+{
+    updateLayout_();
+    int view_index = getViewAt_(cursor_x, cursor_y);
+    if (view_index < 0)
+    {
+        hover_picker_.clear();
+        return;
+    }
 
-    // Compute the width and height of the frustum at the near plane
-    double frustum_width = right_ - left_;
-    double frustum_height = (top_ * dim_ratio_) - (bottom_ * dim_ratio_);
+    const RenderSnapshot* snapshot = &local_snapshot_;
+    if (scene_updater_ == nullptr)
+    {
+        local_snapshot_.structure_version = session_.getStructureVersion();
+        session_.fillDrawItems(local_snapshot_.items);
+    }
+    else
+    {
+        // A snapshot older than the structure of the scene is skipped, drawFrame makes a current one this frame.
+        snapshot = &scene_updater_->latestSnapshot();
+        if (snapshot->structure_version != session_.getStructureVersion())
+        {
+            return;
+        }
+    }
+    // The pixel is rendered with the view's matrices as if the view were the whole window, the back buffer is
+    // cleared afterwards anyway.
+    const SceneView& view = views_[view_index];
+    hover_picker_.update(session_, snapshot->items, snapshot->structure_version, view.getProjectionMatrix(),
+                         view.getViewMatrix(), view.getInverseViewProjection(), view.getWidth(), view.getHeight(),
+                         cursor_x - view.getX(), cursor_y - view.getY());
+}
+
+void DrawingLib::releaseBuffers()
+/** Deletes OpenGL objects owned by DrawingLib, before the OpenGL context is destroyed. */
+{
+    hover_picker_.releaseBuffers();
+    if (!occlusion_queries_.empty())
+    {
+        glDeleteQueries(static_cast<GLsizei>(occlusion_queries_.size()), occlusion_queries_.data());
+        occlusion_queries_.clear();
+    }
+}
+
+bool DrawingLib::isSnapshotCurrent_()
+/** Returns true if the newest snapshot of the update thread can be drawn (or there is no update thread). */
+{
+    return scene_updater_ == nullptr ||
+           scene_updater_->latestSnapshot().structure_version == session_.getStructureVersion();
+}
 
-    // Scale normalized deltas to match the frustum coordinates
-    double adjusted_delta_x = ndc_delta_x * frustum_width / 2.0f;
-    double adjusted_delta_y = ndc_delta_y * frustum_height / 2.0f;
+std::tuple<double, double> DrawingLib::calculateCoordinatesOnMouseMove(double delta_x, double delta_y) const
+/** Calculates the change in object coordinates for a movement of mouse cursor by (delta_x, delta_y) pixels in the
+active view. The window position of the scene origin and the same position moved by the cursor delta are un-projected
+at the depth of the origin. Objects move in their x-y plane, so in a turned view only the part of the movement
+along this plane applies. */
+{
+    const SceneView& view = views_[active_view_];
+    const math3d::Viewport viewport{0.0f, 0.0f, static_cast<float>(view.getWidth()), static_cast<float>(view.getHeight())};
+    const math3d::Vec3 origin = math3d::project({0.0f, 0.0f, 0.0f}, view.getProjectionMatrix() * view.getViewMatrix(),
+                                                viewport);
 
-    // Apply depth correction factor (assuming linear scaling for simplicity)
-    adjusted_delta_x *= depth_correction_factor_;
-    adjusted_delta_y *= depth_correction_factor_;
+    // Screen y-coordinates go top-to-bottom, window coordinates of OpenGL go bottom-to-top.
+    const math3d::Vec3 moved(origin.x + static_cast<float>(delta_x), origin.y - static_cast<float>(delta_y), origin.z);
+    const math3d::Vec3 delta = math3d::unproject(moved, view.getInverseViewProjection(), viewport) -
+                               math3d::unproject(origin, view.getInverseViewProjection(), viewport);
 
-    std::tuple<double, double> delta_coordinates = std::make_tuple(adjusted_delta_x, adjusted_delta_y);
+    // Object::updateObjectCoordinates expects delta_y in screen direction.
+    std::tuple<double, double> delta_coordinates = std::make_tuple(delta.x, -delta.y);
 
     return delta_coordinates;
 }
 
 void DrawingLib::drawFrameBox() const
-/** Draws a rectangular selection box on the screen. */
+/** Draws a rectangular selection box on the screen, it ends at the border of the active view. */
 {
+    double end_x, end_y;
+    std::tie(end_x, end_y) = clampToActiveView_(current_pos_x_, current_pos_y_);
+    glViewport(0, 0, (GLsizei)window_width_, (GLsizei)window_height_);
     glMatrixMode( GL_PROJECTION ); // switches the current matrix mode to the projection matrix.
-    glLoadIdentity();
 
     // Sets the projection matrix to orthographic mode aligned with the window dimensions.
-    glOrtho( 0, window_width_, window_height_, 0, -1, 1 );
+    glLoadMatrixf(frame_box_projection_.data());
 
     // After setting up the projection matrix, switchs to GL_MODELVIEW mode to handle model transformations.
     glMatrixMode( GL_MODELVIEW );
@@ -350,39 +807,209 @@ void DrawingLib::drawFrameBox() const
     // Draws a rectangle with the coordinates of the starting and current mouse positions.
     glBegin(GL_QUADS);
     glVertex2f(start_pos_x_,start_pos_y_);
-    glVertex2f(current_pos_x_,start_pos_y_);
-    glVertex2f(current_pos_x_,current_pos_y_);
-    glVertex2f(start_pos_x_,current_pos_y_);
+    glVertex2f(end_x,start_pos_y_);
+    glVertex2f(end_x,end_y);
+    glVertex2f(start_pos_x_,end_y);
     glEnd();
 }
 
-
-void DrawingLib::drawObjectsMetadata()
-/** Draws metadata for all objects in the scene. */
+void DrawingLib::drawViewBorders() const
+/** Draws grey lines between the views of the layout. */
 {
+    glViewport(0, 0, (GLsizei)window_width_, (GLsizei)window_height_);
     glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(frame_box_projection_.data());
+    glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
-    // Sets the projection matrix to orthographic mode based on the viewing boundaries scaled by
-    // a factor of depth correction factor that is used in drawing all Objects.
-    glOrtho(left_*depth_correction_factor_, right_*depth_correction_factor_,
-            bottom_ * dim_ratio_*depth_correction_factor_, top_ * dim_ratio_*depth_correction_factor_,
-            -1.0, 1.0);
+    // Lines are drawn over the Objects regardless of their depth.
+    glDisable(GL_DEPTH_TEST);
+    glColor3f(0.4f, 0.4f, 0.4f);
+    glBegin(GL_LINES);
+    for (int i = 0; i < view_count_; i++)
+    {
+        const auto x = static_cast<float>(views_[i].getX()) + 0.5f, y = static_cast<float>(views_[i].getY()) + 0.5f;
+        if (views_[i].getX() > 0)
+        {
+            glVertex2f(x, y);
+            glVertex2f(x, y + static_cast<float>(views_[i].getHeight()));
+        }
+        if (views_[i].getY() > 0)
+        {
+            glVertex2f(x, y);
+            glVertex2f(x + static_cast<float>(views_[i].getWidth()), y);
+        }
+    }
+    glEnd();
+    glEnable(GL_DEPTH_TEST);
+}
 
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
 
+void DrawingLib::drawObjectsMetadata()
+/** Draws metadata for all objects in the scene, in every view. */
+{
     // Sets the background color to black.
     glClearColor(0.0F, 0.0F, 0.0F, 1.0F);
     // Sets the alignment requirement to 1 byte for the start of each pixel row in memory.
     // By setting the alignment to 1, OpenGL is aware that pixel rows can start at any byte boundary.
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    glColor3f(1,1,1);  // Sets the colour to white.
-    session_.drawAllObjectsMetadata();
+    for (int i = 0; i < view_count_; i++)
+    {
+        const SceneView& view = views_[i];
+        const math3d::Viewport viewport = view.getGlViewport();
+        glViewport(static_cast<GLint>(viewport.x), static_cast<GLint>(viewport.y),
+                   static_cast<GLsizei>(viewport.width), static_cast<GLsizei>(viewport.height));
+
+        // Raster positions of the texts are transformed like vertices of the view, so a text is placed at its
+        // Object's position in the perspective view. The depth row of the projection is cleared: all texts stay in
+        // the middle of the depth range, in front of Objects around z = 0.
+        math3d::Mat4 projection = view.getProjectionMatrix();
+        for (int col = 0; col < 4; col++)
+        {
+            projection(2, col) = 0.0f;
+        }
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(projection.data());
+        glMatrixMode(GL_MODELVIEW);
+        glLoadMatrixf(view.getViewMatrix().data());
+
+        glColor3f(1,1,1);  // Sets the colour to white.
+        session_.drawAllObjectsMetadata();
+    }
 }
 
 
+int DrawingLib::readObjectIdAt(double x, double y) const
+/** Reads the colour of a single pixel at window coordinates (x, y) after a frame is drawn with pick colours and
+returns the index of the Object with this pick colour, or -1 if the pixel doesn't belong to any Object. */
+{
+    unsigned char color[3];
+    glReadPixels(x, window_height_ - y, 1, 1, GL_RGB, GL_UNSIGNED_BYTE, color);
+    return session_.getObjectIdByPickColor(color);
+}
+
+std::vector<int> DrawingLib::readObjectIdsInRect(int startX, int startY, int endX, int endY) const
+/** Reads all pixels inside a rectangle after a frame is drawn with pick colours and returns indices of all Objects
+that are visible inside it, every index once. */
+{
+    std::vector<int> object_ids;
+    auto colors = getColorsInSelection(startX, startY, endX, endY);
+
+    for (auto c : colors)
+    {
+        // same steps to identify selected Objects as when there is left-clicking on the Object
+        auto obj_id = session_.getObjectIdByPickColor(&c[0]);
+        if (obj_id >= 0 && std::find(object_ids.begin(), object_ids.end(), obj_id) == object_ids.end()) {
+            object_ids.push_back(obj_id);
+        }
+    }
+    return object_ids;
+}
+
+std::vector<int> DrawingLib::queryObjectIdsInRect(int startX, int startY, int endX, int endY)
+/** Returns indices of all Objects that are visible inside a rectangle, like readObjectIdsInRect, without reading
+pixels back. Must be called right after a frame is drawn, its depth buffer is used.
+Objects whose bounding box doesn't cover the rectangle on the screen are skipped. Every other Object is drawn again
+into the rectangle (scissor test) with colour and depth writes disabled, inside an occlusion query: its fragments pass
+the depth test (GL_LEQUAL) only where it is the nearest surface, i.e. where it is visible. */
+{
+    int min_x = std::min(startX, endX);
+    int max_x = std::max(startX, endX);
+    // Window y-coordinates go top-to-bottom, OpenGL ones bottom-to-top.
+    int min_y = window_height_ - std::max(startY, endY);
+    int max_y = window_height_ - std::min(startY, endY);
+    if (min_x == max_x || min_y == max_y)
+    {
+        return {};
+    }
+
+    // Candidates: Objects whose bounding box, projected on the screen of the active view, overlaps the rectangle.
+    const SceneView& view = views_[active_view_];
+    const math3d::Viewport viewport = view.getGlViewport();
+    const math3d::Mat4 view_projection = view.getProjectionMatrix() * view.getViewMatrix();
+    const auto& objects = session_.getObjects();
+    std::vector<int> candidates;
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        const auto& box = objects[i].getBoundingBox();
+        float screen_min_x = static_cast<float>(window_width_), screen_max_x = 0.0f;
+        float screen_min_y = static_cast<float>(window_height_), screen_max_y = 0.0f;
+        bool behind_camera = false;
+        for (int corner = 0; corner < 8; corner++)
+        {
+            math3d::Vec4 clip = view_projection.transform({(corner & 1) ? box.maxX : box.minX,
+                                                           (corner & 2) ? box.maxY : box.minY,
+                                                           (corner & 4) ? box.maxZ : box.minZ, 1.0f});
+            if (clip.w <= 0.0f)
+            {
+                behind_camera = true;
+                break;
+            }
+            float x = viewport.x + (clip.x / clip.w * 0.5f + 0.5f) * viewport.width;
+            float y = viewport.y + (clip.y / clip.w * 0.5f + 0.5f) * viewport.height;
+            screen_min_x = std::min(screen_min_x, x);
+            screen_max_x = std::max(screen_max_x, x);
+            screen_min_y = std::min(screen_min_y, y);
+            screen_max_y = std::max(screen_max_y, y);
+        }
+        if (behind_camera || (screen_max_x >= min_x && screen_min_x <= max_x &&
+                              screen_max_y >= min_y && screen_min_y <= max_y))
+        {
+            candidates.push_back(static_cast<int>(i));
+        }
+    }
+    if (candidates.empty())
+    {
+        return {};
+    }
+
+    // GL_ANY_SAMPLES_PASSED lets the driver stop counting at the first sample, GL_SAMPLES_PASSED is the fallback
+    // for contexts older than OpenGL 3.3.
+    const GLenum query_target = (GLEW_VERSION_3_3 || GLEW_ARB_occlusion_query2) ? GL_ANY_SAMPLES_PASSED
+                                                                                : GL_SAMPLES_PASSED;
+    if (occlusion_queries_.size() < candidates.size())
+    {
+        size_t old_size = occlusion_queries_.size();
+        occlusion_queries_.resize(candidates.size());
+        glGenQueries(static_cast<GLsizei>(candidates.size() - old_size), occlusion_queries_.data() + old_size);
+    }
+
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(min_x, min_y, max_x - min_x, max_y - min_y);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(view.getProjectionMatrix().data());
+    glMatrixMode(GL_MODELVIEW);
+
+    ObjectDrawItem item{};
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        objects[candidates[i]].fillDrawItem(item);
+        glBeginQuery(query_target, occlusion_queries_[i]);
+        Object::drawItem(item, view.getViewMatrix(), true);
+        glEndQuery(query_target);
+    }
+
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDisable(GL_SCISSOR_TEST);
+
+    // All queries are issued before the first result is read, so the GPU works through them without stalls.
+    std::vector<int> object_ids;
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        GLuint samples_passed = 0;
+        glGetQueryObjectuiv(occlusion_queries_[i], GL_QUERY_RESULT, &samples_passed);
+        if (samples_passed != 0)
+        {
+            object_ids.push_back(candidates[i]);
+        }
+    }
+    return object_ids;
+}
+
 std::set<std::array<unsigned char, 3>> DrawingLib::getColorsInSelection(int startX, int startY, int endX, int endY) const
 /** Identifies and returns unique colors within a specified rectangular area of the screen. */
 {
@@ -0,0 +1,447 @@
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#ifdef PROJECT_1_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#include "../include/frame_capture.h"
+#include "../include/frame_scheduler.h"
+#include "../include/trace.h"
+
+
+namespace
+{
+// How long stop waits for a frame that the GPU is still reading.
+constexpr GLuint64 kStopTimeoutNanoseconds = 1000000000;
+
+#ifdef PROJECT_1_WITH_ZLIB
+void writeBigEndian(std::ofstream& file, uint32_t value)
+{
+    const unsigned char bytes[4] = {static_cast<unsigned char>(value >> 24), static_cast<unsigned char>(value >> 16),
+                                    static_cast<unsigned char>(value >> 8), static_cast<unsigned char>(value)};
+    file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+void writePngChunk(std::ofstream& file, const char type[4], const unsigned char* data, size_t size)
+/* Length, type, data and CRC of the type and data. */
+{
+    writeBigEndian(file, static_cast<uint32_t>(size));
+    file.write(type, 4);
+    file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    uLong crc = crc32(0, reinterpret_cast<const Bytef*>(type), 4);
+    if (size > 0)
+    {
+        crc = crc32(crc, data, static_cast<uInt>(size));
+    }
+    writeBigEndian(file, static_cast<uint32_t>(crc));
+}
+#endif
+}
+
+
+FrameCapture::~FrameCapture()
+/** Only stops the encoder thread; OpenGL buffers must be released with stop while the context exists. */
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_up_.notify_one();
+    if (encoder_.joinable())
+    {
+        encoder_.join();
+    }
+}
+
+bool FrameCapture::isPngAvailable()
+/** Returns true if the application is built with zlib and frames can be written as PNG. */
+{
+#ifdef PROJECT_1_WITH_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FrameCapture::start(const std::string& path, CaptureFormat format)
+/** Starts capturing every drawn frame. path is the beginning of the names of written files (see CaptureFormat).
+Throws std::runtime_error if PNG is requested without zlib. */
+{
+    stop();
+    if (format == CaptureFormat::kPng && !isPngAvailable())
+    {
+        throw std::runtime_error("PNG capture needs zlib, the application is built without it.");
+    }
+
+    path_ = path;
+    format_ = format;
+    frame_number_ = 0;
+    next_buffer_ = 0;
+    overhead_ms_.clear();
+    raw_width_ = raw_height_ = 0;
+    written_count_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_ = FrameCaptureStats();
+        last_error_.clear();
+        mapped_buffers_.clear();
+        stopping_ = false;
+    }
+    encoder_ = std::thread(&FrameCapture::runEncoder_, this);
+    running_ = true;
+}
+
+void FrameCapture::stop()
+/** Waits until frames in flight are read and written, stops the encoder thread and deletes the pixel buffers. */
+{
+    if (!running_)
+    {
+        return;
+    }
+    collectBuffers_(true);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_up_.notify_one();
+    encoder_.join();
+    releaseBuffers_();
+    running_ = false;
+}
+
+void FrameCapture::captureFrame(int width, int height)
+/** Queues reading of the drawn frame (the back buffer, before it's swapped) into a free pixel buffer and hands
+buffers read by the GPU to the encoder. Never waits: without a free pixel buffer the frame is dropped. */
+{
+    if (!running_)
+    {
+        return;
+    }
+    PROJECT_1_TRACE_ZONE("FrameCapture::captureFrame");
+    auto start_time = std::chrono::steady_clock::now();
+    frame_number_++;
+    // Frames are drawn continuously while capturing, so the recording has the frame rate of the display and buffers
+    // in flight are collected.
+    FrameScheduler::requestRedraw();
+
+    collectBuffers_(false);
+
+    // Buffers are used in a ring, the next one is the oldest.
+    auto& buffer = buffers_[next_buffer_];
+    bool buffer_free;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.frames++;
+        buffer_free = buffer.state == BufferState::kFree;
+        if (buffer.state == BufferState::kReading)
+        {
+            stats_.dropped_gpu_busy++;
+        }
+        else if (!buffer_free)
+        {
+            stats_.dropped_encoder_busy++;
+        }
+    }
+    if (buffer_free)
+    {
+        issue_(buffer, width, height);
+        next_buffer_ = (next_buffer_ + 1) % kBufferCount;
+    }
+    overhead_ms_.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+}
+
+void FrameCapture::collectBuffers_(bool wait)
+/** Unmaps buffers the encoder has copied, and maps buffers whose reading is finished and queues them for the encoder,
+the oldest first, so frames are written in order. With wait, it waits for the GPU (when capturing stops). */
+{
+    for (int i = 0; i < kBufferCount; i++)
+    {
+        int index = (next_buffer_ + i) % kBufferCount;
+        auto& buffer = buffers_[index];
+        BufferState state;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            state = buffer.state;
+        }
+
+        if (state == BufferState::kReleased)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.buffer);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            buffer.pixels = nullptr;
+            std::lock_guard<std::mutex> lock(mutex_);
+            buffer.state = BufferState::kFree;
+        }
+        else if (state == BufferState::kReading)
+        {
+            bool ready;
+            if (buffer.fence != nullptr)
+            {
+                GLenum status = glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                                 wait ? kStopTimeoutNanoseconds : 0);
+                ready = status != GL_TIMEOUT_EXPIRED;
+                if (ready)
+                {
+                    glDeleteSync(buffer.fence);
+                    buffer.fence = nullptr;
+                }
+            }
+            else
+            {
+                // Without sync objects a buffer is mapped when the ring comes round to it, which may wait for the GPU.
+                ready = wait || frame_number_ - buffer.frame_number >= kBufferCount - 1;
+            }
+            if (!ready)
+            {
+                // Reading finishes in order, newer buffers aren't ready either.
+                break;
+            }
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.buffer);
+            buffer.pixels = static_cast<const unsigned char*>(glMapBufferRange(
+                    GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(buffer.width) * buffer.height * 4, GL_MAP_READ_BIT));
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (buffer.pixels == nullptr)
+            {
+                buffer.state = BufferState::kFree;
+                stats_.write_errors++;
+                last_error_ = "Failed to map a pixel buffer of the captured frame.";
+                continue;
+            }
+            buffer.state = BufferState::kMapped;
+            mapped_buffers_.push_back(index);
+            wake_up_.notify_one();
+        }
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void FrameCapture::issue_(PixelBuffer& buffer, int width, int height)
+/** Starts copying the back buffer into the pixel buffer; glReadPixels only queues the copy. */
+{
+    size_t size = static_cast<size_t>(width) * height * 4;
+    if (buffer.buffer == 0)
+    {
+        glGenBuffers(1, &buffer.buffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.buffer);
+    if (buffer.capacity < size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+        buffer.capacity = size;
+    }
+    // RGBA rows are always aligned to 4 bytes, so the default pack alignment fits.
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (GLEW_ARB_sync)
+    {
+        buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    buffer.width = width;
+    buffer.height = height;
+    buffer.frame_number = frame_number_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer.state = BufferState::kReading;
+}
+
+void FrameCapture::releaseBuffers_()
+{
+    for (auto& buffer: buffers_)
+    {
+        if (buffer.fence != nullptr)
+        {
+            glDeleteSync(buffer.fence);
+        }
+        if (buffer.pixels != nullptr)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.buffer);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        if (buffer.buffer != 0)
+        {
+            glDeleteBuffers(1, &buffer.buffer);
+        }
+        buffer = PixelBuffer();
+    }
+}
+
+FrameCaptureStats FrameCapture::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::string FrameCapture::getLastError() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
+
+void FrameCapture::runEncoder_()
+/** Loop of the encoder thread. Mapped buffers are copied out first (flipped to top-to-bottom rows, without alpha), so
+the render thread can reuse them soon; copied frames are written while no buffer waits or enough frames are queued. */
+{
+    Trace::setThreadName("frame capture");
+    std::deque<EncodedFrame> frames;
+    std::vector<unsigned char> spare_pixels;
+    while (true)
+    {
+        int index = -1;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_up_.wait(lock, [this, &frames] {return stopping_ || !mapped_buffers_.empty() || !frames.empty();});
+            if (!mapped_buffers_.empty() && frames.size() < kMaxEncoderFrames)
+            {
+                index = mapped_buffers_.front();
+                mapped_buffers_.pop_front();
+            }
+            else if (frames.empty())
+            {
+                // Stopping, and everything is written.
+                break;
+            }
+        }
+
+        if (index < 0)
+        {
+            writeFrame_(frames.front());
+            spare_pixels = std::move(frames.front().rgb);
+            frames.pop_front();
+            continue;
+        }
+
+        PROJECT_1_TRACE_ZONE("FrameCapture::copyFrame");
+        const auto& buffer = buffers_[index];
+        EncodedFrame frame{std::move(spare_pixels), buffer.width, buffer.height};
+        frame.rgb.resize(static_cast<size_t>(buffer.width) * buffer.height * 3);
+        // OpenGL rows go bottom-to-top, images top-to-bottom.
+        for (int y = 0; y < buffer.height; y++)
+        {
+            const unsigned char* source = buffer.pixels + static_cast<size_t>(buffer.height - 1 - y) * buffer.width * 4;
+            unsigned char* destination = frame.rgb.data() + static_cast<size_t>(y) * buffer.width * 3;
+            for (int x = 0; x < buffer.width; x++)
+            {
+                destination[3 * x] = source[4 * x];
+                destination[3 * x + 1] = source[4 * x + 1];
+                destination[3 * x + 2] = source[4 * x + 2];
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            buffers_[index].state = BufferState::kReleased;
+        }
+        frames.push_back(std::move(frame));
+    }
+    raw_file_.close();
+}
+
+void FrameCapture::writeFrame_(const EncodedFrame& frame)
+{
+    PROJECT_1_TRACE_ZONE("FrameCapture::writeFrame");
+    if (format_ == CaptureFormat::kRawVideo && raw_width_ != 0 &&
+        (frame.width != raw_width_ || frame.height != raw_height_))
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.dropped_size_changed++;
+        return;
+    }
+
+    try
+    {
+        if (format_ == CaptureFormat::kPng)
+        {
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), "_%06llu.png", static_cast<unsigned long long>(written_count_ + 1));
+            writePng_(frame, path_ + suffix);
+        }
+        else
+        {
+            writeRaw_(frame);
+        }
+        written_count_++;
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.frames_written++;
+    }
+    catch (const std::exception& error)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.write_errors++;
+        last_error_ = error.what();
+    }
+}
+
+void FrameCapture::writePng_(const EncodedFrame& frame, const std::string& file_path)
+/** Writes an 8-bit RGB PNG. Rows use the Sub filter (difference to the pixel on the left), which compresses flat
+areas of a rendered frame well, and are deflated at the fastest level to keep up with the frame rate. */
+{
+#ifdef PROJECT_1_WITH_ZLIB
+    const size_t row_size = static_cast<size_t>(frame.width) * 3;
+    std::vector<unsigned char> filtered((row_size + 1) * frame.height);
+    for (int y = 0; y < frame.height; y++)
+    {
+        const unsigned char* row = frame.rgb.data() + y * row_size;
+        unsigned char* output = filtered.data() + y * (row_size + 1);
+        output[0] = 1;
+        for (size_t i = 0; i < row_size; i++)
+        {
+            output[i + 1] = static_cast<unsigned char>(row[i] - (i >= 3 ? row[i - 3] : 0));
+        }
+    }
+    uLongf compressed_size = compressBound(static_cast<uLong>(filtered.size()));
+    std::vector<unsigned char> compressed(compressed_size);
+    if (compress2(compressed.data(), &compressed_size, filtered.data(), static_cast<uLong>(filtered.size()),
+                  Z_BEST_SPEED) != Z_OK)
+    {
+        throw std::runtime_error("Failed to compress a captured frame.");
+    }
+
+    std::ofstream file(file_path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open capture file: " + file_path);
+    }
+    const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+    // Width, height, bit depth 8, colour type 2 (RGB), default compression, filtering and no interlace.
+    unsigned char header[13] = {0, 0, 0, 0, 0, 0, 0, 0, 8, 2, 0, 0, 0};
+    for (int i = 0; i < 4; i++)
+    {
+        header[i] = static_cast<unsigned char>(static_cast<uint32_t>(frame.width) >> (24 - 8 * i));
+        header[4 + i] = static_cast<unsigned char>(static_cast<uint32_t>(frame.height) >> (24 - 8 * i));
+    }
+    writePngChunk(file, "IHDR", header, sizeof(header));
+    writePngChunk(file, "IDAT", compressed.data(), compressed_size);
+    writePngChunk(file, "IEND", nullptr, 0);
+    if (!file.good())
+    {
+        throw std::runtime_error("Failed to write capture file: " + file_path);
+    }
+#else
+    throw std::runtime_error("PNG capture needs zlib, the application is built without it.");
+#endif
+}
+
+void FrameCapture::writeRaw_(const EncodedFrame& frame)
+/** Appends the frame to the raw video file, which is created with the size of the first frame in its name, e.g.
+ffmpeg -f rawvideo -pixel_format rgb24 -video_size 1920x1080 -i capture_1920x1080.rgb capture.mp4 */
+{
+    if (!raw_file_.is_open())
+    {
+        std::string file_path = path_ + "_" + std::to_string(frame.width) + "x" + std::to_string(frame.height) + ".rgb";
+        raw_file_.open(file_path, std::ios::binary | std::ios::trunc);
+        if (!raw_file_)
+        {
+            throw std::runtime_error("Failed to open capture file: " + file_path);
+        }
+        raw_width_ = frame.width;
+        raw_height_ = frame.height;
+    }
+    raw_file_.write(reinterpret_cast<const char*>(frame.rgb.data()), static_cast<std::streamsize>(frame.rgb.size()));
+    if (!raw_file_.good())
+    {
+        throw std::runtime_error("Failed to write raw video of the captured frames.");
+    }
+}
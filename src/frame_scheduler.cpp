@@ -0,0 +1,11 @@
+#include "../include/frame_scheduler.h"
+
+
+std::atomic<int> FrameScheduler::pending_frames_{FrameScheduler::kFramesAfterChange};
+
+void FrameScheduler::frameDrawn()
+/** Counts down frames that are left to draw after the last change. */
+{
+    int pending = pending_frames_.load();
+    while (pending > 0 && !pending_frames_.compare_exchange_weak(pending, pending - 1)) {}
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#include "../include/frame_stats.h"
+
+
+void FrameStats::add(double sample)
+/** Adds a sample. When the buffer is full, the oldest sample is replaced. */
+{
+    if (samples_.size() < capacity_)
+    {
+        samples_.push_back(sample);
+    }
+    else
+    {
+        samples_[next_] = sample;
+    }
+    next_ = (next_ + 1) % capacity_;
+}
+
+void FrameStats::clear()
+/** Removes all samples. */
+{
+    samples_.clear();
+    next_ = 0;
+}
+
+double FrameStats::mean() const
+/** Returns the mean of all samples or 0 if there are no samples. */
+{
+    if (samples_.empty())
+    {
+        return 0;
+    }
+    double sum = 0;
+    for (auto sample: samples_)
+    {
+        sum += sample;
+    }
+    return sum / static_cast<double>(samples_.size());
+}
+
+double FrameStats::min() const
+/** Returns the smallest sample or 0 if there are no samples. */
+{
+    return samples_.empty() ? 0 : *std::min_element(samples_.begin(), samples_.end());
+}
+
+double FrameStats::max() const
+/** Returns the largest sample or 0 if there are no samples. */
+{
+    return samples_.empty() ? 0 : *std::max_element(samples_.begin(), samples_.end());
+}
+
+double FrameStats::percentile(double fraction) const
+/** Returns the sample below which the given fraction (0..1) of samples falls, e.g. 0.99 for p99.
+Uses the nearest-rank method on a copy of the samples. */
+{
+    if (samples_.empty())
+    {
+        return 0;
+    }
+    std::vector<double> sorted(samples_);
+    auto rank = static_cast<size_t>(std::max(0.0, std::min(1.0, fraction)) * static_cast<double>(sorted.size() - 1) + 0.5);
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<long>(rank), sorted.end());
+    return sorted[rank];
+}
+
+std::vector<float> FrameStats::orderedSamples() const
+/** Returns samples in the order they were added. */
+{
+    std::vector<float> ordered;
+    ordered.reserve(samples_.size());
+    size_t start = samples_.size() < capacity_ ? 0 : next_;
+    for (size_t i = 0; i < samples_.size(); i++)
+    {
+        ordered.push_back(static_cast<float>(samples_[(start + i) % samples_.size()]));
+    }
+    return ordered;
+}
+
+CpuUsage::CpuUsage(double interval_seconds)
+        : interval_seconds_(interval_seconds),
+          last_cpu_time_(std::clock()),
+          last_wall_time_(std::chrono::steady_clock::now())
+{
+}
+
+void CpuUsage::update()
+/** Recalculates CPU usage and frame rate when the current interval is over. */
+{
+    auto wall_time = std::chrono::steady_clock::now();
+    double wall_seconds = std::chrono::duration<double>(wall_time - last_wall_time_).count();
+    if (wall_seconds < interval_seconds_)
+    {
+        return;
+    }
+    std::clock_t cpu_time = std::clock();
+    double cpu_seconds = static_cast<double>(cpu_time - last_cpu_time_) / CLOCKS_PER_SEC;
+
+    percent_ = 100.0 * cpu_seconds / wall_seconds;
+    frames_per_second_ = frames_ / wall_seconds;
+
+    last_cpu_time_ = cpu_time;
+    last_wall_time_ = wall_time;
+    frames_ = 0;
+}
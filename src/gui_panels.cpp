@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include "imgui.h"
@@ -6,11 +9,20 @@
 
 #include "../include/gui_panels.h"
 #include "../include/config.h"
+#include "../include/scene_file.h"
+#include "../include/mesh_importer.h"
+#include "../include/mesh_registry.h"
+#include "../include/mesh_buffer_cache.h"
+#include "../include/trace.h"
+#include "../include/frame_scheduler.h"
 
 
 void GuiPanels::drawMainPanel()
 /** Draws the main panel that includes following tabs: Objects, Settings, Logger, Help. */
 {
+    cpu_usage_.update();
+    handleUndoShortcuts();
+
     ImGui::SetNextWindowSizeConstraints(ImVec2(400, 200), ImVec2(800, 600));
     ImGui::Begin("Main panel");
 
@@ -25,6 +37,33 @@ void GuiPanels::drawMainPanel()
     }
 
     ImGui::End();
+
+    // While a widget is in use (e.g. a slider is held or a text field is focused), its value can change without
+    // new input events, so the frame is kept up to date.
+    if (ImGui::IsAnyItemActive())
+    {
+        FrameScheduler::requestRedraw();
+    }
+}
+
+void GuiPanels::addFrameTime(double milliseconds)
+/** Adds the time spent to build and draw one frame to the frame time graph in Settings. */
+{
+    frame_time_stats_.add(milliseconds);
+    cpu_usage_.countFrame();
+
+    // A running flythrough draws frames continuously, even if rendering only on changes is enabled.
+    if (flythrough_.isRunning())
+    {
+        if (flythrough_.addFrameTime(milliseconds))
+        {
+            Logger::addMessage(LogLevel::Info, flythrough_.summary().c_str());
+        }
+        else
+        {
+            FrameScheduler::requestRedraw();
+        }
+    }
 }
 
 void GuiPanels::drawObjectsTab()
@@ -33,6 +72,10 @@ void GuiPanels::drawObjectsTab()
     if (ImGui::BeginTabItem("Objects"))
     {
         drawCreateObjects();
+        drawCreatePrimitives();
+        drawImportMesh();
+        ImGui::Spacing();
+        drawSceneFileControls();
         ImGui::Spacing();
         ImGui::Spacing();
 
@@ -43,6 +86,14 @@ void GuiPanels::drawObjectsTab()
         if (ImGui::Button("De-select all")){
             session_.deSelectAllObjects();
         }
+        ImGui::SameLine();
+        if (ImGui::Button("Invert selection")){
+            session_.invertSelection();
+        }
+        ImGui::SameLine();
+        ImGui::Text("%zu selected", session_.getSelection().count());
+        ImGui::Spacing();
+        drawUndoRedo();
         ImGui::Spacing();
         ImGui::Spacing();
 
@@ -52,25 +103,80 @@ void GuiPanels::drawObjectsTab()
     }
 }
 
+void GuiPanels::drawUndoRedo()
+/** Draws Undo and Redo buttons with the number of entries in each direction and handles keyboard shortcuts:
+Ctrl+Z - undo, Ctrl+Y or Ctrl+Shift+Z - redo. */
+{
+    auto& history = session_.getHistory();
+
+    std::string undo_name = "Undo (" + std::to_string(history.getUndoCount()) + ")";
+    if (ImGui::Button(undo_name.c_str()))
+    {
+        session_.undo();
+    }
+    ImGui::SameLine();
+    std::string redo_name = "Redo (" + std::to_string(history.getRedoCount()) + ")";
+    if (ImGui::Button(redo_name.c_str()))
+    {
+        session_.redo();
+    }
+}
+
+void GuiPanels::handleUndoShortcuts()
+/** Ctrl+Z undoes the last change, Ctrl+Y or Ctrl+Shift+Z redoes it. Shortcuts are ignored while a text field is
+edited (it has its own undo) and while a mouse button is held, because a drag refers to Objects by index. */
+{
+    const auto& io = ImGui::GetIO();
+    if (!io.KeyCtrl || io.WantTextInput || ImGui::IsAnyMouseDown())
+    {
+        return;
+    }
+    if (ImGui::IsKeyPressed(ImGuiKey_Z) && !io.KeyShift)
+    {
+        session_.undo();
+    }
+    else if (ImGui::IsKeyPressed(ImGuiKey_Y) || ImGui::IsKeyPressed(ImGuiKey_Z))
+    {
+        session_.redo();
+    }
+}
+
 void GuiPanels::drawCreateObjects()
-/** Draws a combo to select an object type (Cube, Icosahedron, Sphere, Pyramid) from a hard-coded list and a button
-to add a new object to the session. Also, it adds an info message to logger with id and type of new object. */
+/** Draws a combo to select an object type (Cube, Icosahedron, Sphere, Pyramid from a hard-coded list and
+imported meshes from MeshRegistry) and a button to add a new object to the session. Also, it adds an info
+message to logger with id and type of new object. */
 {
     if (ImGui::Button("+"))
     {
         auto it = object_types_.find(current_obj_type_);
-        auto selected_type = it->second;
-        session_.add_object(selected_type);
+        if (it != object_types_.end())
+        {
+            session_.add_object(it->second);
+        }
+        else if (MeshRegistry::findByName(current_obj_type_) >= 0)
+        {
+            session_.add_object(static_cast<ObjectType>(MeshRegistry::findByName(current_obj_type_)));
+        }
     }
     ImGui::SameLine();
 
     if (ImGui::BeginCombo("object type", current_obj_type_.c_str(), ImGuiComboFlags_None))
     {
+        std::vector<std::string> type_names;
         for (const auto& obj_type: object_types_)
         {
-            bool is_selected = (obj_type.first == current_obj_type_);
-            if (ImGui::Selectable(obj_type.first.c_str(), is_selected))
-                current_obj_type_ = obj_type.first;
+            type_names.push_back(obj_type.first);
+        }
+        for (size_t i = 0; i < MeshRegistry::size(); i++)
+        {
+            type_names.push_back(MeshRegistry::getName(static_cast<ObjectType>(kBuiltinObjectTypeCount + i)));
+        }
+
+        for (const auto& type_name: type_names)
+        {
+            bool is_selected = (type_name == current_obj_type_);
+            if (ImGui::Selectable(type_name.c_str(), is_selected))
+                current_obj_type_ = type_name;
             if (is_selected)
                 ImGui::SetItemDefaultFocus();
         }
@@ -78,6 +184,174 @@ to add a new object to the session. Also, it adds an info message to logger with
     }
 }
 
+void GuiPanels::drawCreatePrimitives()
+/** Draws controls to generate a parametric primitive (UV/ico sphere, torus, cylinder, cone, box) and to add several
+objects of it at once. Only sliders of the parameters that the selected kind uses are shown. Below, statistics of the
+primitive cache and of shared GPU mesh buffers are shown. */
+{
+    if (!ImGui::TreeNode("Primitives"))
+    {
+        return;
+    }
+
+    auto& parameters = primitive_parameters_;
+    if (ImGui::BeginCombo("kind", PrimitiveGenerator::getKindName(parameters.kind), ImGuiComboFlags_None))
+    {
+        for (int i = 0; i < kPrimitiveKindCount; i++)
+        {
+            auto kind = static_cast<PrimitiveKind>(i);
+            bool is_selected = (kind == parameters.kind);
+            if (ImGui::Selectable(PrimitiveGenerator::getKindName(kind), is_selected))
+                parameters.kind = kind;
+            if (is_selected)
+                ImGui::SetItemDefaultFocus();
+        }
+        ImGui::EndCombo();
+    }
+
+    ImGui::SliderFloat("radius", &parameters.radius, 0.05f, 2.0f, "%.2f");
+    switch (parameters.kind)
+    {
+        case PrimitiveKind::kUvSphere:
+            ImGui::SliderInt("segments", &parameters.segments, 3, 128);
+            ImGui::SliderInt("rings", &parameters.rings, 2, 128);
+            break;
+        case PrimitiveKind::kIcoSphere:
+            ImGui::SliderInt("subdivisions", &parameters.subdivisions, 0, 5);
+            break;
+        case PrimitiveKind::kTorus:
+            ImGui::SliderFloat("tube radius", &parameters.minor_radius, 0.01f, parameters.radius, "%.2f");
+            ImGui::SliderInt("segments", &parameters.segments, 3, 128);
+            ImGui::SliderInt("rings", &parameters.rings, 3, 128);
+            break;
+        case PrimitiveKind::kCylinder:
+        case PrimitiveKind::kCone:
+            ImGui::SliderFloat("height", &parameters.height, 0.05f, 4.0f, "%.2f");
+            ImGui::SliderInt("segments", &parameters.segments, 3, 128);
+            break;
+        case PrimitiveKind::kBox:
+            ImGui::SliderFloat("height", &parameters.height, 0.05f, 4.0f, "%.2f");
+            ImGui::SliderInt("subdivisions", &parameters.subdivisions, 1, 32);
+            break;
+    }
+    ImGui::SliderInt("count", &primitive_count_, 1, 1000);
+
+    if (ImGui::Button("Add primitive"))
+    {
+        session_.addObjects(PrimitiveGenerator::getObjectType(parameters), primitive_count_);
+    }
+
+    const auto cache_stats = PrimitiveGenerator::getStats();
+    unsigned long long requests = cache_stats.hits + cache_stats.misses;
+    ImGui::Text("Primitive cache: %zu meshes, %.1f KB, %llu hits / %llu misses (%.0f%%)",
+                cache_stats.mesh_count, cache_stats.byte_size / 1024.0, cache_stats.hits, cache_stats.misses,
+                requests > 0 ? 100.0 * cache_stats.hits / requests : 0.0);
+    const auto buffer_stats = MeshBufferCache::getStats();
+    ImGui::Text("GPU meshes: %zu shared by %zu objects, %.1f KB (float %.1f KB), %zu uploads",
+                buffer_stats.mesh_count, buffer_stats.object_count, buffer_stats.byte_size / 1024.0,
+                buffer_stats.float_byte_size / 1024.0, buffer_stats.upload_count);
+    // Removed meshes leave free blocks in the shared buffers until they are compacted.
+    ImGui::Text("Mesh buffers: %.1f KB, %.1f KB free in %zu blocks (largest %.1f KB)",
+                buffer_stats.buffer_capacity / 1024.0, buffer_stats.free_bytes / 1024.0,
+                buffer_stats.free_block_count, buffer_stats.largest_free_block / 1024.0);
+    ImGui::SameLine();
+    if (ImGui::Button("Compact"))
+    {
+        session_.compactMeshBuffers();
+    }
+    // 16-bit positions and indices; all meshes are uploaded again when it is switched.
+    bool compact_vertices = MeshBufferCache::getVertexFormat() == VertexFormat::kCompact;
+    if (ImGui::Checkbox("Compact vertex format", &compact_vertices))
+    {
+        session_.setVertexFormat(compact_vertices ? VertexFormat::kCompact : VertexFormat::kFloat);
+    }
+
+    ImGui::TreePop();
+}
+
+void GuiPanels::drawImportMesh()
+/** Draws a text field with a path to an OBJ, PLY or STL file and a button to import the mesh as a new object type.
+The imported type is selected in the object type combo, parse throughput is added to logger. */
+{
+    ImGui::InputText("mesh file", mesh_file_path_, sizeof(mesh_file_path_));
+    ImGui::SameLine();
+    if (ImGui::Button("Import"))
+    {
+        try
+        {
+            MeshImporter importer;
+            auto mesh = importer.importFile(mesh_file_path_);
+            const auto& stats = importer.getStats();
+
+            // The file name without directory and extension becomes the name of the object type.
+            std::string type_name = mesh_file_path_;
+            type_name = type_name.substr(type_name.find_last_of('/') + 1);
+            type_name = type_name.substr(0, type_name.find_last_of('.'));
+            while (object_types_.count(type_name) > 0 || MeshRegistry::findByName(type_name) >= 0)
+            {
+                type_name += "_";
+            }
+            MeshRegistry::registerMesh(type_name, std::move(mesh));
+            current_obj_type_ = type_name;
+
+            char logger_message[256];
+            snprintf(logger_message, sizeof(logger_message),
+                     "Mesh %s is imported: %zu triangles, %zu of %zu vertices after welding, parsed at %.1f MB/s "
+                     "(%u threads), welded in %.1f ms.",
+                     type_name.c_str(), stats.triangle_count, stats.welded_vertex_count, stats.parsed_vertex_count,
+                     stats.parseMegabytesPerSecond(), stats.thread_count, stats.weld_seconds * 1000);
+            Logger::addMessage(LogLevel::Info, logger_message);
+        }
+        catch (const std::exception& error)
+        {
+            Logger::addMessage(LogLevel::Error, error.what());
+        }
+    }
+}
+
+void GuiPanels::drawSceneFileControls()
+/** Draws a text field with a path to a scene file and buttons to save the current session into it or to replace
+the session with objects from it. Results and errors are added to logger. */
+{
+    ImGui::InputText("scene file", scene_file_path_, sizeof(scene_file_path_));
+
+    if (ImGui::Button("Save scene"))
+    {
+        try
+        {
+            auto stats = SceneFile::save(session_, scene_file_path_, compress_scene_meshes_);
+            std::string logger_message = "Scene with " + std::to_string(stats.object_count) + " objects is saved to " +
+                                         scene_file_path_ + " (" + std::to_string(stats.file_size / 1024) + " KB).";
+            Logger::addMessage(LogLevel::Info, logger_message.c_str());
+        }
+        catch (const std::exception& error)
+        {
+            Logger::addMessage(LogLevel::Error, error.what());
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Load scene"))
+    {
+        try
+        {
+            auto stats = SceneFile::load(session_, scene_file_path_);
+            std::string logger_message = "Scene with " + std::to_string(stats.object_count) + " objects is loaded from " +
+                                         scene_file_path_ + ": file read in " + std::to_string(stats.read_seconds * 1000) +
+                                         " ms, objects created in " + std::to_string(stats.total_seconds * 1000) + " ms.";
+            Logger::addMessage(LogLevel::Info, logger_message.c_str());
+        }
+        catch (const std::exception& error)
+        {
+            Logger::addMessage(LogLevel::Error, error.what());
+        }
+    }
+    if (SceneFile::isCompressionAvailable())
+    {
+        ImGui::SameLine();
+        ImGui::Checkbox("Compress meshes", &compress_scene_meshes_);
+    }
+}
+
 void GuiPanels::drawObjectsList()
 /** Iterates through the vector of objects in the session and draws a collapsing header with individual settings
 per object. */
@@ -105,13 +379,13 @@ void GuiPanels::drawObjectItemInList(Object& object, int object_id)
 
         auto col = object.getObjectColor();
         std::string edit_col_name = "##fill color_" + object.ObjectIdToString();
-        if (ImGui::ColorEdit3(edit_col_name.c_str(), col)){
-            object.updateObjectColor();
-        }
+        // The colour is read when the Object is drawn next, no buffer has to change.
+        ImGui::ColorEdit3(edit_col_name.c_str(), col);
+        recordColorEdit(object_id);
 
         std::string button_name = "Reset##"+ object.ObjectIdToString();
         if (ImGui::Button(button_name.c_str())){
-            object.resetObjectVertices();
+            session_.resetObjectTransform(object_id);
         }
         if (ImGui::IsItemHovered()){
             ImGui::SetTooltip("Reset all changes to object size/position.");
@@ -119,7 +393,11 @@ void GuiPanels::drawObjectItemInList(Object& object, int object_id)
 
         ImGui::SameLine();
         std::string checkbox_name = "Select##"+ object.ObjectIdToString();
-        ImGui::Checkbox(checkbox_name.c_str(), &object.getSelected());
+        bool selected = session_.isSelected(object_id);
+        if (ImGui::Checkbox(checkbox_name.c_str(), &selected))
+        {
+            session_.setSelected(object_id, selected);
+        }
     }
     if (!show_object)
     {
@@ -147,11 +425,307 @@ void GuiPanels::drawSettingsTab()
 
         ImGui::Text("Rotation sensitivity:");
         ImGui::SliderFloat("##rotation_sensitivity", &Config::getParameters().rotation_sensitivity, 0.1f, 2.0f, "ratio = %.1f");
+        ImGui::Spacing();
+
+        ImGui::Checkbox("Render only on changes", &Config::getParameters().render_on_demand);
+        ImGui::Spacing();
+
+        ImGui::Checkbox("Box selection with occlusion queries", &Config::getParameters().box_select_occlusion_queries);
+        ImGui::Spacing();
+
+        ImGui::Checkbox("Highlight object under cursor", &Config::getParameters().hover_picking);
+        ImGui::Spacing();
+
+        // Every view has its own camera: the mouse wheel zooms and the middle button turns the view under the cursor.
+        ImGui::Text("Views:");
+        auto& view_layout = reinterpret_cast<int&>(Config::getParameters().view_layout);
+        ImGui::RadioButton("single", &view_layout, static_cast<int>(ViewLayout::kSingle)); ImGui::SameLine();
+        ImGui::RadioButton("side by side", &view_layout, static_cast<int>(ViewLayout::kSideBySide)); ImGui::SameLine();
+        ImGui::RadioButton("2x2", &view_layout, static_cast<int>(ViewLayout::kQuad));
+        ImGui::Checkbox("Cull objects per view", &Config::getParameters().view_culling);
+        // Objects behind large convex ones are skipped on the CPU before they are drawn.
+        ImGui::Checkbox("Occlusion culling", &Config::getParameters().occlusion_culling);
+        ImGui::Spacing();
+
+        auto& history = session_.getHistory();
+        ImGui::Text("Undo memory: %.1f KB used", history.getByteSize() / 1024.0);
+        if (ImGui::SliderInt("##undo_budget", &undo_budget_mb_, 1, 256, "budget = %d MB"))
+        {
+            history.setByteBudget(static_cast<size_t>(undo_budget_mb_) * 1024 * 1024);
+        }
+        ImGui::Spacing();
+
+        drawPerformanceSettings();
+        drawMemoryUsage();
+        drawFrameCapture();
+        drawStressScene();
 
         ImGui::EndTabItem();
     }
 }
 
+void GuiPanels::drawPerformanceSettings()
+/** Draws a graph of frame times of the last 600 frames with p50/p99, CPU usage of the process, and controls to save CPU trace zones
+of the last N seconds as a Chrome/Perfetto trace file. */
+{
+    ImGui::Separator();
+    ImGui::Text("Frame time:");
+
+    auto samples = frame_time_stats_.orderedSamples();
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "p50 %.2f ms  p99 %.2f ms",
+             frame_time_stats_.percentile(0.5), frame_time_stats_.percentile(0.99));
+    float scale_max = static_cast<float>(frame_time_stats_.percentile(0.99)) * 1.5f;
+    ImGui::PlotLines("##frame_time", samples.data(), static_cast<int>(samples.size()), 0, overlay,
+                     0.0f, scale_max > 0.0f ? scale_max : 1.0f, ImVec2(-1, 80));
+    ImGui::Text("CPU usage: %.1f%% of one core, %.1f frames/s", cpu_usage_.percent(), cpu_usage_.framesPerSecond());
+    ImGui::Text("Time to first frame: %.1f ms", time_to_first_frame_ms_);
+    const auto& input_stats = Config::getInputStats();
+    ImGui::Text("Mouse events: %llu moves -> %llu updates, %llu scrolls -> %llu zooms",
+                input_stats.cursor_events_received, input_stats.cursor_updates_applied,
+                input_stats.scroll_events_received, input_stats.scroll_updates_applied);
+    const auto& hover_stats = Config::getHoverPickStats();
+    ImGui::Text("Hover picking: p50 %.3f ms  max %.3f ms per frame, %llu of %llu frames rendered a pixel",
+                hover_stats.overhead_ms.percentile(0.5), hover_stats.overhead_ms.max(),
+                hover_stats.pixels_rendered, hover_stats.frames);
+    const auto& view_stats = Config::getViewStats();
+    ImGui::Text("Views: %llu, %llu of %llu objects drawn (%llu outside, %llu too small, %llu without edges)",
+                view_stats.views, view_stats.drawn, view_stats.objects, view_stats.outside_frustum,
+                view_stats.too_small, view_stats.without_edges);
+    ImGui::Text("Occlusion culling: %llu occluders, %llu objects hidden behind them",
+                view_stats.occluders, view_stats.occluded);
+
+    if (!Trace::isEnabled())
+    {
+        ImGui::TextDisabled("Trace zones are disabled (PROJECT_1_ENABLE_TRACING)");
+        return;
+    }
+
+    ImGui::Text("Trace file:");
+    ImGui::InputText("##trace_file_path", trace_file_path_, sizeof(trace_file_path_));
+    ImGui::SliderInt("##trace_seconds", &trace_seconds_, 1, 20, "last %d s");
+    ImGui::SameLine();
+    if (ImGui::Button("Save trace"))
+    {
+        try
+        {
+            size_t zone_count = Trace::exportChromeTrace(trace_file_path_, trace_seconds_);
+            std::string logger_message = "Trace with " + std::to_string(zone_count) + " zones is saved to " +
+                                         trace_file_path_ + " (open in chrome://tracing or ui.perfetto.dev).";
+            Logger::addMessage(LogLevel::Info, logger_message.c_str());
+        }
+        catch (const std::exception& error)
+        {
+            Logger::addMessage(LogLevel::Error, error.what());
+        }
+    }
+}
+
+void GuiPanels::drawMemoryUsage()
+/** Draws host and OpenGL memory used by the scene: totals, categories, meshes and the largest Objects, and controls
+to save the whole report (every Object) as JSON. The report is collected again at most once per second. */
+{
+    ImGui::Separator();
+    if (!ImGui::TreeNode("Memory"))
+    {
+        return;
+    }
+
+    // Host copies of meshes in every Object are only useful to compare memory with them.
+    bool keep_host_copies = !session_.getGpuResidentObjects();
+    if (ImGui::Checkbox("Keep host copies of object meshes", &keep_host_copies))
+    {
+        session_.setGpuResidentObjects(!keep_host_copies);
+        memory_report_time_ = -1.0;
+    }
+
+    double now = ImGui::GetTime();
+    if (memory_report_time_ < 0.0 || now - memory_report_time_ >= 1.0)
+    {
+        memory_report_ = MemoryAccounting::collect(session_);
+        memory_report_time_ = now;
+    }
+    const auto& report = memory_report_;
+
+    ImGui::Text("Host: %.1f KB, OpenGL buffers: %.1f KB", report.host_bytes / 1024.0, report.gl_bytes / 1024.0);
+    for (int i = 0; i < static_cast<int>(MemoryCategory::kCount); i++)
+    {
+        auto category = static_cast<MemoryCategory>(i);
+        ImGui::BulletText("%s (%s): %.1f KB", MemoryAccounting::getCategoryName(category),
+                          MemoryAccounting::isGlCategory(category) ? "GL" : "host", report.category_bytes[i] / 1024.0);
+    }
+
+    ImGui::Text("Meshes:");
+    for (const auto& mesh: report.meshes)
+    {
+        ImGui::BulletText("%s: %zu objects, host %.1f KB, GL %.1f KB (float %.1f KB)", mesh.name.c_str(),
+                          mesh.object_count, mesh.host_bytes / 1024.0, mesh.gl_bytes / 1024.0,
+                          mesh.gl_float_bytes / 1024.0);
+    }
+
+    ImGui::Text("Largest objects:");
+    size_t top_count = std::min<size_t>(report.objects.size(), 10);
+    for (size_t i = 0; i < top_count; i++)
+    {
+        const auto& object = report.objects[i];
+        ImGui::BulletText("Object %d: host %.1f KB", object.object_id, object.host_bytes / 1024.0);
+    }
+
+    ImGui::InputText("##memory_report_path", memory_report_path_, sizeof(memory_report_path_));
+    ImGui::SameLine();
+    if (ImGui::Button("Save memory report"))
+    {
+        try
+        {
+            auto full_report = MemoryAccounting::collect(session_);
+            MemoryAccounting::writeJson(full_report, memory_report_path_);
+            std::string logger_message = "Memory report is saved to " + std::string(memory_report_path_) + ".";
+            Logger::addMessage(LogLevel::Info, logger_message.c_str());
+        }
+        catch (const std::exception& error)
+        {
+            Logger::addMessage(LogLevel::Error, error.what());
+        }
+    }
+    ImGui::TreePop();
+}
+
+void GuiPanels::drawFrameCapture()
+/** Draws controls to capture drawn frames to PNG files or raw video and counters of written and dropped frames. */
+{
+    ImGui::Separator();
+    if (!ImGui::TreeNode("Frame capture"))
+    {
+        return;
+    }
+
+    bool running = frame_capture_.isRunning();
+    if (running)
+    {
+        ImGui::BeginDisabled();
+    }
+    ImGui::InputText("##capture_path", capture_path_, sizeof(capture_path_));
+    if (!FrameCapture::isPngAvailable())
+    {
+        ImGui::BeginDisabled();
+        ImGui::RadioButton("PNG (needs zlib)", &capture_format_, static_cast<int>(CaptureFormat::kPng));
+        ImGui::EndDisabled();
+    }
+    else
+    {
+        ImGui::RadioButton("PNG", &capture_format_, static_cast<int>(CaptureFormat::kPng));
+    }
+    ImGui::SameLine();
+    ImGui::RadioButton("Raw video (RGB)", &capture_format_, static_cast<int>(CaptureFormat::kRawVideo));
+    if (running)
+    {
+        ImGui::EndDisabled();
+    }
+
+    if (ImGui::Button(running ? "Stop capture" : "Start capture"))
+    {
+        try
+        {
+            if (running)
+            {
+                frame_capture_.stop();
+                auto stats = frame_capture_.getStats();
+                std::string logger_message = "Frame capture stopped: " + std::to_string(stats.frames_written) +
+                                             " of " + std::to_string(stats.frames) + " frames written.";
+                Logger::addMessage(LogLevel::Info, logger_message.c_str());
+            }
+            else
+            {
+                frame_capture_.start(capture_path_, static_cast<CaptureFormat>(capture_format_));
+            }
+        }
+        catch (const std::exception& error)
+        {
+            Logger::addMessage(LogLevel::Error, error.what());
+        }
+    }
+
+    auto stats = frame_capture_.getStats();
+    const auto& overhead = frame_capture_.getOverhead();
+    ImGui::Text("Frames: %llu, written: %llu", stats.frames, stats.frames_written);
+    ImGui::Text("Dropped: GPU busy %llu, encoder busy %llu, size changed %llu", stats.dropped_gpu_busy,
+                stats.dropped_encoder_busy, stats.dropped_size_changed);
+    ImGui::Text("Capture per frame: %.3f ms mean, %.3f ms p99", overhead.mean(), overhead.percentile(0.99));
+    if (stats.write_errors > 0)
+    {
+        ImGui::Text("Errors: %llu, last: %s", stats.write_errors, frame_capture_.getLastError().c_str());
+    }
+    ImGui::TreePop();
+}
+
+void GuiPanels::drawStressScene()
+/** Draws controls to replace the scene with a generated stress scene (number of objects, seed, mix of types,
+distribution of positions, clusters, rotation and colours) and to run a zoom flythrough that records frame times. */
+{
+    ImGui::Separator();
+    if (!ImGui::TreeNode("Stress scene"))
+    {
+        return;
+    }
+
+    auto& parameters = stress_parameters_;
+    ImGui::InputInt("objects", &parameters.object_count, 100, 1000);
+    parameters.object_count = std::max(parameters.object_count, 0);
+    int seed = static_cast<int>(parameters.seed);
+    if (ImGui::InputInt("seed", &seed))
+    {
+        parameters.seed = static_cast<unsigned>(seed);
+    }
+
+    ImGui::Text("Mix of types:");
+    const char* type_names[kBuiltinObjectTypeCount] = {"cube", "pyramid", "sphere", "icosahedron"};
+    for (int i = 0; i < kBuiltinObjectTypeCount; i++)
+    {
+        ImGui::SliderFloat(type_names[i], &parameters.type_weights[i], 0.0f, 1.0f, "%.2f");
+    }
+    ImGui::SliderFloat("imported meshes", &parameters.registered_weight, 0.0f, 1.0f, "%.2f");
+
+    int distribution = static_cast<int>(parameters.distribution);
+    ImGui::Combo("positions", &distribution, "uniform\0normal\0");
+    parameters.distribution = static_cast<StressDistribution>(distribution);
+    ImGui::SliderFloat3("spread", parameters.spread, 0.0f, 10.0f, "%.1f");
+    ImGui::SliderInt("clusters", &parameters.cluster_count, 0, 100);
+    if (parameters.cluster_count > 0)
+    {
+        ImGui::SliderFloat("cluster radius", &parameters.cluster_radius, 0.1f, 5.0f, "%.1f");
+    }
+    ImGui::Checkbox("random rotation", &parameters.random_rotation);
+    int coloring = static_cast<int>(parameters.coloring);
+    ImGui::Combo("colours", &coloring, "random\0per type\0per cluster\0");
+    parameters.coloring = static_cast<StressColoring>(coloring);
+
+    if (ImGui::Button("Generate scene"))
+    {
+        auto stats = SceneStress::populate(session_, parameters);
+        char logger_message[128];
+        snprintf(logger_message, sizeof(logger_message), "Stress scene with %zu objects is generated in %.1f ms.",
+                 stats.object_count, stats.seconds * 1000.0);
+        Logger::addMessage(LogLevel::Info, logger_message);
+    }
+
+    ImGui::SliderInt("##flythrough_frames", &flythrough_frames_, 60, 3000, "%d frames");
+    ImGui::SameLine();
+    if (flythrough_.isRunning())
+    {
+        ImGui::TextDisabled("Flythrough is running...");
+    }
+    else if (ImGui::Button("Zoom flythrough"))
+    {
+        flythrough_.start(flythrough_frames_);
+    }
+    if (flythrough_.getStats().size() > 0)
+    {
+        ImGui::TextWrapped("%s", flythrough_.summary().c_str());
+    }
+
+    ImGui::TreePop();
+}
+
 void GuiPanels::drawHelpTab()
 /** Prints README.txt file content with information related to all functionality in this project. */
 {
@@ -167,13 +741,27 @@ void GuiPanels::drawObjectsPanels()
 it draws individual panel for this object. */
 {
     auto& objects = session_.getObjects();
-    for (auto & object : objects)
+    for (size_t object_index = 0; object_index < objects.size(); object_index++)
     {
-        drawIndividualPanel(object);
+        drawIndividualPanel(objects[object_index], static_cast<int>(object_index));
     }
 }
 
-void GuiPanels::drawIndividualPanel(Object &object) const
+void GuiPanels::recordColorEdit(int object_index)
+/** Called right after a colour widget of an Object: remembers the colour when editing starts and records the change
+for undo when editing is finished, so dragging in the colour picker becomes a single undo step. */
+{
+    if (ImGui::IsItemActivated())
+    {
+        std::memcpy(color_before_edit_, session_.getObjects()[object_index].getObjectColor(), sizeof(color_before_edit_));
+    }
+    if (ImGui::IsItemDeactivatedAfterEdit())
+    {
+        session_.recordColorChange(object_index, color_before_edit_);
+    }
+}
+
+void GuiPanels::drawIndividualPanel(Object &object, int object_index)
 /** Draws individual panel for an object where individual metadata is printed and following settings can be changed:
     - color of the object;
     - polygon mode: line or fill in (with color);
@@ -210,9 +798,9 @@ void GuiPanels::drawIndividualPanel(Object &object) const
 
         auto col = object.getObjectColor();
         std::string edit_col_name = "##individual fill color_" + object.ObjectIdToString();
-        if (ImGui::ColorEdit3(edit_col_name.c_str(), col)){
-            object.updateObjectColor();
-        }
+        // The colour is read when the Object is drawn next, no buffer has to change.
+        ImGui::ColorEdit3(edit_col_name.c_str(), col);
+        recordColorEdit(object_index);
         ImGui::Spacing();
 
         auto& polygon_mode = object.getPolygonMode();
@@ -229,6 +817,15 @@ void GuiPanels::drawIndividualPanel(Object &object) const
         ImGui::Text("Comment:");
         std::string comment_input = "##comment_input"+ object.ObjectIdToString();
         ImGui::InputText(comment_input.c_str(), gui_parameters.comment_, sizeof(gui_parameters.comment_[0]) * 128);
+        // The comment is recorded for undo once editing is finished, not after every typed character.
+        if (ImGui::IsItemActivated())
+        {
+            comment_before_edit_ = gui_parameters.comment_;
+        }
+        if (ImGui::IsItemDeactivatedAfterEdit())
+        {
+            session_.recordCommentChange(object_index, comment_before_edit_);
+        }
 
         ImGui::End();
     }
@@ -0,0 +1,110 @@
+#include <algorithm>
+
+#include "../include/history.h"
+#include "../include/math3d.h"
+
+
+size_t HistoryEntry::byteSize() const
+/** Approximate memory used by the entry, including its heap allocations. */
+{
+    size_t size = sizeof(HistoryEntry) + object_ids.capacity() * sizeof(int) +
+                  text_before.capacity() + text_after.capacity() + objects.capacity() * sizeof(ObjectState);
+    for (const auto& object: objects)
+    {
+        size += object.comment.capacity();
+    }
+    return size;
+}
+
+void History::record(HistoryEntry entry)
+/** Adds a new entry to the undo stack (or merges it into the last open entry) and clears the redo stack,
+because redo entries are based on the state before the new change. */
+{
+    for (const auto& redo_entry: redo_entries_)
+    {
+        byte_size_ -= redo_entry.byteSize();
+    }
+    redo_entries_.clear();
+
+    if (mergeIntoLastEntry_(entry))
+    {
+        return;
+    }
+
+    // Only moving and rotating can be continuous, other commands are complete entries.
+    entry_open_ = entry.command == HistoryCommand::kTranslate || entry.command == HistoryCommand::kRotate;
+    byte_size_ += entry.byteSize();
+    undo_entries_.push_back(std::move(entry));
+    enforceByteBudget_();
+}
+
+bool History::mergeIntoLastEntry_(const HistoryEntry& entry)
+/** Merges a translation or rotation into the last entry if it is still open and changes the same Objects. */
+{
+    if (!entry_open_ || undo_entries_.empty())
+    {
+        return false;
+    }
+    auto& last = undo_entries_.back();
+    if (last.command != entry.command || last.object_ids != entry.object_ids)
+    {
+        return false;
+    }
+
+    if (entry.command == HistoryCommand::kTranslate)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            last.values[i] += entry.values[i];
+        }
+        return true;
+    }
+    if (entry.command == HistoryCommand::kRotate)
+    {
+        // The new rotation is applied after the one already stored: merged = new * last.
+        float merged[9];
+        math3d::multiplyRotation(entry.values, last.values, merged);
+        std::copy(merged, merged + 9, last.values);
+        return true;
+    }
+    return false;
+}
+
+void History::finishUndo()
+{
+    entry_open_ = false;
+    redo_entries_.push_back(std::move(undo_entries_.back()));
+    undo_entries_.pop_back();
+}
+
+void History::finishRedo()
+{
+    entry_open_ = false;
+    undo_entries_.push_back(std::move(redo_entries_.back()));
+    redo_entries_.pop_back();
+}
+
+void History::clear()
+{
+    undo_entries_.clear();
+    redo_entries_.clear();
+    byte_size_ = 0;
+    entry_open_ = false;
+}
+
+void History::setByteBudget(size_t byte_budget)
+{
+    byte_budget_ = byte_budget;
+    enforceByteBudget_();
+}
+
+void History::enforceByteBudget_()
+/** Drops the oldest undo entries until the history fits into the byte budget. The newest entry is always kept,
+even if it is larger than the whole budget, so the last change can be undone. */
+{
+    while (byte_size_ > byte_budget_ && undo_entries_.size() > 1)
+    {
+        byte_size_ -= undo_entries_.front().byteSize();
+        undo_entries_.pop_front();
+    }
+}
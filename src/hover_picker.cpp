@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "../include/hover_picker.h"
+#include "../include/session.h"
+#include "../include/config.h"
+#include "../include/frame_scheduler.h"
+#include "../include/trace.h"
+
+
+namespace
+{
+bool rayHitsBox(const math3d::Vec3& origin, const math3d::Vec3& direction, const BoundingBox& box)
+/* Slab test: intersects the segment origin + t * direction, t in [0, 1], with the three pairs of planes of the box. */
+{
+    const float origins[3] = {origin.x, origin.y, origin.z};
+    const float directions[3] = {direction.x, direction.y, direction.z};
+    const float minimums[3] = {box.minX, box.minY, box.minZ};
+    const float maximums[3] = {box.maxX, box.maxY, box.maxZ};
+
+    float t_enter = 0.0f, t_exit = 1.0f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (directions[axis] == 0.0f)
+        {
+            if (origins[axis] < minimums[axis] || origins[axis] > maximums[axis])
+            {
+                return false;
+            }
+            continue;
+        }
+        float inverse = 1.0f / directions[axis];
+        float t_near = (minimums[axis] - origins[axis]) * inverse;
+        float t_far = (maximums[axis] - origins[axis]) * inverse;
+        if (t_near > t_far)
+        {
+            std::swap(t_near, t_far);
+        }
+        t_enter = std::max(t_enter, t_near);
+        t_exit = std::min(t_exit, t_far);
+        if (t_enter > t_exit)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void hashBytes(uint64_t& hash, const void* data, size_t size)
+/* FNV-1a, only used to notice that the Objects under the cursor have changed. */
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+}
+}
+
+
+void HoverPicker::update(const Session& session, const std::vector<ObjectDrawItem>& items, uint64_t structure_version,
+                         const math3d::Mat4& projection_matrix, const math3d::Mat4& view_matrix,
+                         const math3d::Mat4& inverse_view_projection, int window_width, int window_height,
+                         double cursor_x, double cursor_y)
+/** Reads the result of the pixel rendered in the previous frame, if there is one, and renders the pixel under the
+cursor if the result for it is not known yet. Cursor coordinates are in window pixels with y pointing down.
+items must be the draw items of the current structure of the scene, in Session order. */
+{
+    PROJECT_1_TRACE_ZONE("HoverPicker::update");
+    auto start_time = std::chrono::steady_clock::now();
+    auto& stats = Config::getHoverPickStats();
+    stats.frames++;
+
+    int x = static_cast<int>(std::floor(cursor_x));
+    // Window y-coordinates go top-to-bottom, OpenGL ones bottom-to-top.
+    int y = window_height - 1 - static_cast<int>(std::floor(cursor_y));
+    if (x < 0 || y < 0 || x >= window_width || y >= window_height)
+    {
+        clear();
+        return;
+    }
+
+    // Only one pixel is in flight. If the GPU hasn't finished it yet, the frame doesn't wait and the old result stays.
+    if (pending_ && !resolvePending_(session))
+    {
+        stats.results_not_ready++;
+        FrameScheduler::requestRedraw();
+        stats.overhead_ms.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                                        start_time).count());
+        return;
+    }
+
+    // Ray through the center of the pixel from the near to the far plane.
+    const math3d::Viewport viewport{0.0f, 0.0f, static_cast<float>(window_width), static_cast<float>(window_height)};
+    const math3d::Vec3 near_point = math3d::unproject({x + 0.5f, y + 0.5f, 0.0f}, inverse_view_projection, viewport);
+    const math3d::Vec3 far_point = math3d::unproject({x + 0.5f, y + 0.5f, 1.0f}, inverse_view_projection, viewport);
+    const math3d::Vec3 direction = far_point - near_point;
+
+    Key key;
+    key.x = x;
+    key.y = y;
+    key.structure_version = structure_version;
+    key.signature = 0xcbf29ce484222325ull;
+    const math3d::Mat4 view_projection = projection_matrix * view_matrix;
+    hashBytes(key.signature, view_projection.data(), 16 * sizeof(float));
+
+    candidates_.clear();
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        if (rayHitsBox(near_point, direction, items[i].bounding_box))
+        {
+            candidates_.push_back(static_cast<int>(i));
+            hashBytes(key.signature, &i, sizeof(i));
+            hashBytes(key.signature, items[i].model_matrix.data(), 16 * sizeof(float));
+        }
+    }
+
+    if (has_requested_key_ && key == requested_key_)
+    {
+        stats.cache_hits++;
+    }
+    else
+    {
+        requested_key_ = key;
+        has_requested_key_ = true;
+        if (candidates_.empty())
+        {
+            // Nothing can be under the cursor, the result is known without drawing.
+            hovered_object_ = -1;
+            hovered_structure_version_ = structure_version;
+        }
+        else
+        {
+            issue_(items, projection_matrix, view_matrix, window_width, window_height, x, y);
+            stats.pixels_rendered++;
+            // The result is read in the next frame.
+            FrameScheduler::requestRedraw();
+        }
+    }
+    stats.overhead_ms.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                                    start_time).count());
+}
+
+void HoverPicker::clear()
+/** Forgets the Object under the cursor, e.g. when the cursor leaves the scene. A pixel still in flight is discarded. */
+{
+    has_requested_key_ = false;
+    hovered_object_ = -1;
+}
+
+void HoverPicker::releaseBuffers()
+/** Deletes the pixel buffer and the fence, before the OpenGL context is destroyed. */
+{
+    if (fence_ != nullptr)
+    {
+        glDeleteSync(fence_);
+        fence_ = nullptr;
+    }
+    if (pixel_buffer_ != 0)
+    {
+        glDeleteBuffers(1, &pixel_buffer_);
+        pixel_buffer_ = 0;
+    }
+    pending_ = false;
+}
+
+bool HoverPicker::resolvePending_(const Session& session)
+/** Reads the pixel rendered by issue_ and converts its pick colour to an Object index. Returns false without
+blocking if the GPU hasn't finished it yet (the fence is not signalled). */
+{
+    if (fence_ != nullptr)
+    {
+        GLenum status = glClientWaitSync(fence_, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            return false;
+        }
+        glDeleteSync(fence_);
+        fence_ = nullptr;
+    }
+    pending_ = false;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer_);
+    const auto* pixel = static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 4,
+                                                                           GL_MAP_READ_BIT));
+    int object_index = -1;
+    if (pixel != nullptr)
+    {
+        object_index = session.getObjectIdByPickColor(pixel);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // If the cursor left the scene since the pixel was rendered, its result is not used.
+    if (has_requested_key_)
+    {
+        hovered_object_ = object_index;
+        hovered_structure_version_ = requested_key_.structure_version;
+    }
+    return true;
+}
+
+void HoverPicker::issue_(const std::vector<ObjectDrawItem>& items, const math3d::Mat4& projection_matrix,
+                         const math3d::Mat4& view_matrix, int window_width, int window_height, int x, int y)
+/** Draws the candidates with pick colours into pixel (x, y) and starts copying it into the pixel buffer.
+The viewport is reduced to this pixel and the projection is narrowed to it (like gluPickMatrix), so triangles around
+it are clipped before rasterization; the scissor test limits clearing to the pixel. The frame has to be cleared
+afterwards, the viewport is reset to the whole window. */
+{
+    if (pixel_buffer_ == 0)
+    {
+        glGenBuffers(1, &pixel_buffer_);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer_);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 4, nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x, y, 1, 1);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Scales the pixel up to the whole clip space: x + 0.5 maps to 0 and one pixel to the width of 2.
+    const auto width = static_cast<float>(window_width), height = static_cast<float>(window_height);
+    const math3d::Mat4 pick_projection = math3d::Mat4::translation(width - 2.0f * (x + 0.5f),
+                                                                   height - 2.0f * (y + 0.5f), 0.0f) *
+                                         math3d::Mat4::scaling(width, height, 1.0f) * projection_matrix;
+    glViewport(x, y, 1, 1);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(pick_projection.data());
+    glMatrixMode(GL_MODELVIEW);
+    // Neighbouring pick ids differ by one in the lowest bit of blue, so pick colours must be written exactly.
+    glDisable(GL_DITHER);
+    for (int index: candidates_)
+    {
+        Object::drawItem(items[index], view_matrix, true);
+    }
+    glEnable(GL_DITHER);
+
+    // With a pixel buffer bound, glReadPixels only queues the copy and returns, the data is an offset in the buffer.
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffer_);
+    glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    // Without sync objects (before OpenGL 3.2) the buffer is mapped without checking, which may wait for the GPU.
+    if (GLEW_ARB_sync)
+    {
+        fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    pending_ = true;
+
+    glDisable(GL_SCISSOR_TEST);
+    glViewport(0, 0, window_width, window_height);
+}
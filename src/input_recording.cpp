@@ -0,0 +1,603 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <unordered_set>
+#include "logger.h"
+
+#include "../include/input_recording.h"
+
+
+namespace
+{
+const char kRecordingMagic[4] = {'P', '1', 'I', 'R'};
+constexpr uint32_t kRecordingVersion = 1;
+constexpr size_t kHeaderSize = sizeof(kRecordingMagic) + sizeof(kRecordingVersion);
+
+// Bits of kParameters. render_on_demand is not recorded, a replay draws every recorded frame anyway.
+enum ParameterFlag : uint8_t
+{
+    kShowMetadata = 1u << 0,
+    kLockGuiToObjects = 1u << 1,
+    kBoxSelectOcclusionQueries = 1u << 2,
+    kHoverPicking = 1u << 3
+};
+
+uint8_t parameterFlags(const Parameters& parameters)
+{
+    return static_cast<uint8_t>((parameters.show_metadata ? kShowMetadata : 0) |
+                                (parameters.lock_gui_to_objects ? kLockGuiToObjects : 0) |
+                                (parameters.box_select_occlusion_queries ? kBoxSelectOcclusionQueries : 0) |
+                                (parameters.hover_picking ? kHoverPicking : 0));
+}
+
+bool sameObjectState(const Object& object, const ObjectState& state)
+/* Values are compared bitwise, so setting the same value again (e.g. a slider that is held still) is not a change. */
+{
+    const auto& gui_parameters = object.getObjectGuiParameters();
+    return std::memcmp(object.getTranslation(), state.translation, sizeof(state.translation)) == 0 &&
+           std::memcmp(object.getRotation(), state.rotation, sizeof(state.rotation)) == 0 &&
+           std::memcmp(&gui_parameters.zoom_factor_, &state.zoom_factor, sizeof(state.zoom_factor)) == 0 &&
+           std::memcmp(object.getObjectColor(), state.rgb, sizeof(state.rgb)) == 0 &&
+           object.getPolygonMode() == state.polygon_mode &&
+           std::strcmp(gui_parameters.comment_, state.comment.c_str()) == 0;
+}
+}
+
+
+void InputRecorder::open(const std::string& path)
+/** Creates the file (an existing one is overwritten) and writes the header. The scene is recorded in full with the
+first recordSceneChanges. Throws std::runtime_error if the file can't be created. */
+{
+    close();
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_)
+    {
+        throw std::runtime_error("Failed to open input recording file: " + path);
+    }
+    path_ = path;
+    file_.write(kRecordingMagic, sizeof(kRecordingMagic));
+    write_(kRecordingVersion);
+    if (!file_.good())
+    {
+        file_.close();
+        throw std::runtime_error("Failed to write input recording file: " + path);
+    }
+
+    frame_count_ = 0;
+    structure_version_ = UINT64_MAX;
+    clear_count_ = 0;
+    object_states_.clear();
+    selection_ = SelectionSet();
+    parameters_recorded_ = false;
+    view_layout_ = -1;
+    window_width_ = window_height_ = 0;
+}
+
+void InputRecorder::close()
+{
+    if (file_.is_open())
+    {
+        file_.close();
+    }
+}
+
+void InputRecorder::recordInput(const InputEvent& event)
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    switch (event.type)
+    {
+        case InputEvent::kMouseButton:
+            writeType_(RecordType::kMouseButton);
+            write_(event.time);
+            write_(event.x);
+            write_(event.y);
+            write_(static_cast<uint8_t>(event.button));
+            write_(static_cast<uint8_t>(event.action));
+            write_(static_cast<uint8_t>(event.mods));
+            break;
+        case InputEvent::kCursorPosition:
+            writeType_(RecordType::kCursorPosition);
+            write_(event.time);
+            write_(event.x);
+            write_(event.y);
+            break;
+        case InputEvent::kScroll:
+            writeType_(RecordType::kScroll);
+            write_(event.time);
+            write_(event.scroll_y);
+            break;
+        case InputEvent::kCursorEnter:
+            writeType_(RecordType::kCursorEnter);
+            write_(event.time);
+            write_(static_cast<uint8_t>(event.action));
+            break;
+    }
+}
+
+void InputRecorder::beginSceneChanges(const Session& session)
+/** Takes the transforms of Objects as the recorded mouse input has left them, so recordSceneChanges records only
+what is changed after this call. Must be called before GUI panels change the scene, once the input of the previous
+frame is applied, and in the same lock of the session as recordSceneChanges. */
+{
+    if (!isOpen() || session.getStructureVersion() != structure_version_)
+    {
+        return;
+    }
+    const auto& objects = session.getObjects();
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        auto& state = object_states_[i];
+        std::memcpy(state.translation, objects[i].getTranslation(), sizeof(state.translation));
+        std::memcpy(state.rotation, objects[i].getRotation(), sizeof(state.rotation));
+        state.zoom_factor = objects[i].getObjectGuiParameters().zoom_factor_;
+    }
+}
+
+void InputRecorder::recordSceneChanges(const Session& session)
+/** Records what has changed in the scene since the last call (or since beginSceneChanges): Objects and their state,
+the selection, Parameters and the layout of views.
+Must be called after GUI panels have changed the scene and before the frame is drawn, with the session not changed
+meanwhile (e.g. holding its mutex). */
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    if (session.getStructureVersion() != structure_version_)
+    {
+        recordStructure_(session);
+    }
+    recordObjectStates_(session);
+
+    // Comparing the bitsets costs one word per 64 Objects, selection changes are rare compared to frames.
+    if (session.getSelection() != selection_)
+    {
+        selection_ = session.getSelection();
+        writeType_(RecordType::kSelection);
+        write_(static_cast<uint32_t>(selection_.count()));
+        for (auto index: selection_)
+        {
+            write_(static_cast<uint32_t>(index));
+        }
+    }
+
+    const auto& parameters = Config::getParameters();
+    uint8_t flags = parameterFlags(parameters);
+    if (!parameters_recorded_ || flags != parameter_flags_ || parameters.rotation_sensitivity != rotation_sensitivity_)
+    {
+        parameters_recorded_ = true;
+        parameter_flags_ = flags;
+        rotation_sensitivity_ = parameters.rotation_sensitivity;
+        writeType_(RecordType::kParameters);
+        write_(parameter_flags_);
+        write_(rotation_sensitivity_);
+    }
+    if (static_cast<int>(parameters.view_layout) != view_layout_)
+    {
+        view_layout_ = static_cast<int>(parameters.view_layout);
+        writeType_(RecordType::kViewLayout);
+        write_(static_cast<uint8_t>(view_layout_));
+    }
+}
+
+void InputRecorder::recordStructure_(const Session& session)
+/** Records removed Objects by id and the full state of new ones. Objects that are kept stay in the same order and
+new ones are appended, so the replay only has to repeat the difference. If the session was cleared or the order is
+different (e.g. an undone removal restored an Object with an id that is still recorded), the whole scene is recorded
+again after kClearScene. */
+{
+    structure_version_ = session.getStructureVersion();
+    const auto& objects = session.getObjects();
+
+    std::unordered_set<int> current_ids;
+    current_ids.reserve(objects.size());
+    for (const auto& object: objects)
+    {
+        current_ids.insert(object.getId());
+    }
+
+    bool record_all = session.getClearCount() != clear_count_;
+    clear_count_ = session.getClearCount();
+    size_t kept_count = 0;
+    std::vector<int> removed_ids;
+    for (size_t i = 0; i < object_states_.size() && !record_all; i++)
+    {
+        int id = object_states_[i].id;
+        if (current_ids.count(id) == 0)
+        {
+            removed_ids.push_back(id);
+        }
+        else if (kept_count < objects.size() && objects[kept_count].getId() == id)
+        {
+            kept_count++;
+        }
+        else
+        {
+            record_all = true;
+        }
+    }
+
+    if (record_all)
+    {
+        writeType_(RecordType::kClearScene);
+        kept_count = 0;
+        removed_ids.clear();
+    }
+    for (int id: removed_ids)
+    {
+        writeType_(RecordType::kRemoveObject);
+        write_(static_cast<int32_t>(id));
+    }
+
+    // Kept Objects keep their recorded states, they are compared with the scene in recordObjectStates_.
+    object_states_.erase(std::remove_if(object_states_.begin(), object_states_.end(),
+                                        [&current_ids](const ObjectState& state) {
+                                            return current_ids.count(state.id) == 0;
+                                        }),
+                         object_states_.end());
+    object_states_.resize(kept_count);
+    for (size_t i = kept_count; i < objects.size(); i++)
+    {
+        object_states_.push_back(session.captureObjectState(objects[i]));
+        writeType_(RecordType::kCreateObject);
+        writeObjectState_(object_states_.back());
+    }
+}
+
+void InputRecorder::recordObjectStates_(const Session& session)
+/** Records the full state of every Object that differs from its recorded state, whatever has changed it (sliders,
+colour and comment in GUI, Reset, undo and redo). Comparing costs a few dozen bytes per Object and frame, and only
+while recording. */
+{
+    const auto& objects = session.getObjects();
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        if (!sameObjectState(objects[i], object_states_[i]))
+        {
+            object_states_[i] = session.captureObjectState(objects[i]);
+            writeType_(RecordType::kObjectState);
+            writeObjectState_(object_states_[i]);
+        }
+    }
+}
+
+void InputRecorder::recordWindowSize(int width, int height)
+/** Records the size of the drawing area when it has changed. */
+{
+    if (!isOpen() || (width == window_width_ && height == window_height_))
+    {
+        return;
+    }
+    window_width_ = width;
+    window_height_ = height;
+    writeType_(RecordType::kWindowSize);
+    write_(static_cast<int32_t>(width));
+    write_(static_cast<int32_t>(height));
+}
+
+void InputRecorder::recordZoom(double zoom_step)
+/** Records a zoom that doesn't come from the mouse wheel (the flythrough), it's applied after pending input. */
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    writeType_(RecordType::kZoom);
+    write_(zoom_step);
+}
+
+void InputRecorder::recordFrame(bool imgui_capture_mouse, double frame_milliseconds)
+/** Ends the records of a drawn frame. ImGui's mouse capture is recorded because DrawingLib ignores clicks and scroll
+on ImGui windows, which are not drawn in a replay. */
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    writeType_(RecordType::kFrame);
+    write_(static_cast<uint8_t>(imgui_capture_mouse ? 1 : 0));
+    write_(frame_milliseconds);
+    frame_count_++;
+    checkWritten_();
+}
+
+void InputRecorder::writeType_(RecordType type)
+{
+    write_(static_cast<uint8_t>(type));
+}
+
+void InputRecorder::writeObjectState_(const ObjectState& state)
+{
+    write_(static_cast<int32_t>(state.id));
+    write_(static_cast<int32_t>(state.object_type));
+    file_.write(reinterpret_cast<const char*>(state.rgb), sizeof(state.rgb));
+    file_.write(reinterpret_cast<const char*>(state.translation), sizeof(state.translation));
+    file_.write(reinterpret_cast<const char*>(state.rotation), sizeof(state.rotation));
+    write_(state.zoom_factor);
+    write_(static_cast<int32_t>(state.polygon_mode));
+    auto length = static_cast<uint16_t>(std::min<size_t>(state.comment.size(), std::numeric_limits<uint16_t>::max()));
+    write_(length);
+    file_.write(state.comment.data(), length);
+}
+
+void InputRecorder::checkWritten_()
+{
+    if (!file_.good())
+    {
+        file_.close();
+        std::string logger_message = "Input recording stopped: failed to write " + path_;
+        Logger::addMessage(LogLevel::Error, logger_message.c_str());
+    }
+}
+
+void InputReplay::open(const std::string& path)
+/** Reads the whole recording into memory and checks that all its records are complete, so a broken file is
+reported before anything is replayed. Throws std::runtime_error if the file can't be read or is not a recording. */
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open input recording file: " + path);
+    }
+    data_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (data_.size() < kHeaderSize || std::memcmp(data_.data(), kRecordingMagic, sizeof(kRecordingMagic)) != 0)
+    {
+        throw std::runtime_error("Not an input recording: " + path);
+    }
+    uint32_t version;
+    std::memcpy(&version, data_.data() + sizeof(kRecordingMagic), sizeof(version));
+    if (version != kRecordingVersion)
+    {
+        throw std::runtime_error("Unsupported version of input recording: " + path);
+    }
+
+    frame_count_ = 0;
+    max_window_width_ = max_window_height_ = 0;
+    position_ = kHeaderSize;
+    try
+    {
+        Record record;
+        while (readRecord_(record))
+        {
+            if (record.type == RecordType::kFrame)
+            {
+                frame_count_++;
+            }
+            else if (record.type == RecordType::kWindowSize)
+            {
+                max_window_width_ = std::max(max_window_width_, record.values[0]);
+                max_window_height_ = std::max(max_window_height_, record.values[1]);
+            }
+        }
+    }
+    catch (const std::runtime_error& error)
+    {
+        throw std::runtime_error(error.what() + (": " + path));
+    }
+    position_ = kHeaderSize;
+    next_object_index_ = 0;
+}
+
+bool InputReplay::playFrame(Session& session, DrawingLib& drawing_lib, ReplayFrame& frame)
+/** Applies all records of the next frame in the order of the main loop, the frame itself is drawn by the caller
+(DrawingLib::renderScene with frame.imgui_capture_mouse). Returns false at the end of the recording; records after
+the last complete frame are not played. */
+{
+    Record record;
+    double zoom_step = 0.0;
+    while (readRecord_(record))
+    {
+        if (record.type == RecordType::kFrame)
+        {
+            // The main loop applies pending input after GUI changes and the window size, then the flythrough zoom.
+            drawing_lib.applyPendingInput();
+            if (zoom_step != 0.0)
+            {
+                drawing_lib.zoom(zoom_step);
+            }
+            frame.imgui_capture_mouse = record.values[0] != 0;
+            frame.recorded_milliseconds = record.number;
+            return true;
+        }
+        applyRecord_(record, session, drawing_lib, zoom_step);
+    }
+    return false;
+}
+
+void InputReplay::applyRecord_(const Record& record, Session& session, DrawingLib& drawing_lib, double& zoom_step)
+{
+    switch (record.type)
+    {
+        case RecordType::kMouseButton:
+        case RecordType::kCursorPosition:
+        case RecordType::kScroll:
+        case RecordType::kCursorEnter:
+            drawing_lib.handleInput(record.event);
+            break;
+        case RecordType::kClearScene:
+            session.clear();
+            break;
+        case RecordType::kRemoveObject:
+        {
+            const auto& objects = session.getObjects();
+            auto it = std::find_if(objects.begin(), objects.end(), [&record](const Object& object) {
+                return object.getId() == record.values[0];
+            });
+            if (it != objects.end())
+            {
+                session.remove_object(static_cast<int>(it - objects.begin()));
+            }
+            break;
+        }
+        case RecordType::kCreateObject:
+            session.restoreObjectState(record.state);
+            break;
+        case RecordType::kSelection:
+            session.deSelectAllObjects();
+            for (int index: record.indices)
+            {
+                if (static_cast<size_t>(index) < session.getObjects().size())
+                {
+                    session.setSelected(index, true);
+                }
+            }
+            break;
+        case RecordType::kParameters:
+        {
+            auto& parameters = Config::getParameters();
+            parameters.show_metadata = (record.values[0] & kShowMetadata) != 0;
+            parameters.lock_gui_to_objects = (record.values[0] & kLockGuiToObjects) != 0;
+            parameters.box_select_occlusion_queries = (record.values[0] & kBoxSelectOcclusionQueries) != 0;
+            parameters.hover_picking = (record.values[0] & kHoverPicking) != 0;
+            parameters.rotation_sensitivity = record.rotation_sensitivity;
+            break;
+        }
+        case RecordType::kWindowSize:
+            drawing_lib.setWindowSize(record.values[0], record.values[1]);
+            break;
+        case RecordType::kZoom:
+            zoom_step += record.number;
+            break;
+        case RecordType::kFrame:
+            break;
+        case RecordType::kViewLayout:
+            Config::getParameters().view_layout = static_cast<ViewLayout>(record.values[0]);
+            break;
+        case RecordType::kObjectState:
+        {
+            // States of a frame are recorded in the order of Objects, so the search starts after the previous one.
+            const auto& objects = session.getObjects();
+            auto is_recorded = [&record](const Object& object){return object.getId() == record.state.id;};
+            auto start = objects.begin() + static_cast<long>(std::min(next_object_index_, objects.size()));
+            auto it = std::find_if(start, objects.end(), is_recorded);
+            if (it == objects.end())
+            {
+                auto before = std::find_if(objects.begin(), start, is_recorded);
+                it = before != start ? before : objects.end();
+            }
+            if (it != objects.end())
+            {
+                auto index = static_cast<size_t>(it - objects.begin());
+                session.applyObjectState(index, record.state);
+                next_object_index_ = index + 1;
+            }
+            break;
+        }
+    }
+}
+
+bool InputReplay::readRecord_(Record& record)
+/** Parses the record at position_. Returns false at the end of data, throws std::runtime_error if the record is
+incomplete or of an unknown type. */
+{
+    if (position_ >= data_.size())
+    {
+        return false;
+    }
+    auto type = read_<uint8_t>();
+    if (type > static_cast<uint8_t>(RecordType::kObjectState))
+    {
+        throw std::runtime_error("Unknown record in input recording");
+    }
+    record.type = static_cast<RecordType>(type);
+    switch (record.type)
+    {
+        case RecordType::kMouseButton:
+            record.event = InputEvent{InputEvent::kMouseButton, read_<double>()};
+            record.event.x = read_<double>();
+            record.event.y = read_<double>();
+            record.event.button = read_<uint8_t>();
+            record.event.action = read_<uint8_t>();
+            record.event.mods = read_<uint8_t>();
+            break;
+        case RecordType::kCursorPosition:
+            record.event = InputEvent{InputEvent::kCursorPosition, read_<double>()};
+            record.event.x = read_<double>();
+            record.event.y = read_<double>();
+            break;
+        case RecordType::kScroll:
+            record.event = InputEvent{InputEvent::kScroll, read_<double>()};
+            record.event.scroll_y = read_<double>();
+            break;
+        case RecordType::kCursorEnter:
+            record.event = InputEvent{InputEvent::kCursorEnter, read_<double>()};
+            record.event.action = read_<uint8_t>();
+            break;
+        case RecordType::kClearScene:
+            break;
+        case RecordType::kRemoveObject:
+            record.values[0] = read_<int32_t>();
+            break;
+        case RecordType::kCreateObject:
+        case RecordType::kObjectState:
+        {
+            auto& state = record.state;
+            state.id = read_<int32_t>();
+            state.object_type = static_cast<ObjectType>(read_<int32_t>());
+            read_(state.rgb, sizeof(state.rgb));
+            read_(state.translation, sizeof(state.translation));
+            read_(state.rotation, sizeof(state.rotation));
+            state.zoom_factor = read_<float>();
+            state.polygon_mode = static_cast<PolygonMode>(read_<int32_t>());
+            state.comment.resize(read_<uint16_t>());
+            read_(&state.comment[0], state.comment.size());
+            break;
+        }
+        case RecordType::kSelection:
+        {
+            auto count = read_<uint32_t>();
+            // Checked before resizing, so a broken count doesn't allocate a huge vector.
+            if (count > (data_.size() - position_) / sizeof(uint32_t))
+            {
+                throw std::runtime_error("Input recording is truncated");
+            }
+            record.indices.resize(count);
+            for (auto& index: record.indices)
+            {
+                index = static_cast<int>(read_<uint32_t>());
+            }
+            break;
+        }
+        case RecordType::kParameters:
+            record.values[0] = read_<uint8_t>();
+            record.rotation_sensitivity = read_<float>();
+            break;
+        case RecordType::kWindowSize:
+            record.values[0] = read_<int32_t>();
+            record.values[1] = read_<int32_t>();
+            break;
+        case RecordType::kZoom:
+            record.number = read_<double>();
+            break;
+        case RecordType::kFrame:
+            record.values[0] = read_<uint8_t>();
+            record.number = read_<double>();
+            break;
+        case RecordType::kViewLayout:
+            record.values[0] = read_<uint8_t>();
+            if (record.values[0] > static_cast<int>(ViewLayout::kQuad))
+            {
+                throw std::runtime_error("Unknown view layout in input recording");
+            }
+            break;
+    }
+    return true;
+}
+
+void InputReplay::read_(void* value, size_t size)
+{
+    if (size > data_.size() - position_)
+    {
+        throw std::runtime_error("Input recording is truncated");
+    }
+    if (size > 0)
+    {
+        std::memcpy(value, data_.data() + position_, size);
+    }
+    position_ += size;
+}
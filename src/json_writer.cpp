@@ -0,0 +1,31 @@
+#include "../include/json_writer.h"
+
+
+namespace json
+{
+void writeString(std::ostream& stream, const char* text, size_t length)
+/** Writes text as a quoted JSON string. Quotes and backslashes are escaped with a backslash, control characters
+(below 0x20, e.g. tabs and newlines in mesh names or comments) as \uXXXX, which JSON doesn't allow unescaped. Other
+bytes are written as they are, so UTF-8 text stays UTF-8. */
+{
+    static const char kHexDigits[] = "0123456789abcdef";
+    stream << '"';
+    for (size_t i = 0; i < length; i++)
+    {
+        auto c = static_cast<unsigned char>(text[i]);
+        if (c == '"' || c == '\\')
+        {
+            stream << '\\' << text[i];
+        }
+        else if (c < 0x20)
+        {
+            stream << "\\u00" << kHexDigits[c >> 4] << kHexDigits[c & 0xF];
+        }
+        else
+        {
+            stream << text[i];
+        }
+    }
+    stream << '"';
+}
+}
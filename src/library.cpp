@@ -0,0 +1,19 @@
+#include "../include/library.h"
+#include "../include/mesh_registry.h"
+
+
+MeshView getMeshByType(int type_id)
+/** Returns the mesh of an object type_id. Ids after the built-in types refer to meshes registered in
+MeshRegistry (e.g. imported from files). If id is unknown, it returns Cube. */
+{
+    if (type_id >= 0 && type_id < kBuiltinObjectTypeCount)
+    {
+        return kBuiltinMeshes[type_id];
+    }
+    if (MeshRegistry::contains(type_id))
+    {
+        const Polyhedron& mesh = MeshRegistry::getMesh(static_cast<ObjectType>(type_id));
+        return {mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size()};
+    }
+    return kBuiltinMeshes[kCube];
+}
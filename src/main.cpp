@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
+#include <string>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "imgui.h"
@@ -10,32 +16,111 @@
 #include "../include/drawing_lib.h"
 #include "../include/gui_panels.h"
 #include "../include/config.h"
+#include "../include/trace.h"
+#include "../include/frame_scheduler.h"
+#include "../include/scene_updater.h"
+#include "../include/scene_stress.h"
+#include "../include/input_recording.h"
 
+namespace
+{
+struct Options
+{
+    // With stress_objects > 0 the application starts with a generated stress scene (see SceneStress)
+    // and runs a zoom flythrough of flythrough_frames frames.
+    StressParameters stress;
+    int stress_objects{0};
+    int flythrough_frames{600};
+    bool exit_after_flythrough{false};
+    // Mouse input and changes of the scene are recorded to this file for project_1_bench --replay (see InputRecorder).
+    std::string record_path;
+};
 
-Parameters Config::parameters_;
-ImGuiAl::Log* Logger::log_panel_;
-bool Logger::p_open_{true};
-char Logger::log_buffer_[kBufferSize];
+void printUsage()
+{
+    std::cout << "Usage: project_1 [--stress N] [--seed S] [--clusters K] [--flythrough FRAMES] [--exit-after-flythrough]\n"
+                 "                 [--record FILE]\n"
+                 "  --stress                 start with a generated scene of N objects\n"
+                 "  --seed                   random seed of the stress scene (default 1)\n"
+                 "  --clusters               number of clusters of objects (default 0 - no clusters)\n"
+                 "  --flythrough             frames of the zoom flythrough that records frame times (default 600)\n"
+                 "  --exit-after-flythrough  print frame time statistics and exit when the flythrough ends\n"
+                 "  --record                 record mouse input and changes of the scene to FILE for replay\n";
+}
 
+Options parseOptions(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool has_value = i + 1 < argc;
+        if (argument == "--stress" && has_value) {options.stress_objects = std::atoi(argv[++i]);}
+        else if (argument == "--seed" && has_value) {options.stress.seed = static_cast<unsigned>(std::atoi(argv[++i]));}
+        else if (argument == "--clusters" && has_value) {options.stress.cluster_count = std::atoi(argv[++i]);}
+        else if (argument == "--flythrough" && has_value) {options.flythrough_frames = std::atoi(argv[++i]);}
+        else if (argument == "--exit-after-flythrough") {options.exit_after_flythrough = true;}
+        else if (argument == "--record" && has_value) {options.record_path = argv[++i];}
+        else
+        {
+            printUsage();
+            std::exit(argument == "--help" ? 0 : 1);
+        }
+    }
+    if (options.stress_objects < 0 || options.flythrough_frames < 0)
+    {
+        printUsage();
+        std::exit(1);
+    }
+    options.stress.object_count = options.stress_objects;
+    return options;
+}
+}
 
 
-int main()
+int main(int argc, char** argv)
 {
+    // Time to first frame is measured from here: built-in meshes are constant tables (library.h),
+    // so no static initialisers run before main.
+    const auto start_time = std::chrono::steady_clock::now();
+    bool first_frame_drawn = false;
+    Options options = parseOptions(argc, argv);
+
+    InputRecorder input_recorder;
+    if (!options.record_path.empty())
+    {
+        try
+        {
+            input_recorder.open(options.record_path);
+        }
+        catch (const std::exception& error)
+        {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+    }
+
     Logger::init();
+    Trace::setThreadName("main");
     glfwInit();
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
 
     // Session
-    Session session = Session();
+    Session session;
     DrawingLib drawing_lib    = DrawingLib(session);
-    GuiPanels gui_panels = GuiPanels(session);
+    GuiPanels gui_panels(session);
     Logger::addMessage(LogLevel::Info, "Welcome to OpenGL examples: project_1!");
 
     GLFWwindow* window = drawing_lib.createWindow();
     glfwMakeContextCurrent(window);
     drawing_lib.defineCallbackFunction(window);
+    if (input_recorder.isOpen())
+    {
+        drawing_lib.setInputRecorder(&input_recorder);
+    }
+    drawing_lib.setFrameCapture(&gui_panels.getFrameCapture());
 
     GLenum res = glewInit();
     if (res)
@@ -54,28 +139,119 @@ int main()
 
     ImGui::StyleColorsDark();
 
-    session.add_object(kIcosahedron);
+    auto& flythrough = gui_panels.getFlythrough();
+    if (options.stress_objects > 0)
+    {
+        auto stats = SceneStress::populate(session, options.stress);
+        std::cout << "Stress scene: " << stats.object_count << " objects generated in "
+                  << stats.seconds * 1000.0 << " ms" << std::endl;
+        if (options.flythrough_frames > 0)
+        {
+            flythrough.start(options.flythrough_frames);
+        }
+    }
+    else
+    {
+        session.add_object(kIcosahedron);
+    }
+
+    // Moving and rotating Objects happens on the update thread, this thread draws its snapshots.
+    // glfwPostEmptyEvent wakes the main loop up if it waits for events.
+    SceneUpdater scene_updater(session);
+    drawing_lib.setSceneUpdater(&scene_updater);
+    scene_updater.start([] {glfwPostEmptyEvent();});
 
     ImGui_ImplOpenGL3_CreateFontsTexture();
+    double last_frame_time = glfwGetTime();
     while (glfwWindowShouldClose(window) == 0)
     {
+        bool render_on_demand = Config::getParameters().render_on_demand;
+        if (render_on_demand && !FrameScheduler::isRedrawPending())
+        {
+            // Nothing has changed since the last frame: sleeps until an event arrives (callbacks request a redraw)
+            // or until it's time for the idle refresh.
+            PROJECT_1_TRACE_ZONE("glfwWaitEventsTimeout");
+            double timeout = FrameScheduler::kIdleRefreshSeconds - (glfwGetTime() - last_frame_time);
+            glfwWaitEventsTimeout(std::max(timeout, 0.0));
+        }
+        else
+        {
+            PROJECT_1_TRACE_ZONE("glfwPollEvents");
+            glfwPollEvents();
+        }
+        if (render_on_demand && !FrameScheduler::isRedrawPending() &&
+            glfwGetTime() - last_frame_time < FrameScheduler::kIdleRefreshSeconds)
+        {
+            continue;
+        }
 
-        glfwPollEvents();
+        PROJECT_1_TRACE_ZONE("frame");
+        double frame_start_time = glfwGetTime();
 
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        gui_panels.drawMainPanel();
-        gui_panels.drawObjectsPanels();
+        {
+            // GUI panels read and change Objects directly, so the update thread waits until they are built.
+            // Commands it hasn't applied yet are applied first, so GUI changes come after them.
+            std::lock_guard<std::mutex> session_lock(session.getMutex());
+            scene_updater.applyQueuedCommands();
+            input_recorder.beginSceneChanges(session);
+            {
+                PROJECT_1_TRACE_ZONE("GuiPanels::drawMainPanel");
+                gui_panels.drawMainPanel();
+            }
+            {
+                PROJECT_1_TRACE_ZONE("GuiPanels::drawObjectsPanels");
+                gui_panels.drawObjectsPanels();
+            }
+            input_recorder.recordSceneChanges(session);
+        }
         drawing_lib.getWindowSize(window);
+        input_recorder.recordWindowSize(drawing_lib.getWindowWidth(), drawing_lib.getWindowHeight());
+
+        // Mouse movements and scroll steps received since the last frame are queued for the update thread at once,
+        // it applies them while this thread draws the frame. The new snapshot also includes changes made in GUI.
+        drawing_lib.applyPendingInput();
+        if (flythrough.isRunning())
+        {
+            double zoom_step = flythrough.nextZoomStep();
+            drawing_lib.zoom(zoom_step);
+            input_recorder.recordZoom(zoom_step);
+        }
+        scene_updater.requestSnapshot();
 
         // Check if ImGui wants to capture the mouse
         bool ioWantCaptureMouse = ImGui::GetIO().WantCaptureMouse;
 
         drawing_lib.drawScene(window, ioWantCaptureMouse);
+        FrameScheduler::frameDrawn();
+
+        last_frame_time = glfwGetTime();
+        bool flythrough_was_running = flythrough.isRunning();
+        gui_panels.addFrameTime((last_frame_time - frame_start_time) * 1000.0);
+        input_recorder.recordFrame(ioWantCaptureMouse, (last_frame_time - frame_start_time) * 1000.0);
+        if (flythrough_was_running && !flythrough.isRunning())
+        {
+            std::cout << flythrough.summary() << std::endl;
+            if (options.exit_after_flythrough)
+            {
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+            }
+        }
+
+        if (!first_frame_drawn)
+        {
+            first_frame_drawn = true;
+            double milliseconds = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start_time).count();
+            gui_panels.setTimeToFirstFrame(milliseconds);
+            char logger_message[64];
+            snprintf(logger_message, sizeof(logger_message), "Time to first frame: %.1f ms", milliseconds);
+            Logger::addMessage(LogLevel::Info, logger_message);
+        }
 
-        glfwPollEvents();
         GLuint res = glGetError();
         if (res)
         {
@@ -83,6 +259,15 @@ int main()
         }
 
     }
+    scene_updater.stop();
+    if (input_recorder.isOpen())
+    {
+        std::cout << "Input recording: " << input_recorder.getFrameCount() << " frames written to "
+                  << options.record_path << std::endl;
+        input_recorder.close();
+    }
+    gui_panels.getFrameCapture().stop();
+    drawing_lib.releaseBuffers();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
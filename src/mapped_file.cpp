@@ -0,0 +1,49 @@
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/mapped_file.h"
+
+
+MappedFile::MappedFile(const std::string& file_path)
+{
+    int file_descriptor = open(file_path.c_str(), O_RDONLY);
+    if (file_descriptor < 0)
+    {
+        throw std::runtime_error("Failed to open the file " + file_path + ".");
+    }
+
+    struct stat file_stat{};
+    if (fstat(file_descriptor, &file_stat) != 0)
+    {
+        close(file_descriptor);
+        throw std::runtime_error("Failed to read the size of the file " + file_path + ".");
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+
+    // An empty file can't be mapped, data() stays nullptr.
+    if (size_ > 0)
+    {
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(file_descriptor);
+            throw std::runtime_error("Failed to map the file " + file_path + " into memory.");
+        }
+        // Files are read front to back, so the OS can read ahead aggressively.
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const unsigned char*>(mapping);
+    }
+    // The mapping stays valid after the file descriptor is closed.
+    close(file_descriptor);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(data_), size_);
+    }
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#include "../include/json_writer.h"
+#include "../include/memory_report.h"
+#include "../include/mesh_registry.h"
+#include "../include/mesh_buffer_cache.h"
+
+
+namespace
+{
+std::string meshName(ObjectType object_type)
+/* Same names as Object::ObjectTypeToString, without an Object. */
+{
+    switch (object_type)
+    {
+        case kCube: return "Cube";
+        case kPyramid: return "Pyramid";
+        case kSphere: return "Sphere";
+        case kIcosahedron: return "Icosahedron";
+        default: return MeshRegistry::contains(object_type) ? MeshRegistry::getName(object_type) : "Unknown";
+    }
+}
+}
+
+
+MemoryReport MemoryAccounting::collect(const Session& session)
+/** Counts memory of all Objects, meshes and the undo history of the session. Must be called while the session is
+not changed (e.g. holding its mutex); OpenGL is not called. */
+{
+    MemoryReport report;
+    auto add = [&report](MemoryCategory category, size_t bytes) {
+        report.category_bytes[static_cast<int>(category)] += bytes;
+    };
+
+    const auto& objects = session.getObjects();
+    std::map<int, MeshMemory> meshes;
+    report.objects.reserve(objects.size());
+    add(MemoryCategory::kObjects, objects.capacity() * sizeof(Object));
+    for (const auto& object: objects)
+    {
+        ObjectMemoryUsage usage = object.getMemoryUsage();
+        add(MemoryCategory::kObjectVertices, usage.vertices);
+        add(MemoryCategory::kObjectIndices, usage.indices);
+
+        size_t host_bytes = sizeof(Object) + usage.vertices + usage.indices;
+        report.objects.push_back({object.getId(), object.getObjectType(), host_bytes});
+
+        auto& mesh = meshes[object.getObjectType()];
+        mesh.object_count++;
+        mesh.host_bytes += usage.vertices + usage.indices;
+    }
+
+    for (size_t i = 0; i < MeshRegistry::size(); i++)
+    {
+        auto object_type = static_cast<ObjectType>(kBuiltinObjectTypeCount + i);
+        const auto& polyhedron = MeshRegistry::getMesh(object_type);
+        size_t bytes = polyhedron.vertices.capacity() * sizeof(GLfloat) +
+                       polyhedron.indices.capacity() * sizeof(GLuint);
+        add(MemoryCategory::kRegisteredMeshes, bytes);
+        meshes[object_type].host_bytes += bytes;
+    }
+    add(MemoryCategory::kUndoHistory, session.getHistory().getByteSize());
+
+    for (auto& entry: meshes)
+    {
+        auto object_type = static_cast<ObjectType>(entry.first);
+        auto& mesh = entry.second;
+        mesh.object_type = object_type;
+        mesh.name = meshName(object_type);
+        mesh.gl_bytes = MeshBufferCache::getByteSize(object_type);
+        mesh.gl_float_bytes = MeshBufferCache::getFloatByteSize(object_type);
+        add(MemoryCategory::kMeshBuffers, mesh.gl_bytes);
+        report.meshes.push_back(mesh);
+    }
+    const auto buffer_stats = MeshBufferCache::getStats();
+    add(MemoryCategory::kMeshBufferFreeSpace, buffer_stats.buffer_capacity - buffer_stats.byte_size);
+
+    for (int i = 0; i < static_cast<int>(MemoryCategory::kCount); i++)
+    {
+        auto& total = isGlCategory(static_cast<MemoryCategory>(i)) ? report.gl_bytes : report.host_bytes;
+        total += report.category_bytes[i];
+    }
+
+    std::stable_sort(report.objects.begin(), report.objects.end(), [](const ObjectMemory& a, const ObjectMemory& b) {
+        return a.host_bytes > b.host_bytes;
+    });
+    std::stable_sort(report.meshes.begin(), report.meshes.end(), [](const MeshMemory& a, const MeshMemory& b) {
+        return a.host_bytes + a.gl_bytes > b.host_bytes + b.gl_bytes;
+    });
+    return report;
+}
+
+void MemoryAccounting::writeJson(const MemoryReport& report, const std::string& path)
+/** Writes the report as JSON: totals, categories, meshes and all Objects, the largest first.
+Throws std::runtime_error if the file can't be written. */
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open memory report file: " + path);
+    }
+
+    file << "{\n  \"host_bytes\": " << report.host_bytes << ",\n  \"gl_bytes\": " << report.gl_bytes
+         << ",\n  \"categories\": [";
+    for (int i = 0; i < static_cast<int>(MemoryCategory::kCount); i++)
+    {
+        auto category = static_cast<MemoryCategory>(i);
+        file << (i == 0 ? "\n" : ",\n") << R"(    {"name": )";
+        json::writeString(file, getCategoryName(category));
+        file << R"(, "memory": ")" << (isGlCategory(category) ? "gl" : "host") << R"(", "bytes": )"
+             << report.category_bytes[i] << "}";
+    }
+
+    file << "\n  ],\n  \"meshes\": [";
+    for (size_t i = 0; i < report.meshes.size(); i++)
+    {
+        const auto& mesh = report.meshes[i];
+        file << (i == 0 ? "\n" : ",\n") << R"(    {"type": )" << static_cast<int>(mesh.object_type) << R"(, "name": )";
+        json::writeString(file, mesh.name);
+        file << R"(, "objects": )" << mesh.object_count << R"(, "host_bytes": )" << mesh.host_bytes
+             << R"(, "gl_bytes": )" << mesh.gl_bytes << R"(, "gl_float_bytes": )" << mesh.gl_float_bytes << "}";
+    }
+
+    file << "\n  ],\n  \"objects\": [";
+    for (size_t i = 0; i < report.objects.size(); i++)
+    {
+        const auto& object = report.objects[i];
+        file << (i == 0 ? "\n" : ",\n") << R"(    {"id": )" << object.object_id << R"(, "type": )"
+             << static_cast<int>(object.object_type) << R"(, "host_bytes": )" << object.host_bytes << "}";
+    }
+    file << "\n  ]\n}\n";
+
+    if (!file.good())
+    {
+        throw std::runtime_error("Failed to write memory report file: " + path);
+    }
+}
+
+const char* MemoryAccounting::getCategoryName(MemoryCategory category)
+{
+    switch (category)
+    {
+        case MemoryCategory::kObjects: return "Objects";
+        case MemoryCategory::kObjectVertices: return "Object vertices";
+        case MemoryCategory::kObjectIndices: return "Object indices";
+        case MemoryCategory::kRegisteredMeshes: return "Imported and generated meshes";
+        case MemoryCategory::kUndoHistory: return "Undo history";
+        case MemoryCategory::kMeshBuffers: return "Mesh buffers";
+        case MemoryCategory::kMeshBufferFreeSpace: return "Free space in mesh buffers";
+        default: return "Unknown";
+    }
+}
@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "../include/mesh_buffer_cache.h"
+#include "../include/library.h"
+
+
+constexpr size_t MeshBufferCache::kInitialCapacity;
+std::unordered_map<int, MeshBufferCache::Entry> MeshBufferCache::entries_;
+MeshBufferCache::Arena MeshBufferCache::vertex_arena_{GL_ARRAY_BUFFER, 0, BufferAllocator()};
+MeshBufferCache::Arena MeshBufferCache::index_arena_{GL_ELEMENT_ARRAY_BUFFER, 0, BufferAllocator()};
+size_t MeshBufferCache::upload_count_ = 0;
+VertexFormat MeshBufferCache::vertex_format_ = VertexFormat::kFloat;
+
+namespace
+{
+// Largest value of a 16-bit position, the bounds of a mesh are mapped to -kPositionRange...kPositionRange.
+constexpr float kPositionRange = 32767.0f;
+// Positions of VertexFormat::kCompact: x, y, z and padding, so every vertex starts at a multiple of 4 bytes.
+constexpr GLsizei kCompactPositionStride = 4 * sizeof(GLshort);
+}
+
+
+const SharedMeshBuffers* MeshBufferCache::acquire(ObjectType object_type, const MeshView& mesh)
+/** Returns the buffers of the mesh of object_type, uploading the mesh if no Object of this type exists yet. */
+{
+    auto it = entries_.find(object_type);
+    if (it != entries_.end())
+    {
+        it->second.object_count++;
+        return &it->second.buffers;
+    }
+
+    // Elements of unordered_map are never moved, so the returned pointer stays valid until the entry is erased.
+    Entry& entry = entries_[object_type];
+    entry = Entry{};
+    upload_(entry, mesh);
+
+    entry.object_count = 1;
+    upload_count_++;
+    return &entry.buffers;
+}
+
+void MeshBufferCache::upload_(Entry& entry, const MeshView& mesh)
+/** Uploads vertices and indices of a mesh into new ranges of the shared buffers in the current VertexFormat. Compact
+positions are the float positions relative to the center of the bounding box of the mesh, scaled so the box fills
+the range of 16-bit integers; the error is at most half of 1/65534 of the size of the mesh. */
+{
+    auto& buffers = entry.buffers;
+    const size_t vertex_count = mesh.vertices_size / 3;
+    const bool compact = vertex_format_ == VertexFormat::kCompact;
+    const bool short_indices = compact && vertex_count <= 65536;
+
+    const void* vertex_data = mesh.vertices;
+    entry.vertex_byte_size = sizeof(GLfloat) * mesh.vertices_size;
+    std::vector<GLshort> positions;
+    if (compact)
+    {
+        float min[3] = {0.0f, 0.0f, 0.0f}, max[3] = {0.0f, 0.0f, 0.0f};
+        for (size_t i = 0; i < mesh.vertices_size; i++)
+        {
+            int axis = static_cast<int>(i % 3);
+            min[axis] = i < 3 ? mesh.vertices[i] : std::min(min[axis], mesh.vertices[i]);
+            max[axis] = i < 3 ? mesh.vertices[i] : std::max(max[axis], mesh.vertices[i]);
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float half_size = 0.5f * (max[axis] - min[axis]);
+            buffers.position_offset[axis] = 0.5f * (min[axis] + max[axis]);
+            // A flat mesh keeps all its positions at 0 on this axis.
+            buffers.position_scale[axis] = half_size > 0.0f ? half_size / kPositionRange : 1.0f;
+        }
+
+        positions.assign(vertex_count * 4, 0);
+        for (size_t i = 0; i < mesh.vertices_size; i++)
+        {
+            int axis = static_cast<int>(i % 3);
+            float value = (mesh.vertices[i] - buffers.position_offset[axis]) / buffers.position_scale[axis];
+            value = std::min(std::max(value, -kPositionRange), kPositionRange);
+            positions[i / 3 * 4 + axis] = static_cast<GLshort>(std::lround(value));
+        }
+        vertex_data = positions.data();
+        entry.vertex_byte_size = sizeof(GLshort) * positions.size();
+        buffers.position_type = GL_SHORT;
+        buffers.position_stride = kCompactPositionStride;
+    }
+    else
+    {
+        buffers.position_type = GL_FLOAT;
+        buffers.position_stride = 3 * sizeof(GLfloat);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            buffers.position_scale[axis] = 1.0f;
+            buffers.position_offset[axis] = 0.0f;
+        }
+    }
+
+    const void* index_data = mesh.indices;
+    entry.index_byte_size = sizeof(GLuint) * mesh.indices_size;
+    buffers.index_type = GL_UNSIGNED_INT;
+    std::vector<GLushort> short_indices_data;
+    if (short_indices)
+    {
+        short_indices_data.assign(mesh.indices, mesh.indices + mesh.indices_size);
+        index_data = short_indices_data.data();
+        entry.index_byte_size = sizeof(GLushort) * short_indices_data.size();
+        buffers.index_type = GL_UNSIGNED_SHORT;
+    }
+
+    // The buffers are created by the first allocation.
+    buffers.vertex_offset = allocate_(vertex_arena_, entry.vertex_byte_size);
+    buffers.index_offset = allocate_(index_arena_, entry.index_byte_size);
+    buffers.vertex_buffer_object = vertex_arena_.buffer_object;
+    buffers.index_buffer_object = index_arena_.buffer_object;
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_arena_.buffer_object);
+    glBufferSubData(GL_ARRAY_BUFFER, buffers.vertex_offset, entry.vertex_byte_size, vertex_data);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_arena_.buffer_object);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, buffers.index_offset, entry.index_byte_size, index_data);
+
+    entry.float_byte_size = sizeof(GLfloat) * mesh.vertices_size + sizeof(GLuint) * mesh.indices_size;
+}
+
+size_t MeshBufferCache::allocate_(Arena& arena, size_t size)
+/** Returns the offset of a free range of size bytes in arena, growing its buffer if no free block is large enough. */
+{
+    size_t offset = arena.allocator.allocate(size);
+    if (offset != BufferAllocator::kNoSpace)
+    {
+        return offset;
+    }
+    const size_t capacity = arena.allocator.getCapacity();
+    resize_(arena, std::max({kInitialCapacity, 2 * capacity, capacity + BufferAllocator::alignedSize(size)}));
+    return arena.allocator.allocate(size);
+}
+
+void MeshBufferCache::resize_(Arena& arena, size_t capacity)
+/** Makes the buffer of arena larger, keeping its contents and the offsets of its ranges. OpenGL 3.0 can't copy
+between buffers, so the contents are read back and uploaded again; buffers grow by doubling, so it happens only a few
+times however many meshes are added. */
+{
+    std::vector<unsigned char> contents(arena.allocator.getCapacity());
+    if (arena.buffer_object == 0)
+    {
+        glGenBuffers(1, &arena.buffer_object);
+    }
+    glBindBuffer(arena.target, arena.buffer_object);
+    if (!contents.empty())
+    {
+        glGetBufferSubData(arena.target, 0, contents.size(), contents.data());
+    }
+    arena.allocator.grow(capacity);
+    contents.resize(arena.allocator.getCapacity(), 0);
+    // GL_STATIC_DRAW - the data will be set once and used many times for drawing operations.
+    glBufferData(arena.target, contents.size(), contents.data(), GL_STATIC_DRAW);
+}
+
+void MeshBufferCache::setVertexFormat(VertexFormat vertex_format)
+/** Sets the format of mesh buffers and uploads all existing meshes again in it, packed from the start of the same
+buffers. Draw items made before keep the offsets, decoding and index type of the old format and must not be drawn
+afterwards (see Session::setVertexFormat). */
+{
+    if (vertex_format == vertex_format_)
+    {
+        return;
+    }
+    vertex_format_ = vertex_format;
+    // Sizes of all meshes change, so all ranges are given out again.
+    vertex_arena_.allocator.reset(vertex_arena_.allocator.getCapacity());
+    index_arena_.allocator.reset(index_arena_.allocator.getCapacity());
+    for (auto& entry: entries_)
+    {
+        upload_(entry.second, getMeshByType(entry.first));
+        upload_count_++;
+    }
+}
+
+void MeshBufferCache::release(ObjectType object_type)
+/** Called when an Object of object_type is removed; the ranges of the mesh are freed together with the last such
+Object, and the buffers together with the last mesh. */
+{
+    auto it = entries_.find(object_type);
+    if (it == entries_.end())
+    {
+        return;
+    }
+    if (--it->second.object_count > 0)
+    {
+        return;
+    }
+    const auto& entry = it->second;
+    vertex_arena_.allocator.free(entry.buffers.vertex_offset, entry.vertex_byte_size);
+    index_arena_.allocator.free(entry.buffers.index_offset, entry.index_byte_size);
+    entries_.erase(it);
+
+    if (entries_.empty())
+    {
+        for (Arena* arena: {&vertex_arena_, &index_arena_})
+        {
+            glDeleteBuffers(1, &arena->buffer_object);
+            arena->buffer_object = 0;
+            arena->allocator.reset(0);
+        }
+    }
+}
+
+void MeshBufferCache::compact()
+/** Moves all meshes to the start of the buffers, in the order of their offsets, so the free space is one block at the
+end, and shrinks the buffers to the meshes (at least kInitialCapacity). Draw items made before have the old offsets
+and must not be drawn afterwards (see Session::compactMeshBuffers). */
+{
+    compact_(vertex_arena_, true);
+    compact_(index_arena_, false);
+}
+
+void MeshBufferCache::compact_(Arena& arena, bool vertices)
+{
+    if (arena.buffer_object == 0)
+    {
+        return;
+    }
+    std::vector<Entry*> placed;
+    for (auto& entry: entries_)
+    {
+        placed.push_back(&entry.second);
+    }
+    auto offset_of = [vertices](const Entry* entry) {
+        return vertices ? entry->buffers.vertex_offset : entry->buffers.index_offset;
+    };
+    std::sort(placed.begin(), placed.end(), [&offset_of](const Entry* a, const Entry* b) {
+        return offset_of(a) < offset_of(b);
+    });
+
+    std::vector<unsigned char> contents(arena.allocator.getCapacity());
+    glBindBuffer(arena.target, arena.buffer_object);
+    glGetBufferSubData(arena.target, 0, contents.size(), contents.data());
+
+    arena.allocator.reset(std::max(kInitialCapacity, arena.allocator.getUsedBytes()));
+    std::vector<unsigned char> packed(arena.allocator.getCapacity(), 0);
+    for (Entry* entry: placed)
+    {
+        size_t& offset = vertices ? entry->buffers.vertex_offset : entry->buffers.index_offset;
+        size_t size = vertices ? entry->vertex_byte_size : entry->index_byte_size;
+        size_t new_offset = arena.allocator.allocate(size);
+        std::copy_n(contents.begin() + offset, size, packed.begin() + new_offset);
+        offset = new_offset;
+    }
+    glBufferData(arena.target, packed.size(), packed.data(), GL_STATIC_DRAW);
+}
+
+size_t MeshBufferCache::getByteSize(ObjectType object_type)
+/** Size of the vertices and indices of object_type in the shared buffers, 0 if no Object of this type exists. */
+{
+    auto it = entries_.find(object_type);
+    return it != entries_.end() ? it->second.vertex_byte_size + it->second.index_byte_size : 0;
+}
+
+size_t MeshBufferCache::getFloatByteSize(ObjectType object_type)
+/** Size that the vertices and indices of object_type have with VertexFormat::kFloat, to compare with
+getByteSize; 0 if no Object of this type exists. */
+{
+    auto it = entries_.find(object_type);
+    return it != entries_.end() ? it->second.float_byte_size : 0;
+}
+
+MeshBufferStats MeshBufferCache::getStats()
+{
+    MeshBufferStats stats{entries_.size(), 0, upload_count_, 0, 0, 0, 0, 0, 0};
+    for (const auto& entry: entries_)
+    {
+        stats.object_count += entry.second.object_count;
+        stats.byte_size += entry.second.vertex_byte_size + entry.second.index_byte_size;
+        stats.float_byte_size += entry.second.float_byte_size;
+    }
+    for (const Arena* arena: {&vertex_arena_, &index_arena_})
+    {
+        const auto& allocator = arena->allocator;
+        stats.buffer_capacity += allocator.getCapacity();
+        stats.free_bytes += allocator.getCapacity() - allocator.getUsedBytes();
+        stats.free_block_count += allocator.getFreeBlockCount();
+        stats.largest_free_block = std::max(stats.largest_free_block, allocator.getLargestFreeBlock());
+    }
+    return stats;
+}
@@ -0,0 +1,881 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "../include/mesh_importer.h"
+#include "../include/mapped_file.h"
+#include "../include/trace.h"
+
+
+namespace
+{
+// Text ranges smaller than this are parsed in a single thread, because starting threads costs more than parsing.
+constexpr size_t kMinChunkSize = 1 << 20;
+
+struct TextChunk
+{
+    const char* begin;
+    const char* end;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Function>
+void runParallel(size_t task_count, Function function)
+/* Runs function(task_id) for every task, each task in its own thread. The first task runs in the calling thread. */
+{
+    std::vector<std::thread> threads;
+    threads.reserve(task_count);
+    auto traced_function = [&function](size_t task_id) {
+        PROJECT_1_TRACE_ZONE("MeshImporter task");
+        function(task_id);
+    };
+    for (size_t task_id = 1; task_id < task_count; task_id++)
+    {
+        threads.emplace_back(traced_function, task_id);
+    }
+    if (task_count > 0)
+    {
+        traced_function(0);
+    }
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+}
+
+std::vector<TextChunk> splitIntoLineChunks(const char* begin, const char* end, unsigned max_chunks)
+/* Splits text into at most max_chunks ranges of similar size. Every range ends right after a new line,
+so no line is split between two chunks. */
+{
+    size_t size = static_cast<size_t>(end - begin);
+    size_t chunk_count = std::max<size_t>(1, std::min<size_t>(max_chunks, size / kMinChunkSize));
+    std::vector<TextChunk> chunks;
+
+    const char* chunk_begin = begin;
+    for (size_t i = 1; i <= chunk_count && chunk_begin < end; i++)
+    {
+        const char* chunk_end = i == chunk_count ? end : begin + size * i / chunk_count;
+        if (chunk_end < chunk_begin)
+        {
+            chunk_end = chunk_begin;
+        }
+        const char* new_line = static_cast<const char*>(std::memchr(chunk_end, '\n', static_cast<size_t>(end - chunk_end)));
+        chunk_end = (new_line == nullptr || i == chunk_count) ? end : new_line + 1;
+        chunks.push_back({chunk_begin, chunk_end});
+        chunk_begin = chunk_end;
+    }
+    return chunks;
+}
+
+const char* skipSpaces(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    {
+        p++;
+    }
+    return p;
+}
+
+const char* nextLine(const char* p, const char* end)
+{
+    const char* new_line = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    return new_line == nullptr ? end : new_line + 1;
+}
+
+bool startsWith(const char* p, const char* end, const char* word)
+{
+    size_t length = std::strlen(word);
+    return static_cast<size_t>(end - p) >= length && std::memcmp(p, word, length) == 0;
+}
+
+bool parseFloat(const char*& p, const char* end, float& value)
+/* Parses a decimal floating point number ([+-]digits[.digits][(e|E)[+-]digits]) and moves p after it.
+Digits are accumulated in a 64-bit integer and scaled by a power of ten once, which is much faster than strtof
+and precise enough for vertex coordinates. */
+{
+    static const double kPowersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    p = skipSpaces(p, end);
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digit_count = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        if (mantissa < 100000000000000000ULL) {mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');}
+        else {exponent++;}
+        digit_count++;
+        p++;
+    }
+    if (p < end && *p == '.')
+    {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            if (mantissa < 100000000000000000ULL)
+            {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                exponent--;
+            }
+            digit_count++;
+            p++;
+        }
+    }
+    if (digit_count == 0)
+    {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative_exponent = *p == '-';
+            p++;
+        }
+        int explicit_exponent = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            if (explicit_exponent < 10000) {explicit_exponent = explicit_exponent * 10 + (*p - '0');}
+            p++;
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    double result = static_cast<double>(mantissa);
+    while (exponent > 22) {result *= 1e22; exponent -= 22;}
+    while (exponent < -22) {result /= 1e22; exponent += 22;}
+    result = exponent >= 0 ? result * kPowersOfTen[exponent] : result / kPowersOfTen[-exponent];
+
+    value = static_cast<float>(negative ? -result : result);
+    return true;
+}
+
+bool parseInt(const char*& p, const char* end, long long& value)
+/* Parses a decimal integer with an optional sign and moves p after it. */
+{
+    p = skipSpaces(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+    if (p >= end || *p < '0' || *p > '9')
+    {
+        return false;
+    }
+    long long result = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        result = result * 10 + (*p - '0');
+        p++;
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+void appendTriangleFan(const std::vector<long long>& polygon, std::vector<long long>& indices)
+/* Splits a convex polygon into triangles that share its first vertex. */
+{
+    for (size_t i = 2; i < polygon.size(); i++)
+    {
+        indices.push_back(polygon[0]);
+        indices.push_back(polygon[i - 1]);
+        indices.push_back(polygon[i]);
+    }
+}
+
+void checkedAppendIndices(const std::vector<long long>& source, size_t vertex_count, std::vector<GLuint>& target)
+{
+    for (auto index: source)
+    {
+        if (index < 0 || static_cast<size_t>(index) >= vertex_count)
+        {
+            throw std::runtime_error("Mesh file references a vertex that doesn't exist.");
+        }
+        target.push_back(static_cast<GLuint>(index));
+    }
+}
+
+// PLY property types and their sizes in binary files.
+struct PlyProperty
+{
+    std::string name;
+    int size{0};
+    bool is_float{false};
+    bool is_signed{false};
+    bool is_list{false};
+    int list_count_size{0};
+    bool list_count_signed{false};
+};
+
+struct PlyElement
+{
+    std::string name;
+    size_t count{0};
+    std::vector<PlyProperty> properties;
+};
+
+void plyType(const std::string& type_name, int& size, bool& is_float, bool& is_signed)
+{
+    is_float = false;
+    is_signed = false;
+    if (type_name == "char" || type_name == "int8") {size = 1; is_signed = true;}
+    else if (type_name == "uchar" || type_name == "uint8") {size = 1;}
+    else if (type_name == "short" || type_name == "int16") {size = 2; is_signed = true;}
+    else if (type_name == "ushort" || type_name == "uint16") {size = 2;}
+    else if (type_name == "int" || type_name == "int32") {size = 4; is_signed = true;}
+    else if (type_name == "uint" || type_name == "uint32") {size = 4;}
+    else if (type_name == "float" || type_name == "float32") {size = 4; is_float = true;}
+    else if (type_name == "double" || type_name == "float64") {size = 8; is_float = true;}
+    else {throw std::runtime_error("PLY file uses unknown property type " + type_name + ".");}
+}
+
+double readBinaryValue(const unsigned char* data, int size, bool is_float, bool is_signed)
+/* Reads a little-endian value of a PLY property type. */
+{
+    if (is_float)
+    {
+        if (size == 4) {float value; std::memcpy(&value, data, 4); return value;}
+        double value; std::memcpy(&value, data, 8); return value;
+    }
+    uint32_t value = 0;
+    std::memcpy(&value, data, static_cast<size_t>(size));
+    if (is_signed)
+    {
+        if (size == 1) {return static_cast<int8_t>(value);}
+        if (size == 2) {return static_cast<int16_t>(value);}
+        return static_cast<int32_t>(value);
+    }
+    return value;
+}
+
+std::string nextWord(const char*& p, const char* end)
+{
+    p = skipSpaces(p, end);
+    const char* word_begin = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+    {
+        p++;
+    }
+    return {word_begin, static_cast<size_t>(p - word_begin)};
+}
+}
+
+
+MeshImporter::MeshImporter(float weld_epsilon, unsigned thread_count) : weld_epsilon_(weld_epsilon), thread_count_(thread_count)
+{
+    if (thread_count_ == 0)
+    {
+        thread_count_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+Polyhedron MeshImporter::importFile(const std::string& file_path)
+/** Reads a mesh file, selects a parser by file extension, welds duplicated vertices and returns a normalized mesh.
+Time of every stage is saved in stats (see getStats). */
+{
+    PROJECT_1_TRACE_ZONE("MeshImporter::importFile");
+    stats_ = MeshImportStats();
+    stats_.thread_count = thread_count_;
+
+    std::string extension = file_path.substr(file_path.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    auto start_time = std::chrono::steady_clock::now();
+    MappedFile file(file_path);
+    stats_.file_size = file.size();
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    const char* end = begin + file.size();
+
+    RawMesh raw_mesh;
+    if (extension == "obj") {raw_mesh = parseObj_(begin, end);}
+    else if (extension == "stl") {raw_mesh = parseStl_(begin, end);}
+    else if (extension == "ply") {raw_mesh = parsePly_(begin, end);}
+    else {throw std::runtime_error("Mesh format ." + extension + " is not supported (use obj, ply or stl).");}
+    stats_.parse_seconds = secondsSince(start_time);
+    stats_.parsed_vertex_count = raw_mesh.positions.size() / 3;
+
+    start_time = std::chrono::steady_clock::now();
+    Polyhedron mesh = weld_(raw_mesh);
+    normalize_(mesh);
+    stats_.weld_seconds = secondsSince(start_time);
+    stats_.welded_vertex_count = mesh.vertices.size() / 3;
+    stats_.triangle_count = mesh.indices.size() / 3;
+
+    if (mesh.indices.empty())
+    {
+        throw std::runtime_error("Mesh file " + file_path + " doesn't contain any triangles.");
+    }
+    return mesh;
+}
+
+MeshImporter::RawMesh MeshImporter::parseObj_(const char* begin, const char* end) const
+/** Parses 'v' and 'f' lines of a Wavefront OBJ file. Faces with more than 3 vertices are split into triangles,
+texture and normal indices (f v/vt/vn) are ignored. Negative (relative) indices refer to vertices read before the
+face, which can be in a previous chunk, so they are resolved after all chunks are parsed. */
+{
+    // Relative indices are stored with this offset added, so they can be told apart from absolute ones.
+    constexpr long long kRelativeIndex = 1LL << 62;
+
+    struct ObjChunk
+    {
+        std::vector<GLfloat> positions;
+        std::vector<long long> indices;
+    };
+
+    auto chunks = splitIntoLineChunks(begin, end, thread_count_);
+    std::vector<ObjChunk> results(chunks.size());
+
+    runParallel(chunks.size(), [&](size_t chunk_id) {
+        auto& result = results[chunk_id];
+        std::vector<long long> polygon;
+        const char* p = chunks[chunk_id].begin;
+        const char* chunk_end = chunks[chunk_id].end;
+
+        while (p < chunk_end)
+        {
+            const char* line_end = nextLine(p, chunk_end);
+            p = skipSpaces(p, line_end);
+
+            if (line_end - p > 2 && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+            {
+                p++;
+                float x, y, z;
+                if (parseFloat(p, line_end, x) && parseFloat(p, line_end, y) && parseFloat(p, line_end, z))
+                {
+                    result.positions.push_back(x);
+                    result.positions.push_back(y);
+                    result.positions.push_back(z);
+                }
+            }
+            else if (line_end - p > 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+            {
+                p++;
+                polygon.clear();
+                long long index;
+                while (parseInt(p, line_end, index))
+                {
+                    long long local_vertex_count = static_cast<long long>(result.positions.size() / 3);
+                    polygon.push_back(index > 0 ? index - 1 : kRelativeIndex + local_vertex_count + index);
+                    // Skip texture and normal indices of the vertex.
+                    while (p < line_end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+                    {
+                        p++;
+                    }
+                }
+                appendTriangleFan(polygon, result.indices);
+            }
+            p = line_end;
+        }
+    });
+
+    RawMesh raw_mesh;
+    size_t vertex_count = 0;
+    for (const auto& result: results)
+    {
+        vertex_count += result.positions.size() / 3;
+    }
+    raw_mesh.positions.reserve(vertex_count * 3);
+
+    size_t vertex_offset = 0;
+    for (auto& result: results)
+    {
+        raw_mesh.positions.insert(raw_mesh.positions.end(), result.positions.begin(), result.positions.end());
+        for (auto& index: result.indices)
+        {
+            if (index >= kRelativeIndex / 2)
+            {
+                index = index - kRelativeIndex + static_cast<long long>(vertex_offset);
+            }
+        }
+        checkedAppendIndices(result.indices, vertex_count, raw_mesh.indices);
+        vertex_offset += result.positions.size() / 3;
+    }
+    return raw_mesh;
+}
+
+MeshImporter::RawMesh MeshImporter::parseStl_(const char* begin, const char* end) const
+/** Parses binary and ascii STL files. STL stores 3 vertices per triangle without indices, so duplicated vertices are
+merged later by welding. Binary triangles have a fixed size and are split between threads by count, ascii files
+are split by lines. */
+{
+    RawMesh raw_mesh;
+    size_t size = static_cast<size_t>(end - begin);
+
+    uint32_t binary_triangle_count = 0;
+    if (size >= 84)
+    {
+        std::memcpy(&binary_triangle_count, begin + 80, sizeof(binary_triangle_count));
+    }
+    // A binary file has an 80-byte header, a triangle count and 50 bytes per triangle. Some binary files start with
+    // "solid" too, so the size is the reliable check.
+    bool is_binary = size >= 84 && size == 84 + 50 * static_cast<size_t>(binary_triangle_count);
+
+    if (is_binary)
+    {
+        raw_mesh.positions.resize(static_cast<size_t>(binary_triangle_count) * 9);
+        size_t task_count = std::max<size_t>(1, std::min<size_t>(thread_count_, size / kMinChunkSize));
+
+        runParallel(task_count, [&](size_t task_id) {
+            size_t first = binary_triangle_count * task_id / task_count;
+            size_t last = binary_triangle_count * (task_id + 1) / task_count;
+            for (size_t triangle = first; triangle < last; triangle++)
+            {
+                // Every triangle is a normal (3 floats), 3 vertices (9 floats) and 2 bytes of attributes.
+                std::memcpy(&raw_mesh.positions[triangle * 9], begin + 84 + triangle * 50 + 12, 9 * sizeof(float));
+            }
+        });
+    }
+    else
+    {
+        if (!startsWith(skipSpaces(begin, end), end, "solid"))
+        {
+            throw std::runtime_error("STL file is neither binary nor ascii.");
+        }
+        auto chunks = splitIntoLineChunks(begin, end, thread_count_);
+        std::vector<std::vector<GLfloat>> results(chunks.size());
+
+        runParallel(chunks.size(), [&](size_t chunk_id) {
+            const char* p = chunks[chunk_id].begin;
+            const char* chunk_end = chunks[chunk_id].end;
+            while (p < chunk_end)
+            {
+                const char* line_end = nextLine(p, chunk_end);
+                p = skipSpaces(p, line_end);
+                if (startsWith(p, line_end, "vertex"))
+                {
+                    p += 6;
+                    float x, y, z;
+                    if (parseFloat(p, line_end, x) && parseFloat(p, line_end, y) && parseFloat(p, line_end, z))
+                    {
+                        results[chunk_id].insert(results[chunk_id].end(), {x, y, z});
+                    }
+                }
+                p = line_end;
+            }
+        });
+        for (const auto& result: results)
+        {
+            raw_mesh.positions.insert(raw_mesh.positions.end(), result.begin(), result.end());
+        }
+        // Vertices of an incomplete last triangle are dropped.
+        raw_mesh.positions.resize(raw_mesh.positions.size() / 9 * 9);
+    }
+
+    raw_mesh.indices.resize(raw_mesh.positions.size() / 3);
+    for (size_t i = 0; i < raw_mesh.indices.size(); i++)
+    {
+        raw_mesh.indices[i] = static_cast<GLuint>(i);
+    }
+    return raw_mesh;
+}
+
+MeshImporter::RawMesh MeshImporter::parsePly_(const char* begin, const char* end) const
+/** Parses ascii and binary little-endian PLY files with 'vertex' (x, y, z properties) and 'face' (list of vertex
+indices) elements. Other elements are skipped. Vertices are parsed in parallel: binary records have a fixed size,
+ascii records are one line each. */
+{
+    const char* p = begin;
+    const char* line_end = nextLine(p, end);
+    if (!startsWith(p, line_end, "ply"))
+    {
+        throw std::runtime_error("PLY file doesn't start with 'ply'.");
+    }
+
+    // Header
+    bool is_binary = false;
+    std::vector<PlyElement> elements;
+    p = line_end;
+    while (true)
+    {
+        if (p >= end)
+        {
+            throw std::runtime_error("PLY header is not terminated with 'end_header'.");
+        }
+        line_end = nextLine(p, end);
+        std::string keyword = nextWord(p, line_end);
+
+        if (keyword == "format")
+        {
+            std::string format = nextWord(p, line_end);
+            if (format == "binary_little_endian") {is_binary = true;}
+            else if (format != "ascii") {throw std::runtime_error("PLY format " + format + " is not supported.");}
+        }
+        else if (keyword == "element")
+        {
+            PlyElement element;
+            element.name = nextWord(p, line_end);
+            long long count = 0;
+            if (!parseInt(p, line_end, count) || count < 0)
+            {
+                throw std::runtime_error("PLY element " + element.name + " has no count.");
+            }
+            element.count = static_cast<size_t>(count);
+            elements.push_back(element);
+        }
+        else if (keyword == "property")
+        {
+            if (elements.empty())
+            {
+                throw std::runtime_error("PLY property is defined before any element.");
+            }
+            PlyProperty property;
+            std::string type_name = nextWord(p, line_end);
+            if (type_name == "list")
+            {
+                property.is_list = true;
+                bool is_float;
+                plyType(nextWord(p, line_end), property.list_count_size, is_float, property.list_count_signed);
+                type_name = nextWord(p, line_end);
+            }
+            plyType(type_name, property.size, property.is_float, property.is_signed);
+            property.name = nextWord(p, line_end);
+            elements.back().properties.push_back(property);
+        }
+        else if (keyword == "end_header")
+        {
+            p = line_end;
+            break;
+        }
+        p = line_end;
+    }
+
+    RawMesh raw_mesh;
+    std::vector<long long> indices;
+    std::vector<long long> polygon;
+
+    for (const auto& element: elements)
+    {
+        bool is_vertex = element.name == "vertex";
+        bool is_face = element.name == "face";
+
+        // Position of x, y, z (and vertex_indices for faces) among properties.
+        int coordinate_property[3] = {-1, -1, -1};
+        int index_property = -1;
+        for (size_t i = 0; i < element.properties.size(); i++)
+        {
+            const auto& name = element.properties[i].name;
+            if (name == "x") {coordinate_property[0] = static_cast<int>(i);}
+            if (name == "y") {coordinate_property[1] = static_cast<int>(i);}
+            if (name == "z") {coordinate_property[2] = static_cast<int>(i);}
+            if (element.properties[i].is_list && (name == "vertex_indices" || name == "vertex_index")) {index_property = static_cast<int>(i);}
+        }
+        if (is_vertex && (coordinate_property[0] < 0 || coordinate_property[1] < 0 || coordinate_property[2] < 0))
+        {
+            throw std::runtime_error("PLY vertex element has no x, y, z properties.");
+        }
+
+        bool has_lists = std::any_of(element.properties.begin(), element.properties.end(),
+                                     [](const PlyProperty& property){return property.is_list;});
+
+        if (is_vertex)
+        {
+            raw_mesh.positions.resize(element.count * 3);
+        }
+
+        if (is_binary && !has_lists)
+        {
+            // Fixed-size records: offsets of properties are the same for every record.
+            size_t stride = 0;
+            std::vector<size_t> offsets;
+            for (const auto& property: element.properties)
+            {
+                offsets.push_back(stride);
+                stride += static_cast<size_t>(property.size);
+            }
+            if (static_cast<size_t>(end - p) < stride * element.count)
+            {
+                throw std::runtime_error("PLY file is truncated.");
+            }
+            if (is_vertex)
+            {
+                const auto* data = reinterpret_cast<const unsigned char*>(p);
+                size_t task_count = std::max<size_t>(1, std::min<size_t>(thread_count_, stride * element.count / kMinChunkSize));
+                runParallel(task_count, [&](size_t task_id) {
+                    size_t first = element.count * task_id / task_count;
+                    size_t last = element.count * (task_id + 1) / task_count;
+                    for (size_t vertex = first; vertex < last; vertex++)
+                    {
+                        for (int axis = 0; axis < 3; axis++)
+                        {
+                            const auto& property = element.properties[coordinate_property[axis]];
+                            raw_mesh.positions[vertex * 3 + axis] = static_cast<GLfloat>(readBinaryValue(
+                                    data + vertex * stride + offsets[coordinate_property[axis]],
+                                    property.size, property.is_float, property.is_signed));
+                        }
+                    }
+                });
+            }
+            p += stride * element.count;
+        }
+        else if (is_binary)
+        {
+            // Records with lists have a variable size, so they are read sequentially.
+            const auto* data = reinterpret_cast<const unsigned char*>(p);
+            const auto* data_end = reinterpret_cast<const unsigned char*>(end);
+            for (size_t record = 0; record < element.count; record++)
+            {
+                for (size_t i = 0; i < element.properties.size(); i++)
+                {
+                    const auto& property = element.properties[i];
+                    if (!property.is_list)
+                    {
+                        if (data + property.size > data_end) {throw std::runtime_error("PLY file is truncated.");}
+                        for (int axis = 0; is_vertex && axis < 3; axis++)
+                        {
+                            if (coordinate_property[axis] == static_cast<int>(i))
+                            {
+                                raw_mesh.positions[record * 3 + axis] = static_cast<GLfloat>(readBinaryValue(
+                                        data, property.size, property.is_float, property.is_signed));
+                            }
+                        }
+                        data += property.size;
+                        continue;
+                    }
+                    if (data + property.list_count_size > data_end) {throw std::runtime_error("PLY file is truncated.");}
+                    auto count = static_cast<size_t>(readBinaryValue(data, property.list_count_size, false, property.list_count_signed));
+                    data += property.list_count_size;
+                    if (data + count * property.size > data_end) {throw std::runtime_error("PLY file is truncated.");}
+
+                    if (is_face && static_cast<int>(i) == index_property)
+                    {
+                        polygon.clear();
+                        for (size_t k = 0; k < count; k++)
+                        {
+                            polygon.push_back(static_cast<long long>(readBinaryValue(data + k * property.size, property.size,
+                                                                                     property.is_float, property.is_signed)));
+                        }
+                        appendTriangleFan(polygon, indices);
+                    }
+                    data += count * property.size;
+                }
+            }
+            p = reinterpret_cast<const char*>(data);
+        }
+        else
+        {
+            // Ascii: every record is a line. The end of the element is found first, then the lines are split
+            // between threads.
+            const char* element_begin = p;
+            for (size_t record = 0; record < element.count; record++)
+            {
+                if (p >= end) {throw std::runtime_error("PLY file is truncated.");}
+                p = nextLine(p, end);
+            }
+            if (!is_vertex && !is_face)
+            {
+                continue;
+            }
+
+            auto chunks = splitIntoLineChunks(element_begin, p, thread_count_);
+            std::vector<size_t> first_record(chunks.size(), 0);
+            for (size_t chunk_id = 1; chunk_id < chunks.size(); chunk_id++)
+            {
+                size_t lines = 0;
+                for (const char* c = chunks[chunk_id - 1].begin; c < chunks[chunk_id - 1].end; c = nextLine(c, chunks[chunk_id - 1].end))
+                {
+                    lines++;
+                }
+                first_record[chunk_id] = first_record[chunk_id - 1] + lines;
+            }
+            std::vector<std::vector<long long>> chunk_indices(chunks.size());
+
+            runParallel(chunks.size(), [&](size_t chunk_id) {
+                std::vector<long long> chunk_polygon;
+                size_t record = first_record[chunk_id];
+                const char* c = chunks[chunk_id].begin;
+                while (c < chunks[chunk_id].end)
+                {
+                    const char* record_end = nextLine(c, chunks[chunk_id].end);
+                    for (size_t i = 0; i < element.properties.size(); i++)
+                    {
+                        const auto& property = element.properties[i];
+                        if (property.is_list)
+                        {
+                            long long count = 0;
+                            parseInt(c, record_end, count);
+                            chunk_polygon.clear();
+                            for (long long k = 0; k < count; k++)
+                            {
+                                float value = 0;
+                                parseFloat(c, record_end, value);
+                                chunk_polygon.push_back(static_cast<long long>(value));
+                            }
+                            if (is_face && static_cast<int>(i) == index_property)
+                            {
+                                appendTriangleFan(chunk_polygon, chunk_indices[chunk_id]);
+                            }
+                            continue;
+                        }
+                        float value = 0;
+                        parseFloat(c, record_end, value);
+                        if (is_vertex)
+                        {
+                            for (int axis = 0; axis < 3; axis++)
+                            {
+                                if (coordinate_property[axis] == static_cast<int>(i))
+                                {
+                                    raw_mesh.positions[record * 3 + axis] = value;
+                                }
+                            }
+                        }
+                    }
+                    record++;
+                    c = record_end;
+                }
+            });
+            for (const auto& chunk: chunk_indices)
+            {
+                indices.insert(indices.end(), chunk.begin(), chunk.end());
+            }
+        }
+    }
+
+    checkedAppendIndices(indices, raw_mesh.positions.size() / 3, raw_mesh.indices);
+    return raw_mesh;
+}
+
+Polyhedron MeshImporter::weld_(const RawMesh& raw_mesh) const
+/** Merges vertices that are closer than weld_epsilon_ and re-maps indices to the merged vertices.
+Vertices are put into a hash grid with cells of weld_epsilon_ size; a vertex can only be merged with vertices
+from its own or 26 neighbouring cells. Triangles that become degenerate after welding are dropped. */
+{
+    size_t vertex_count = raw_mesh.positions.size() / 3;
+    float cell_size = weld_epsilon_ > 0 ? weld_epsilon_ : 1e-6f;
+    float epsilon_squared = weld_epsilon_ * weld_epsilon_;
+
+    // Open addressing table of cells. Every cell keeps the first welded vertex in it, the rest are chained in next.
+    struct Cell
+    {
+        int64_t x, y, z;
+        int32_t first_vertex;
+    };
+    size_t capacity = 16;
+    while (capacity < vertex_count * 2)
+    {
+        capacity *= 2;
+    }
+    std::vector<Cell> cells(capacity, Cell{0, 0, 0, -1});
+    std::vector<int32_t> next_in_cell;
+    next_in_cell.reserve(vertex_count);
+
+    auto find_slot = [&](int64_t x, int64_t y, int64_t z) {
+        uint64_t hash = static_cast<uint64_t>(x) * 73856093ULL ^ static_cast<uint64_t>(y) * 19349663ULL ^ static_cast<uint64_t>(z) * 83492791ULL;
+        size_t slot = static_cast<size_t>(hash) & (capacity - 1);
+        while (cells[slot].first_vertex >= 0 && (cells[slot].x != x || cells[slot].y != y || cells[slot].z != z))
+        {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        return slot;
+    };
+
+    Polyhedron mesh;
+    mesh.vertices.reserve(raw_mesh.positions.size());
+    std::vector<GLuint> remap(vertex_count);
+
+    for (size_t vertex = 0; vertex < vertex_count; vertex++)
+    {
+        const GLfloat* position = &raw_mesh.positions[vertex * 3];
+        auto cell_x = static_cast<int64_t>(std::floor(position[0] / cell_size));
+        auto cell_y = static_cast<int64_t>(std::floor(position[1] / cell_size));
+        auto cell_z = static_cast<int64_t>(std::floor(position[2] / cell_size));
+
+        int32_t match = -1;
+        for (int dx = -1; dx <= 1 && match < 0; dx++)
+        {
+            for (int dy = -1; dy <= 1 && match < 0; dy++)
+            {
+                for (int dz = -1; dz <= 1 && match < 0; dz++)
+                {
+                    size_t slot = find_slot(cell_x + dx, cell_y + dy, cell_z + dz);
+                    for (int32_t candidate = cells[slot].first_vertex; candidate >= 0; candidate = next_in_cell[candidate])
+                    {
+                        const GLfloat* other = &mesh.vertices[static_cast<size_t>(candidate) * 3];
+                        float distance_x = position[0] - other[0];
+                        float distance_y = position[1] - other[1];
+                        float distance_z = position[2] - other[2];
+                        if (distance_x * distance_x + distance_y * distance_y + distance_z * distance_z <= epsilon_squared)
+                        {
+                            match = candidate;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (match < 0)
+        {
+            match = static_cast<int32_t>(mesh.vertices.size() / 3);
+            mesh.vertices.insert(mesh.vertices.end(), position, position + 3);
+
+            size_t slot = find_slot(cell_x, cell_y, cell_z);
+            cells[slot].x = cell_x;
+            cells[slot].y = cell_y;
+            cells[slot].z = cell_z;
+            next_in_cell.push_back(cells[slot].first_vertex);
+            cells[slot].first_vertex = match;
+        }
+        remap[vertex] = static_cast<GLuint>(match);
+    }
+
+    mesh.indices.reserve(raw_mesh.indices.size());
+    for (size_t i = 0; i + 2 < raw_mesh.indices.size(); i += 3)
+    {
+        GLuint a = remap[raw_mesh.indices[i]];
+        GLuint b = remap[raw_mesh.indices[i + 1]];
+        GLuint c = remap[raw_mesh.indices[i + 2]];
+        if (a != b && b != c && a != c)
+        {
+            mesh.indices.insert(mesh.indices.end(), {a, b, c});
+        }
+    }
+    return mesh;
+}
+
+void MeshImporter::normalize_(Polyhedron& mesh)
+/** Moves the mesh to the origin and scales it so that its largest side is 1, the size of the built-in cube.
+Scanned meshes come in arbitrary units and positions. */
+{
+    if (mesh.vertices.empty())
+    {
+        return;
+    }
+    float min[3] = {mesh.vertices[0], mesh.vertices[1], mesh.vertices[2]};
+    float max[3] = {min[0], min[1], min[2]};
+    for (size_t i = 0; i < mesh.vertices.size(); i += 3)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            min[axis] = std::min(min[axis], mesh.vertices[i + axis]);
+            max[axis] = std::max(max[axis], mesh.vertices[i + axis]);
+        }
+    }
+    float largest_side = std::max({max[0] - min[0], max[1] - min[1], max[2] - min[2]});
+    float scale = largest_side > 0 ? 1.0f / largest_side : 1.0f;
+
+    for (size_t i = 0; i < mesh.vertices.size(); i += 3)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            mesh.vertices[i + axis] = (mesh.vertices[i + axis] - (min[axis] + max[axis]) / 2) * scale;
+        }
+    }
+}
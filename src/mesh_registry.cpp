@@ -0,0 +1,56 @@
+#include <stdexcept>
+
+#include "../include/mesh_registry.h"
+
+
+std::vector<MeshRegistry::Entry> MeshRegistry::meshes_;
+
+ObjectType MeshRegistry::registerMesh(const std::string& name, Polyhedron mesh)
+/** Adds a mesh to the registry and returns the ObjectType id assigned to it. */
+{
+    if (mesh.vertices.empty() || mesh.indices.empty())
+    {
+        throw std::runtime_error("Mesh " + name + " is empty and can't be registered.");
+    }
+    meshes_.push_back({name, std::move(mesh)});
+    return static_cast<ObjectType>(kBuiltinObjectTypeCount + meshes_.size() - 1);
+}
+
+bool MeshRegistry::contains(int type_id)
+/** Checks if the id belongs to a registered mesh. */
+{
+    return type_id >= kBuiltinObjectTypeCount && type_id - kBuiltinObjectTypeCount < static_cast<int>(meshes_.size());
+}
+
+const Polyhedron& MeshRegistry::getMesh(ObjectType object_type)
+/** Returns a registered mesh by its ObjectType id. */
+{
+    if (!contains(object_type))
+    {
+        throw std::runtime_error("Object type " + std::to_string(object_type) + " is not registered.");
+    }
+    return meshes_[object_type - kBuiltinObjectTypeCount].mesh;
+}
+
+const std::string& MeshRegistry::getName(ObjectType object_type)
+/** Returns the name of a registered mesh by its ObjectType id. */
+{
+    if (!contains(object_type))
+    {
+        throw std::runtime_error("Object type " + std::to_string(object_type) + " is not registered.");
+    }
+    return meshes_[object_type - kBuiltinObjectTypeCount].name;
+}
+
+int MeshRegistry::findByName(const std::string& name)
+/** Returns ObjectType id of a registered mesh with the given name or -1 if there is no such mesh. */
+{
+    for (size_t i = 0; i < meshes_.size(); i++)
+    {
+        if (meshes_[i].name == name)
+        {
+            return static_cast<int>(kBuiltinObjectTypeCount + i);
+        }
+    }
+    return -1;
+}
@@ -1,13 +1,26 @@
 #include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
 #include <tuple>
 #include <cstring>
 
 #include "../include/object.h"
 #include "../include/config.h"
 #include "../include/library.h"
+#include "../include/mesh_registry.h"
+#include "../include/mesh_buffer_cache.h"
+#include "../include/occlusion_culler.h"
 #include "../include/font.h"
 
-Object::Object(int id, int pick_id, ObjectType object_type, GLfloat r, GLfloat g, GLfloat b, GLubyte pick_r, GLubyte pick_g, GLubyte pick_b): id_(id), pick_id_(pick_id), object_type_(object_type) {
+Object::Object(int id, int pick_id, ObjectType object_type, GLfloat r, GLfloat g, GLfloat b, GLubyte pick_r, GLubyte pick_g, GLubyte pick_b):
+        Object(id, pick_id, object_type, r, g, b, pick_r, pick_g, pick_b, summarizeMesh(object_type)) {}
+
+Object::Object(int id, int pick_id, ObjectType object_type, GLfloat r, GLfloat g, GLfloat b, GLubyte pick_r,
+               GLubyte pick_g, GLubyte pick_b, const MeshSummary& mesh_summary):
+        id_(id), pick_id_(pick_id), object_type_(object_type)
+/** Creates an Object with the summary of its mesh made before (see summarizeMesh), so Objects of one type created
+together go through the mesh only once (see Session::addObjects). */
+{
     // By default, an Object is drawn filled with color, therefore uses parameter GL_FILL.
     polygon_mode_ = kPolygonModeFill;
 
@@ -18,149 +31,255 @@ Object::Object(int id, int pick_id, ObjectType object_type, GLfloat r, GLfloat g
     rgb_[1] = g;
     rgb_[2] = b;
 
-    // glGenBuffers generates buffers for later rendering.
-    // A buffer in OpenGL is, at its core, an object that manages a certain piece of GPU memory.
-    // In this project an Object is drawn without lighting, otherwise an additional buffer for normals is needed.
-    // This data can be vertex coordinates, indices, texture coordinates, normals, colors, etc.
-    glGenBuffers(1, &vertex_buffer_object_);
-    glGenBuffers(1, &index_buffer_object_);
-    glGenBuffers(1, &color_buffer_object_);
-    glGenBuffers(1, &pick_color_buffer_object_);
-
-    // Get a struct with vertices and indices from library.h.
-    Polyhedron object_sample = getPolyhedronByType(object_type);
-
-    // Every coordinate (x, y, z) of a vertex needs to have corresponding rgb values.
-    // A vector and buffer for pick colours are used to manipulate (move, rotate, select) with Objects.
-    for (size_t i = 0; i < object_sample.vertices.size(); i += 1)
-    {
-        colours_.push_back(r);
-        colours_.push_back(g);
-        colours_.push_back(b);
+    // Pick colours are used to manipulate (move, rotate, select) with Objects.
+    // An Object has a single colour and pick colour, they are set for the whole draw, so an Object has no buffers
+    // of its own: vertex and index buffers are shared by all Objects of one type (MeshBufferCache, see
+    // loadObjectBuffers).
+    pick_rgb_[0] = pick_r;
+    pick_rgb_[1] = pick_g;
+    pick_rgb_[2] = pick_b;
 
-        pick_colours_.push_back(pick_r);
-        pick_colours_.push_back(pick_g);
-        pick_colours_.push_back(pick_b);
-    }
-
-    // copy vertices and indices from object_sample into Object's variables.
-    vertices_.insert(vertices_.end(), object_sample.vertices.begin(), object_sample.vertices.end());
-    indices_.insert(indices_.end(), object_sample.indices.begin(), object_sample.indices.end());
+    // The Object is GPU-resident: vertices and indices stay in library.h or MeshRegistry and are not copied.
+    // The center of the mesh is the pivot for rotations. Vertices never change, so it is calculated only once.
+    mesh_center_ = mesh_summary.center;
+    mesh_bounds_ = mesh_summary.bounds;
+    inner_box_scale_ = mesh_summary.inner_box_scale;
 
     // Calculate bounding box to draw metadata text below the object.
-    // Bounding box is re-calculated every time vertices change.
+    // Bounding box is re-calculated every time the transform changes.
     calculateBoundingBox();
 
 }
 
+MeshSummary Object::summarizeMesh(ObjectType object_type)
+/** Calculates the average coordinates of the mesh vertices to approximate the center of the mesh, and its bounds.
+The average suits to find the center of an object when the vertices are uniformly distributed around the center.
+For irregular shapes the centroid calculation method is preferred (calculate centroid of every triangle and calculate
+weighted average of all centroids. */
+{
+    const MeshView mesh = getMeshByType(object_type);
+    const GLfloat* vertices = mesh.vertices;
+    MeshSummary summary{{0.0f, 0.0f, 0.0f},
+                        {vertices[0], vertices[0], vertices[1], vertices[1], vertices[2], vertices[2]},
+                        OcclusionCuller::getInnerBoxScale(object_type)};
+    auto& center = summary.center;
+    auto& bounds = summary.bounds;
+
+    for (size_t i = 0; i < mesh.vertices_size; i += 3) {
+        center[0] += vertices[i];
+        center[1] += vertices[i + 1];
+        center[2] += vertices[i + 2];
+        bounds.minX = std::min(bounds.minX, vertices[i]);
+        bounds.maxX = std::max(bounds.maxX, vertices[i]);
+        bounds.minY = std::min(bounds.minY, vertices[i + 1]);
+        bounds.maxY = std::max(bounds.maxY, vertices[i + 1]);
+        bounds.minZ = std::min(bounds.minZ, vertices[i + 2]);
+        bounds.maxZ = std::max(bounds.maxZ, vertices[i + 2]);
+    }
+    float vertex_count = static_cast<float>(mesh.vertices_size) / 3;
+
+    center[0] /= vertex_count;
+    center[1] /= vertex_count;
+    center[2] /= vertex_count;
+
+    return summary;
+}
+
 void Object::reset()
-/** Resets all buffers (vertices, indices, colours and pick_colours) of an Object. */
+/** Releases the shared mesh buffers of an Object. */
+{
+    // Shared vertex and index buffers are deleted by MeshBufferCache when the last Object of the type is reset.
+    if (mesh_buffers_ != nullptr)
+    {
+        MeshBufferCache::release(object_type_);
+        mesh_buffers_ = nullptr;
+    }
+}
+
+MeshView Object::getMesh() const
+/** Returns the mesh of the Object: the shared one of its type or, if it is not GPU-resident, its own copy. */
 {
-    // glDeleteBuffers deletes buffer objects.
-    // After a buffer object is deleted, it has no contents, and its name is free for reuse
-    glDeleteBuffers(1, &vertex_buffer_object_);
-    glDeleteBuffers(1, &index_buffer_object_);
-    glDeleteBuffers(1, &color_buffer_object_);
-    glDeleteBuffers(1, &pick_color_buffer_object_);
+    if (gpu_resident_)
+    {
+        return getMeshByType(object_type_);
+    }
+    return {vertices_.data(), vertices_.size(), indices_.data(), indices_.size()};
+}
+
+void Object::setGpuResident(bool gpu_resident)
+/** GPU-resident Objects (the default) draw from buffers only and read their mesh from library.h or MeshRegistry,
+shared by all Objects of the type. Otherwise the Object keeps its own copy of the mesh in host memory, as all Objects
+once did. */
+{
+    if (gpu_resident == gpu_resident_)
+    {
+        return;
+    }
+    if (gpu_resident)
+    {
+        // swap frees the memory, clear would keep the capacity.
+        std::vector<GLfloat>().swap(vertices_);
+        std::vector<GLuint>().swap(indices_);
+    }
+    else
+    {
+        MeshView mesh = getMeshByType(object_type_);
+        vertices_.assign(mesh.vertices, mesh.vertices + mesh.vertices_size);
+        indices_.assign(mesh.indices, mesh.indices + mesh.indices_size);
+    }
+    gpu_resident_ = gpu_resident;
+}
+
+ObjectMemoryUsage Object::getMemoryUsage() const
+/** Returns memory allocated for the Object's vectors (their capacity), zero for a GPU-resident Object. */
+{
+    return {vertices_.capacity() * sizeof(GLfloat),
+            indices_.capacity() * sizeof(GLuint)};
 }
 
 void Object::loadObjectBuffers()
-/** Loads data into all Object's buffers: (vertices, indices, colours and pick_colours. */
+/** Gets the vertex and index buffers of the Object's mesh. They are uploaded only for the first Object of its type,
+others get the same buffers. */
 {
-    // glBindBuffer binds a buffer object to the target GL_ARRAY_BUFFER. It means that this buffer  will be used
-    // for subsequent operations. This binding remains active until another buffer is bound to the same target, or the buffer is unbound.
-    // Target is a symbolic constant used to specify the type of buffer object that will store attribute data.
-    // GL_ARRAY_BUFFER is a target to store vertex attribute data (coordinates, texture coord., normals, colours, etc).
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object_);
-
-    // glBufferData creates and initializes the buffer object's data store.
-    // Size - the total size needed for the vertex data calculated by multiplying the size of a single GLfloat
-    // by the number of vertices.
-    // GL_STATIC_DRAW - usage pattern of the data store, means the data will be set once and used many times for drawing operations.
-    glBufferData(GL_ARRAY_BUFFER,
-                 sizeof(GLfloat) * vertices_.size(),
-                 vertices_.data(),
-                 GL_STATIC_DRAW);
-
-    // GL_ELEMENT_ARRAY_BUFFER is a target to store indices of each element in the "other" (GL_ARRAY_BUFFER) buffer.
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_object_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                 sizeof(GLuint) * indices_.size(),
-                 indices_.data(),
-                 GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ARRAY_BUFFER, color_buffer_object_);
-    glBufferData(GL_ARRAY_BUFFER,
-                 sizeof(GLfloat) * colours_.size(),
-                 colours_.data(),
-                 GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ARRAY_BUFFER, pick_color_buffer_object_);
-    glBufferData(GL_ARRAY_BUFFER,
-                 sizeof(GLubyte) * pick_colours_.size(),
-                 pick_colours_.data(),
-                 GL_STATIC_DRAW);
+    if (mesh_buffers_ == nullptr)
+    {
+        mesh_buffers_ = MeshBufferCache::acquire(object_type_, getMesh());
+    }
 }
 
+void Object::fillDrawItem(ObjectDrawItem& item) const
+/** Copies buffers and the current state of the Object that are needed to draw it into a draw item. */
+{
+    item.index_count = static_cast<GLsizei>(getMesh().indices_size);
+    for (int i = 0; i < 3; i++)
+    {
+        item.color[i] = static_cast<GLubyte>(std::lround(std::min(std::max(rgb_[i], 0.0f), 1.0f) * 255.0f));
+        item.pick_color[i] = pick_rgb_[i];
+    }
+    item.color[3] = 255;
+    item.polygon_mode = polygon_mode_;
+    item.bounding_box = bounding_box_;
+    item.selected = false;
+    item.hovered = false;
+
+    // Wireframes and points hide nothing. The box is in mesh space here and moved to the vertex buffer below.
+    item.occluder = inner_box_scale_ > 0.0f && polygon_mode_ == kPolygonModeFill;
+    const float bounds_min[3] = {mesh_bounds_.minX, mesh_bounds_.minY, mesh_bounds_.minZ};
+    const float bounds_max[3] = {mesh_bounds_.maxX, mesh_bounds_.maxY, mesh_bounds_.maxZ};
+    float occluder_min[3], occluder_max[3];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float center = 0.5f * (bounds_min[axis] + bounds_max[axis]);
+        float half_size = 0.5f * inner_box_scale_ * (bounds_max[axis] - bounds_min[axis]);
+        occluder_min[axis] = center - half_size;
+        occluder_max[axis] = center + half_size;
+    }
+    item.occluder_box = {occluder_min[0], occluder_max[0], occluder_min[1], occluder_max[1],
+                         occluder_min[2], occluder_max[2]};
 
-void Object::draw(bool get_pick_color)
-/** High-level drawing function that selects whether to draw using general colours buffer or pick_colors buffer. */
+    if (mesh_buffers_ == nullptr || mesh_buffers_->position_type == GL_FLOAT)
+    {
+        item.vertex_buffer_object = mesh_buffers_ != nullptr ? mesh_buffers_->vertex_buffer_object : 0;
+        item.index_buffer_object = mesh_buffers_ != nullptr ? mesh_buffers_->index_buffer_object : 0;
+        item.vertex_offset = mesh_buffers_ != nullptr ? mesh_buffers_->vertex_offset : 0;
+        item.index_offset = mesh_buffers_ != nullptr ? mesh_buffers_->index_offset : 0;
+        item.position_type = GL_FLOAT;
+        item.position_stride = 3 * sizeof(GLfloat);
+        item.index_type = mesh_buffers_ != nullptr ? mesh_buffers_->index_type : GL_UNSIGNED_INT;
+        // Scaling with zooming factor is applied after the Object's translation and rotation.
+        item.model_matrix = math3d::Mat4::rotationAround(rotation_, mesh_center_.data(), translation_,
+                                                         gui_parameters_.zoom_factor_);
+        return;
+    }
+
+    item.vertex_buffer_object = mesh_buffers_->vertex_buffer_object;
+    item.index_buffer_object = mesh_buffers_->index_buffer_object;
+    item.vertex_offset = mesh_buffers_->vertex_offset;
+    item.index_offset = mesh_buffers_->index_offset;
+    item.position_type = mesh_buffers_->position_type;
+    item.position_stride = mesh_buffers_->position_stride;
+    item.index_type = mesh_buffers_->index_type;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        occluder_min[axis] = (occluder_min[axis] - mesh_buffers_->position_offset[axis]) /
+                             mesh_buffers_->position_scale[axis];
+        occluder_max[axis] = (occluder_max[axis] - mesh_buffers_->position_offset[axis]) /
+                             mesh_buffers_->position_scale[axis];
+    }
+    item.occluder_box = {occluder_min[0], occluder_max[0], occluder_min[1], occluder_max[1],
+                         occluder_min[2], occluder_max[2]};
+    // Compact positions are decoded to mesh space by the same matrix, before the rotation.
+    item.model_matrix = math3d::Mat4::rotationAround(rotation_, mesh_center_.data(), translation_,
+                                                     gui_parameters_.zoom_factor_, mesh_buffers_->position_scale,
+                                                     mesh_buffers_->position_offset);
+}
+
+void Object::drawItem(const ObjectDrawItem& item, const math3d::Mat4& view_matrix, bool get_pick_color,
+                      ObjectDetail detail)
+/** Draws an Object from its draw item with general colours or with pick colours, detail applies to general colours.
+The model-view matrix is multiplied on the CPU and loaded into OpenGL, the driver's matrix stack is not used. */
 {
+    glLoadMatrixf((view_matrix * item.model_matrix).data());
+
     if (get_pick_color)
     {
-        drawWithPick_();
+        drawWithPick_(item);
     } else {
-        drawDefault_();
+        drawDefault_(item, detail);
     }
 }
 
-void Object::drawDefault_()
+void Object::drawDefault_(const ObjectDrawItem& item, ObjectDetail detail)
 /** Renders an Object using OpenGL. It sets up the rendering mode to draw the Object's polygons and colors.
-If the object is selected, it modifies the line color to green and applies a stipple pattern. */
+If the object is under the cursor, its lines are drawn thicker in cyan. If the object is selected, it modifies
+the line color to green and applies a stipple pattern. With ObjectDetail::kWithoutEdges the lines are drawn only
+for these two highlights. */
 {
-    // Save the current transformation matrix to ensure that subsequent glScalef doesn't affect other Objects.
-    glPushMatrix();
-
-    // Apply scaling with zooming factor.
-    glScalef(gui_parameters_.zoom_factor_, gui_parameters_.zoom_factor_, gui_parameters_.zoom_factor_);
+    // The Object's zoom, translation and rotation are already loaded in drawItem.
+    // Vertices in the buffer stay in mesh space.
 
     // glPolygonMode sets the polygon drawing mode, determining how polygons will be rasterized.
     // GL_FRONT_AND_BACK applies the mode to both front and back faces of polygons.
     // Mode can be set as GL_FILL, GL_LINE, or GL_POINT.
-    glPolygonMode(GL_FRONT_AND_BACK, polygon_mode_);
+    glPolygonMode(GL_FRONT_AND_BACK, item.polygon_mode);
 
     // Enables OpenGL to use the array of vertices specified later.
     glEnableClientState(GL_VERTEX_ARRAY);
     // Binds the vertex buffer object (VBO) to the GL_ARRAY_BUFFER target.
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object_);
+    glBindBuffer(GL_ARRAY_BUFFER, item.vertex_buffer_object);
     // Specifies the location and data format of the array.
-    // It tells OpenGL that the vertex array data consists of 3-component (x, y, z) vertices of type GL_FLOAT.
-    // The stride and offset are both 0, meaning the data is tightly packed without gaps.
-    glVertexPointer(3, GL_FLOAT, 0, 0);
+    // It tells OpenGL that the vertex array data consists of 3-component (x, y, z) vertices of type GL_FLOAT, or of
+    // GL_SHORT with VertexFormat::kCompact (decoded by the model matrix); the stride skips the padding of the latter.
+    // With a bound buffer the pointer is a byte offset: the mesh of the Object starts there in the shared buffer.
+    glVertexPointer(3, item.position_type, item.position_stride, reinterpret_cast<const void*>(item.vertex_offset));
 
-    // Enables the client-side capability to use color arrays.
-    glEnableClientState(GL_COLOR_ARRAY);
-    glBindBuffer(GL_ARRAY_BUFFER, color_buffer_object_);
-    // Specifies the location and data format of the array of colors.
-    // It tells OpenGL that the color array data consists of 3-component (R, G, B) colors of type GL_FLOAT.
-    glColorPointer(3, GL_FLOAT, 0, 0);
+    // The whole Object has one colour, so it is set once for the draw instead of an array of colours per vertex.
+    glColor4ubv(item.color);
 
     // Bind the index buffer object (IBO) to the GL_ELEMENT_ARRAY_BUFFER target.
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_object_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, item.index_buffer_object);
 
     // Renders primitives from array data.
-    // Due to mode GL_TRIANGLES it draws triangles using the indices stored in the index buffer object.
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), GL_UNSIGNED_INT, 0);
+    // Due to mode GL_TRIANGLES it draws triangles using the indices stored in the index buffer object, from the byte
+    // offset of the mesh; they count from the vertex at the offset of glVertexPointer.
+    glDrawElements(GL_TRIANGLES, item.index_count, item.index_type, reinterpret_cast<const void*>(item.index_offset));
 
-    // Disables the client-side capability to use color arrays.
-    // This is a cleanup step to ensure that color arrays are not used unintentionally in subsequent rendering operations.
-    glDisableClientState(GL_COLOR_ARRAY);
+    if (detail == ObjectDetail::kWithoutEdges && !item.hovered && !item.selected)
+    {
+        glDisableClientState(GL_VERTEX_ARRAY);
+        return;
+    }
 
     // Set polygon mode to draw lines.
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     glColor3f(1, 1, 1);  // Set color to white
 
-    if (selected_) // If the Object is selected, set color to green, increase line width to 2.0 and enable line
+    if (item.hovered) // If the cursor is on the Object, set color to cyan and increase line width to 2.0.
+    {
+        glColor3f(0, 1, 1);
+        glLineWidth(2.0f);
+    }
+    if (item.selected) // If the Object is selected, set color to green, increase line width to 2.0 and enable line
         // stipple to create a dashed line effect.
     {
         glColor3f(0, 1, 0);
@@ -168,45 +287,32 @@ If the object is selected, it modifies the line color to green and applies a sti
         glEnable(GL_LINE_STIPPLE);
         glLineStipple(1, 0x00FF); // 0x00FF is the pattern, 1 is the repeat factor
     }
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, item.index_count, item.index_type, reinterpret_cast<const void*>(item.index_offset));
     glDisable(GL_LINE_STIPPLE); // Disable the line stipple effect
     glLineWidth(1.0f); // Reset line width to default
 
     glDisableClientState(GL_VERTEX_ARRAY);  // Disable the client-side capability to use vertex arrays
-
-    // Restore the previous transformation matrix saved with glPushMatrix.
-    glPopMatrix();
-
-
 }
 
-void Object::drawWithPick_()
-/** Repeats drawDefault_ method above, but applies pick_color_buffer_object_ buffer instead of
-general color_buffer_object_ to color Object's polygons, and applies only GL_FILL polygon mode.
+void Object::drawWithPick_(const ObjectDrawItem& item)
+/** Repeats drawDefault_ method above, but colours Object's polygons with its pick colour instead of its general
+colour, and applies only GL_FILL polygon mode.
 Every Object despite general color RGB values (that can be the same for multiple Objects) has unique pick colour values.
 Rendering Objects with pick colours is used to manipulate with Objects and detect which Object
 is selected in the window.*/
 {
-    glPushMatrix();
-    glScalef(gui_parameters_.zoom_factor_, gui_parameters_.zoom_factor_, gui_parameters_.zoom_factor_);
-
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
     glEnableClientState(GL_VERTEX_ARRAY);
 
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object_);
-    glVertexPointer(3, GL_FLOAT, 0, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, item.vertex_buffer_object);
+    glVertexPointer(3, item.position_type, item.position_stride, reinterpret_cast<const void*>(item.vertex_offset));
 
-    glEnableClientState(GL_COLOR_ARRAY);
-    glBindBuffer(GL_ARRAY_BUFFER, pick_color_buffer_object_);
-    glColorPointer(3, GL_UNSIGNED_BYTE, 0, 0);
+    glColor3ubv(item.pick_color);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_object_);
-    glDrawElements(GL_TRIANGLES, static_cast<int>(indices_.size()), GL_UNSIGNED_INT, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, item.index_buffer_object);
+    glDrawElements(GL_TRIANGLES, item.index_count, item.index_type, reinterpret_cast<const void*>(item.index_offset));
     glDisableClientState(GL_VERTEX_ARRAY);
-    glDisableClientState(GL_COLOR_ARRAY);
-    glPopMatrix();
-
 }
 
 std::string Object::ObjectTypeToString() const
@@ -218,44 +324,22 @@ std::string Object::ObjectTypeToString() const
         case kPyramid: return "Pyramid";
         case kSphere: return "Sphere";
         case kIcosahedron: return "Icosahedron";
-        default: return "Unknown";
-    }
-}
-
-bool Object::checkPickColor(int pick_color_id) const
-/** Checks if Object's pick_color_id is equal to the provided id. */
-{
-    if (pick_color_id == pick_id_)
-    {
-        return true;
+        default: return MeshRegistry::contains(object_type_) ? MeshRegistry::getName(object_type_) : "Unknown";
     }
-    return false;
 }
 
 void Object::updateObjectCoordinates(double delta_x, double delta_y)
-/** Iterates through vertices and change x- and y- coordinates by delta_x and delta_y. Re-load vertices buffer.
-Delta-x and delta-y are calculated based on changes of mouse cursor position and OpenGL viewport parameters.*/
+/** Moves the Object along x- and y- axes by delta_x and delta_y. Only the translation of the Object changes,
+vertices buffer is not touched. Delta-x and delta-y are calculated based on changes of mouse cursor position and
+OpenGL viewport parameters.*/
 {
-    for (size_t i = 0; i < vertices_.size(); i += 3)
-    {
-        vertices_[i] += static_cast<float>(delta_x);
-        // Subtract delta_y because screen y-coordinates go top-to-bottom,
-        // and OpenGL viewport y-coordinates go bottom-to-top.
-        vertices_[i + 1] -= static_cast<float>(delta_y);
-        vertices_[i + 2] += 0.0f;  // Ensure z-coordinate remains unchanged
-    }
+    translation_[0] += static_cast<float>(delta_x);
+    // Subtract delta_y because screen y-coordinates go top-to-bottom,
+    // and OpenGL viewport y-coordinates go bottom-to-top.
+    translation_[1] -= static_cast<float>(delta_y);
 
-    // When vertices change, bounding box needs to be re-calculated.
+    // When the transform changes, bounding box needs to be re-calculated.
     calculateBoundingBox();
-
-    // When vertices change, buffer with vertices data has to be reset and new data stored again.
-    // Changes in coordinates of vertices do not affect other buffers: indices, colours and pick_colours.
-    glDeleteBuffers(1, &vertex_buffer_object_);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object_);
-    glBufferData(GL_ARRAY_BUFFER,
-                 sizeof(GLfloat) * vertices_.size(),
-                 vertices_.data(),
-                 GL_STATIC_DRAW);
 }
 
 std::string Object::ObjectIdToString() const
@@ -264,146 +348,148 @@ std::string Object::ObjectIdToString() const
     return std::to_string(id_);
 }
 
-void Object::updateObjectColor()
-/** Iterates through vertices and assign new rgb values foe every vertex. Re-load colours buffer. */
+void Object::updateObjectRotation(double delta_x, double delta_y)
+/** Updates the rotation of the object based on mouse movement.
+Delta-x and delta-y are calculated based on changes of mouse cursor position
+It computes the new rotation angles from the deltas, converts them to radians, and combines the rotations
+with the current rotation of the Object. Rotation happens around the center of the Object. */
 {
-    colours_.clear();
-
-    for (size_t i = 0; i < vertices_.size(); i += 1)
-    {
-        colours_.push_back(rgb_[0]);
-        colours_.push_back(rgb_[1]);
-        colours_.push_back(rgb_[2]);
-    }
-    // When rgb values for vertices change, buffer with colours data has to be reset and new data stored again.
-    glDeleteBuffers(1, &color_buffer_object_);
-    glBindBuffer(GL_ARRAY_BUFFER, color_buffer_object_);
-    glBufferData(GL_ARRAY_BUFFER,
-                 sizeof(GLfloat) * colours_.size(),
-                 colours_.data(),
-                 GL_STATIC_DRAW);
+    float delta_rotation[9];
+    calculateRotationDelta(delta_x, delta_y, delta_rotation);
+    applyRotation(delta_rotation);
 }
 
-
-std::array<float, 3> Object::calculateCenter()
-/** Calculates the average coordinates of the Object's vertices to approximate the center.
-This method suits to find the center of an object when the vertices are uniformly distributed around the center.
-For irregular shapes the centroid calculation method is preferred (calculate centroid of every triangle and calculate
-weighted average of all centroids. */
+void Object::calculateRotationDelta(double delta_x, double delta_y, float delta_rotation[9])
+/** Calculates the rotation matrix (row-major 3x3) for a mouse movement by delta_x and delta_y pixels. */
 {
-    std::array<float, 3> center = {0.0f, 0.0f, 0.0f};
-
-    for (size_t i = 0; i < vertices_.size(); i += 3) {
-        center[0] += vertices_[i];
-        center[1] += vertices_[i + 1];
-        center[2] += vertices_[i + 2];
-    }
-    float vertex_count = static_cast<float>(vertices_.size()) / 3;
-
-    center[0] /= vertex_count;
-    center[1] /= vertex_count;
-    center[2] /= vertex_count;
-
-    return center;
+    // Delta_x and delta_y are scaled by a rotation sensitivity parameter and converted from degrees to radians.
+    float sensitivity = Config::getParameters().rotation_sensitivity;
+    float radians_x = math3d::radians(static_cast<float>(delta_y) * sensitivity);
+    float radians_y = math3d::radians(static_cast<float>(delta_x) * sensitivity);
+
+    // Rotation around the y-axis (horizontal mouse movement) is applied first, then around the x-axis
+    // (vertical mouse movement).
+    math3d::Quat rotation = math3d::Quat::fromAxisAngle({1.0f, 0.0f, 0.0f}, radians_x) *
+                            math3d::Quat::fromAxisAngle({0.0f, 1.0f, 0.0f}, radians_y);
+    rotation.toRotation(delta_rotation);
 }
 
-void Object::updateObjectRotation(double delta_x, double delta_y)
-/** Updates the rotation of the object based on mouse movement.
-Delta-x and delta-y are calculated based on changes of mouse cursor position
-It computes the new rotation angles from the deltas, converts them to radians, and applies the rotations
-to the object's vertices around its center. */
+void Object::applyRotation(const float delta_rotation[9])
+/** Applies a rotation matrix (row-major 3x3) on top of the current rotation of the Object. */
 {
-    // Delta_x and delta_y are scaled by a rotation sensitivity parameter and converted from degrees to radians.
-    float radians_x = delta_y * Config::getParameters().rotation_sensitivity * pi_ / 180.0f;
-    float radians_y = -delta_x * Config::getParameters().rotation_sensitivity * pi_ / 180.0f;
-
-    // Compute the sin and cos of the rotation angles
-    float cos_x = cos(radians_x);
-    float sin_x = sin(radians_x);
-    float cos_y = cos(radians_y);
-    float sin_y = sin(radians_y);
+    float new_rotation[9];
+    math3d::multiplyRotation(delta_rotation, rotation_, new_rotation);
+    std::memcpy(rotation_, new_rotation, sizeof(rotation_));
 
-    // Calculate approximate center.
-    auto center = calculateCenter();
+    // When the transform changes, bounding box needs to be re-calculated.
+    calculateBoundingBox();
+}
 
-    for (size_t i = 0; i < vertices_.size(); i += 3)
+void Object::translate(const float delta[3])
+/** Adds delta to the translation of the Object (in scene coordinates, unlike updateObjectCoordinates that takes
+cursor movement) and re-calculates bounding box. */
+{
+    for (int i = 0; i < 3; i++)
     {
-        // Each vertex is translated such that the center of the object becomes the origin.
-        float x = vertices_[i] - center[0];
-        float y = vertices_[i + 1] - center[1];
-        float z = vertices_[i + 2] - center[2];
-
-        // Rotate around the y-axis (horizontal mouse movement)
-        float temp_x = x * cos_y - z * sin_y;
-        float temp_z = x * sin_y + z * cos_y;
-
-        // Update the vertex coordinates after y rotation
-        x = temp_x;
-        z = temp_z;
-
-        // Rotate around the x-axis (vertical mouse movement)
-        float temp_y = y * cos_x - z * sin_x;
-        z = y * sin_x + z * cos_x;
-
-        // The rotated vertex is translated back to its original position relative to the center.
-        vertices_[i] = x + center[0];
-        vertices_[i+1] = temp_y + center[1];
-        vertices_[i+2] = z + center[2];
+        translation_[i] += delta[i];
     }
-    // When vertices change, bounding box needs to be re-calculated.
     calculateBoundingBox();
-
-    // When vertices change, buffer with vertices data has to be reset and new data stored again.
-    // Changes in coordinates of vertices do not affect other buffers: indices, colours and pick_colours.
-    glDeleteBuffers(1, &vertex_buffer_object_);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object_);
-    glBufferData(GL_ARRAY_BUFFER,
-                 sizeof(GLfloat) * vertices_.size(),
-                 vertices_.data(),
-                 GL_STATIC_DRAW);
 }
 
 void Object::resetObjectVertices()
-/** Re-load all vertices from a sample object from library.h and reset vertices buffer
- to return Object to the default position and size. Re-calculates bounding box around the Object.*/
+/** Resets the Object's transform and zoom factor to return Object to the default position and size.
+Re-calculates bounding box around the Object.*/
 {
     gui_parameters_.zoom_factor_ = 1;
-    vertices_.clear();
-
-    Polyhedron object_sample = getPolyhedronByType(object_type_);
-    vertices_.insert(vertices_.end(), object_sample.vertices.begin(), object_sample.vertices.end());
 
-    glDeleteBuffers(1, &vertex_buffer_object_);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_object_);
-    glBufferData(GL_ARRAY_BUFFER,
-                 sizeof(GLfloat) * vertices_.size(),
-                 vertices_.data(),
-                 GL_STATIC_DRAW);
+    const float translation[3] = {0.0f, 0.0f, 0.0f};
+    const float rotation[9] = {1.0f, 0.0f, 0.0f,
+                               0.0f, 1.0f, 0.0f,
+                               0.0f, 0.0f, 1.0f};
+    setTransform(translation, rotation);
+}
 
+void Object::setTransform(const float translation[3], const float rotation[9])
+/** Replaces translation and rotation (row-major 3x3 matrix) of the Object and re-calculates bounding box. */
+{
+    std::memcpy(translation_, translation, sizeof(translation_));
+    std::memcpy(rotation_, rotation, sizeof(rotation_));
     calculateBoundingBox();
 }
 
+math3d::Mat4 Object::getModelMatrix() const
+/** Returns the model matrix of the Object: it rotates vertices around the mesh center and then applies
+the translation. */
+{
+    return math3d::Mat4::rotationAround(rotation_, mesh_center_.data(), translation_);
+}
+
 void Object::calculateBoundingBox()
-/** Calculates the bounding box of the Object based on its vertices.
-Iterates through all the vertices of the object to determine the minimum and maximum x and y coordinates,
-then adjusts them according to the current zoom factor from the individual ImGui window parameters.*/
+/** Calculates the bounding box of the Object based on its vertices moved by the Object's transform.
+Iterates through all the vertices of the object to determine the minimum and maximum x, y and z coordinates,
+then adjusts them according to the current zoom factor from the individual ImGui window parameters.
+Without rotation the bounding box is the bounds of the mesh moved by the translation, and no vertex is read. */
 {
-    bounding_box_.minX = bounding_box_.maxX = vertices_[0];
-    bounding_box_.minY = bounding_box_.maxY = vertices_[1];
+    const math3d::Mat4 model_matrix = getModelMatrix();
+    const float* m = model_matrix.data();
+    if (!hasRotation_())
+    {
+        bounding_box_ = {mesh_bounds_.minX + m[12], mesh_bounds_.maxX + m[12],
+                         mesh_bounds_.minY + m[13], mesh_bounds_.maxY + m[13],
+                         mesh_bounds_.minZ + m[14], mesh_bounds_.maxZ + m[14]};
+        applyZoomToBoundingBox_();
+        return;
+    }
 
-    for (size_t i = 0; i < vertices_.size(); i += 3)
+    const MeshView mesh = getMesh();
+    const GLfloat* vertices = mesh.vertices;
+
+    auto world_x = [&](size_t i) {
+        return m[0] * vertices[i] + m[4] * vertices[i + 1] + m[8] * vertices[i + 2] + m[12];
+    };
+    auto world_y = [&](size_t i) {
+        return m[1] * vertices[i] + m[5] * vertices[i + 1] + m[9] * vertices[i + 2] + m[13];
+    };
+    // z-coordinates are only used to cull Objects on the screen (e.g. in occlusion-query box selection).
+    auto world_z = [&](size_t i) {
+        return m[2] * vertices[i] + m[6] * vertices[i + 1] + m[10] * vertices[i + 2] + m[14];
+    };
+
+    bounding_box_.minX = bounding_box_.maxX = world_x(0);
+    bounding_box_.minY = bounding_box_.maxY = world_y(0);
+    bounding_box_.minZ = bounding_box_.maxZ = world_z(0);
+
+    for (size_t i = 0; i < mesh.vertices_size; i += 3)
     {
-        float x = vertices_[i];
-        float y = vertices_[i + 1];
+        float x = world_x(i);
+        float y = world_y(i);
+        float z = world_z(i);
         if (x < bounding_box_.minX) {bounding_box_.minX = x;}
         if (x > bounding_box_.maxX) {bounding_box_.maxX = x;}
         if (y < bounding_box_.minY) {bounding_box_.minY = y;}
         if (y > bounding_box_.maxY) {bounding_box_.maxY = y;}
+        if (z < bounding_box_.minZ) {bounding_box_.minZ = z;}
+        if (z > bounding_box_.maxZ) {bounding_box_.maxZ = z;}
     }
+    applyZoomToBoundingBox_();
+}
+
+void Object::applyZoomToBoundingBox_()
+{
     bounding_box_.minY *= gui_parameters_.zoom_factor_;
     bounding_box_.minX *= gui_parameters_.zoom_factor_;
     bounding_box_.maxX *= gui_parameters_.zoom_factor_;
     bounding_box_.maxY *= gui_parameters_.zoom_factor_;
+    bounding_box_.minZ *= gui_parameters_.zoom_factor_;
+    bounding_box_.maxZ *= gui_parameters_.zoom_factor_;
+}
+
+bool Object::hasRotation_() const
+{
+    static const float identity[9] = {1.0f, 0.0f, 0.0f,
+                                      0.0f, 1.0f, 0.0f,
+                                      0.0f, 0.0f, 1.0f};
+    return std::memcmp(rotation_, identity, sizeof(rotation_)) != 0;
 }
 
 void Object::setGuiWindowCoordinates(float window_width, float window_height, double x, double y)
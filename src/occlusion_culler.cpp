@@ -0,0 +1,521 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+
+#include "../include/occlusion_culler.h"
+#include "../include/trace.h"
+
+
+constexpr int OcclusionCuller::kWidth;
+constexpr int OcclusionCuller::kHeight;
+std::unordered_map<int, float> OcclusionCuller::inner_box_scales_;
+
+namespace
+{
+// Points closer to the camera plane than this (w in clip space) make a box invalid: it can't be projected.
+constexpr float kMinClipW = 1e-3f;
+
+struct Point2
+{
+    float x, y;
+};
+
+float cross2(const Point2& o, const Point2& a, const Point2& b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+int convexHull(Point2 points[8], Point2 hull[16])
+/* Andrew's monotone chain: writes the convex hull of 8 points counter-clockwise and returns the number of its
+corners. */
+{
+    std::sort(points, points + 8, [](const Point2& a, const Point2& b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+    int size = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        while (size >= 2 && cross2(hull[size - 2], hull[size - 1], points[i]) <= 0.0f)
+        {
+            size--;
+        }
+        hull[size++] = points[i];
+    }
+    for (int i = 6, lower_size = size + 1; i >= 0; i--)
+    {
+        while (size >= lower_size && cross2(hull[size - 2], hull[size - 1], points[i]) <= 0.0f)
+        {
+            size--;
+        }
+        hull[size++] = points[i];
+    }
+    // The first point is repeated at the end.
+    return size - 1;
+}
+}
+
+
+void OcclusionCuller::cull(const SceneView& view, const std::vector<ObjectDrawItem>& items,
+                           std::vector<VisibleItem>& visible_items, ViewStats& stats)
+/** Removes the Objects hidden behind occluders from visible_items (the result of SceneView::cull or all items) and
+adds the counts to stats. Objects removed here are no longer counted as drawn. */
+{
+    PROJECT_1_TRACE_ZONE("OcclusionCuller::cull");
+    if (visible_items.empty())
+    {
+        return;
+    }
+    const math3d::Mat4 view_projection = view.getProjectionMatrix() * view.getViewMatrix();
+
+    rects_.resize(visible_items.size());
+    occluders_.clear();
+    for (size_t i = 0; i < visible_items.size(); i++)
+    {
+        const auto& item = items[visible_items[i].index];
+        const auto& box = item.bounding_box;
+        ScreenRect& rect = rects_[i];
+        rect = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), 0.0f, true};
+        for (int corner = 0; corner < 8; corner++)
+        {
+            const math3d::Vec4 clip = view_projection.transform({corner & 1 ? box.maxX : box.minX,
+                                                                 corner & 2 ? box.maxY : box.minY,
+                                                                 corner & 4 ? box.maxZ : box.minZ, 1.0f});
+            if (clip.w < kMinClipW)
+            {
+                rect.valid = false;
+                break;
+            }
+            const float inverse_w = 1.0f / clip.w;
+            const float x = (clip.x * inverse_w * 0.5f + 0.5f) * kWidth;
+            const float y = (clip.y * inverse_w * 0.5f + 0.5f) * kHeight;
+            rect.min_x = std::min(rect.min_x, x);
+            rect.max_x = std::max(rect.max_x, x);
+            rect.min_y = std::min(rect.min_y, y);
+            rect.max_y = std::max(rect.max_y, y);
+            rect.nearest_inverse_depth = std::max(rect.nearest_inverse_depth, inverse_w);
+        }
+        if (!rect.valid || !item.occluder)
+        {
+            continue;
+        }
+        // Only the part on the screen hides anything.
+        float area = std::max(std::min(rect.max_x, static_cast<float>(kWidth)) - std::max(rect.min_x, 0.0f), 0.0f) *
+                     std::max(std::min(rect.max_y, static_cast<float>(kHeight)) - std::max(rect.min_y, 0.0f), 0.0f);
+        if (area >= kMinOccluderArea)
+        {
+            occluders_.push_back(static_cast<int>(i));
+        }
+    }
+    if (occluders_.empty())
+    {
+        return;
+    }
+
+    if (occluders_.size() > kMaxOccluders)
+    {
+        auto area = [this](int i) {
+            return (rects_[i].max_x - rects_[i].min_x) * (rects_[i].max_y - rects_[i].min_y);
+        };
+        std::nth_element(occluders_.begin(), occluders_.begin() + kMaxOccluders, occluders_.end(),
+                         [&area](int a, int b) { return area(a) > area(b); });
+        occluders_.resize(kMaxOccluders);
+    }
+
+    if (levels_[0].empty())
+    {
+        for (int level = 0; level < kLevelCount; level++)
+        {
+            levels_[level].resize(static_cast<size_t>((kWidth >> level) * (kHeight >> level)));
+        }
+    }
+    std::fill(levels_[0].begin(), levels_[0].end(), 0.0f);
+    for (int i: occluders_)
+    {
+        drawOccluder_(items[visible_items[i].index], view_projection);
+    }
+    stats.occluders += occluders_.size();
+    buildHierarchy_();
+
+    size_t kept = 0;
+    for (size_t i = 0; i < visible_items.size(); i++)
+    {
+        if (rects_[i].valid && isOccluded_(rects_[i]))
+        {
+            stats.occluded++;
+            stats.drawn--;
+            if (visible_items[i].detail == ObjectDetail::kWithoutEdges)
+            {
+                stats.without_edges--;
+            }
+            continue;
+        }
+        visible_items[kept++] = visible_items[i];
+    }
+    visible_items.resize(kept);
+}
+
+void OcclusionCuller::drawOccluder_(const ObjectDrawItem& item, const math3d::Mat4& view_projection)
+/** Draws the occluder box of item (in the coordinates of its vertex buffer, mapped by its model matrix) into the
+finest level: the convex hull of its corners on the screen, at the depth of its farthest corner, into the pixels that
+are completely inside the hull. */
+{
+    const auto& box = item.occluder_box;
+    const math3d::Mat4 matrix = view_projection * item.model_matrix;
+    Point2 corners[8];
+    float farthest_inverse_depth = std::numeric_limits<float>::max();
+    for (int corner = 0; corner < 8; corner++)
+    {
+        const math3d::Vec4 clip = matrix.transform({corner & 1 ? box.maxX : box.minX, corner & 2 ? box.maxY : box.minY,
+                                                    corner & 4 ? box.maxZ : box.minZ, 1.0f});
+        if (clip.w < kMinClipW)
+        {
+            return;
+        }
+        const float inverse_w = 1.0f / clip.w;
+        corners[corner] = {(clip.x * inverse_w * 0.5f + 0.5f) * kWidth, (clip.y * inverse_w * 0.5f + 0.5f) * kHeight};
+        farthest_inverse_depth = std::min(farthest_inverse_depth, inverse_w);
+    }
+
+    Point2 hull[16];
+    const int hull_size = convexHull(corners, hull);
+    if (hull_size < 3)
+    {
+        return;
+    }
+    // Edge functions a * x + b * y + c, positive inside. c is moved to the corner of a pixel where the function is the
+    // smallest, so a pixel passes only if all of it is inside.
+    float a[16], b[16], c[16];
+    float min_x = hull[0].x, max_x = hull[0].x, min_y = hull[0].y, max_y = hull[0].y;
+    for (int i = 0; i < hull_size; i++)
+    {
+        const Point2& p = hull[i];
+        const Point2& q = hull[i + 1];
+        a[i] = p.y - q.y;
+        b[i] = q.x - p.x;
+        c[i] = -(a[i] * p.x + b[i] * p.y) + std::min(a[i], 0.0f) + std::min(b[i], 0.0f);
+        min_x = std::min(min_x, p.x);
+        max_x = std::max(max_x, p.x);
+        min_y = std::min(min_y, p.y);
+        max_y = std::max(max_y, p.y);
+    }
+
+    // Rows start at a multiple of 4, pixels left of the hull fail its edges.
+    const int x_begin = std::max(static_cast<int>(std::floor(min_x)), 0) & ~3;
+    const int x_end = std::min(static_cast<int>(std::ceil(max_x)), kWidth);
+    const int y_begin = std::max(static_cast<int>(std::floor(min_y)), 0);
+    const int y_end = std::min(static_cast<int>(std::ceil(max_y)), kHeight);
+    float* pixels = levels_[0].data();
+    for (int y = y_begin; y < y_end; y++)
+    {
+        float* row = pixels + y * kWidth;
+#ifdef PROJECT_1_MATH3D_SSE
+        __m128 row_c[16];
+        for (int i = 0; i < hull_size; i++)
+        {
+            row_c[i] = _mm_set1_ps(b[i] * static_cast<float>(y) + c[i]);
+        }
+        const __m128 depth = _mm_set1_ps(farthest_inverse_depth);
+        for (int x = x_begin; x < x_end; x += 4)
+        {
+            const __m128 xs = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+            __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), xs), row_c[0]), _mm_setzero_ps());
+            for (int i = 1; i < hull_size; i++)
+            {
+                const __m128 edge = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[i]), xs), row_c[i]);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(edge, _mm_setzero_ps()));
+            }
+            // Pixels outside get 0, which never wins against what is in the buffer.
+            _mm_storeu_ps(row + x, _mm_max_ps(_mm_loadu_ps(row + x), _mm_and_ps(inside, depth)));
+        }
+#else
+        for (int x = x_begin; x < x_end; x++)
+        {
+            bool inside = true;
+            for (int i = 0; i < hull_size && inside; i++)
+            {
+                inside = a[i] * static_cast<float>(x) + b[i] * static_cast<float>(y) + c[i] >= 0.0f;
+            }
+            if (inside)
+            {
+                row[x] = std::max(row[x], farthest_inverse_depth);
+            }
+        }
+#endif
+    }
+}
+
+void OcclusionCuller::buildHierarchy_()
+/** Fills every coarser level with the minimum of 2x2 pixels of the level before: the farthest occluder depth. */
+{
+    for (int level = 1; level < kLevelCount; level++)
+    {
+        const int width = kWidth >> level;
+        const int height = kHeight >> level;
+        const float* source = levels_[level - 1].data();
+        float* target = levels_[level].data();
+        for (int y = 0; y < height; y++)
+        {
+            const float* row0 = source + 2 * y * (2 * width);
+            const float* row1 = row0 + 2 * width;
+            float* out = target + y * width;
+#ifdef PROJECT_1_MATH3D_SSE
+            // Widths of all levels are multiples of 4.
+            for (int x = 0; x < width; x += 4)
+            {
+                const __m128 low = _mm_min_ps(_mm_loadu_ps(row0 + 2 * x), _mm_loadu_ps(row1 + 2 * x));
+                const __m128 high = _mm_min_ps(_mm_loadu_ps(row0 + 2 * x + 4), _mm_loadu_ps(row1 + 2 * x + 4));
+                _mm_storeu_ps(out + x, _mm_min_ps(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)),
+                                                  _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1))));
+            }
+#else
+            for (int x = 0; x < width; x++)
+            {
+                out[x] = std::min(std::min(row0[2 * x], row0[2 * x + 1]), std::min(row1[2 * x], row1[2 * x + 1]));
+            }
+#endif
+        }
+    }
+}
+
+bool OcclusionCuller::isOccluded_(const ScreenRect& rect) const
+/** Tests the rectangle on the coarsest level where it covers at most 4x4 pixels: it is hidden if its nearest point is
+behind all of them. */
+{
+    if (rect.max_x <= 0.0f || rect.min_x >= kWidth || rect.max_y <= 0.0f || rect.min_y >= kHeight)
+    {
+        return false;
+    }
+    const int x0 = std::max(static_cast<int>(std::floor(rect.min_x)), 0);
+    const int x1 = std::max(std::min(static_cast<int>(std::ceil(rect.max_x)), kWidth) - 1, x0);
+    const int y0 = std::max(static_cast<int>(std::floor(rect.min_y)), 0);
+    const int y1 = std::max(std::min(static_cast<int>(std::ceil(rect.max_y)), kHeight) - 1, y0);
+
+    int level = 0;
+    while (level < kLevelCount - 1 && ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3))
+    {
+        level++;
+    }
+    const int width = kWidth >> level;
+    const float* pixels = levels_[level].data();
+    for (int y = y0 >> level; y <= y1 >> level; y++)
+    {
+        for (int x = x0 >> level; x <= x1 >> level; x++)
+        {
+            if (pixels[y * width + x] <= rect.nearest_inverse_depth)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+float OcclusionCuller::getInnerBoxScale(ObjectType object_type)
+/** Returns how much the bounding box of the mesh of object_type can be scaled around its center to lie inside the
+mesh, or 0 if the mesh is not convex: Objects of the type are occluders only if it is greater than 0. Meshes never
+change, so it is computed once per type. */
+{
+    auto it = inner_box_scales_.find(object_type);
+    if (it != inner_box_scales_.end())
+    {
+        return it->second;
+    }
+    float scale = computeInnerBoxScale_(getMeshByType(object_type));
+    inner_box_scales_[object_type] = scale;
+    return scale;
+}
+
+float OcclusionCuller::computeInnerBoxScale_(const MeshView& mesh)
+/** The mesh is convex if it is closed (every edge is shared by exactly two triangles), no two faces meet at a concave
+edge and no vertex has more than 360 degrees of faces around it. Vertices at the same position are merged first,
+meshes often repeat them along seams. The box then has to be on the inner side of the planes of all faces. */
+{
+    const size_t vertex_count = mesh.vertices_size / 3;
+    if (vertex_count < 4 || mesh.indices_size < 12)
+    {
+        return 0.0f;
+    }
+
+    std::map<std::array<float, 3>, uint32_t> merged;
+    std::vector<math3d::Vec3> positions;
+    std::vector<uint32_t> remap(vertex_count);
+    math3d::Vec3 min(mesh.vertices), max(mesh.vertices);
+    for (size_t i = 0; i < vertex_count; i++)
+    {
+        const GLfloat* vertex = mesh.vertices + 3 * i;
+        auto inserted = merged.insert({{vertex[0], vertex[1], vertex[2]}, static_cast<uint32_t>(positions.size())});
+        if (inserted.second)
+        {
+            positions.emplace_back(vertex);
+        }
+        remap[i] = inserted.first->second;
+        min = {std::min(min.x, vertex[0]), std::min(min.y, vertex[1]), std::min(min.z, vertex[2])};
+        max = {std::max(max.x, vertex[0]), std::max(max.y, vertex[1]), std::max(max.z, vertex[2])};
+    }
+    const math3d::Vec3 center = (min + max) * 0.5f;
+    const math3d::Vec3 half_size = (max - min) * 0.5f;
+    const float size = math3d::length(max - min);
+
+    // Triangles whose corners were merged have no area; their two remaining edges cancel each other out.
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i + 2 < mesh.indices_size; i += 3)
+    {
+        if (mesh.indices[i] >= vertex_count || mesh.indices[i + 1] >= vertex_count ||
+            mesh.indices[i + 2] >= vertex_count)
+        {
+            return 0.0f;
+        }
+        std::array<uint32_t, 3> triangle{remap[mesh.indices[i]], remap[mesh.indices[i + 1]],
+                                         remap[mesh.indices[i + 2]]};
+        if (triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[2] != triangle[0])
+        {
+            triangles.push_back(triangle);
+        }
+    }
+    if (triangles.empty())
+    {
+        return 0.0f;
+    }
+
+    // Both triangles of every edge, found by the edge with the smaller vertex first.
+    auto edge_key = [](uint32_t a, uint32_t b) {
+        return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+    };
+    std::unordered_map<uint64_t, std::array<uint32_t, 2>> edges;
+    for (uint32_t t = 0; t < triangles.size(); t++)
+    {
+        for (int corner = 0; corner < 3; corner++)
+        {
+            auto inserted = edges.insert({edge_key(triangles[t][corner], triangles[t][(corner + 1) % 3]),
+                                          {t, UINT32_MAX}});
+            if (!inserted.second)
+            {
+                if (inserted.first->second[1] != UINT32_MAX)
+                {
+                    return 0.0f;
+                }
+                inserted.first->second[1] = t;
+            }
+        }
+    }
+    auto neighbour = [&](uint32_t t, uint32_t a, uint32_t b) {
+        const auto& pair = edges.at(edge_key(a, b));
+        return pair[0] == t ? pair[1] : pair[0];
+    };
+    auto has_edge = [](const std::array<uint32_t, 3>& triangle, uint32_t a, uint32_t b) {
+        return (triangle[0] == a && triangle[1] == b) || (triangle[1] == a && triangle[2] == b) ||
+               (triangle[2] == a && triangle[0] == b);
+    };
+    for (const auto& edge: edges)
+    {
+        if (edge.second[1] == UINT32_MAX)
+        {
+            return 0.0f;
+        }
+    }
+
+    // Built-in meshes mix clockwise and counter-clockwise triangles, which fixed-function drawing doesn't mind.
+    // Windings are made consistent from the first triangle over shared edges: a neighbour has to run along the edge
+    // in the opposite direction. A mesh that falls apart into several pieces is no single convex body.
+    std::vector<char> visited(triangles.size(), 0);
+    std::vector<uint32_t> queue{0};
+    visited[0] = 1;
+    for (size_t next = 0; next < queue.size(); next++)
+    {
+        const auto triangle = triangles[queue[next]];
+        for (int corner = 0; corner < 3; corner++)
+        {
+            uint32_t a = triangle[corner], b = triangle[(corner + 1) % 3];
+            uint32_t other = neighbour(queue[next], a, b);
+            bool same_direction = has_edge(triangles[other], a, b);
+            if (visited[other])
+            {
+                if (same_direction)
+                {
+                    return 0.0f;
+                }
+                continue;
+            }
+            if (same_direction)
+            {
+                std::swap(triangles[other][1], triangles[other][2]);
+            }
+            visited[other] = 1;
+            queue.push_back(other);
+        }
+    }
+    if (queue.size() != triangles.size())
+    {
+        return 0.0f;
+    }
+
+    // With consistent windings, the sign of the volume tells which side of the triangles is outside.
+    float volume = 0.0f;
+    for (const auto& triangle: triangles)
+    {
+        volume += math3d::dot(positions[triangle[0]], math3d::cross(positions[triangle[1]], positions[triangle[2]]));
+    }
+    if (std::fabs(volume) <= 1e-6f * size * size * size)
+    {
+        return 0.0f;
+    }
+    const float orientation = volume > 0.0f ? 1.0f : -1.0f;
+
+    std::vector<float> angle_sums(positions.size(), 0.0f);
+    float scale = 1.0f;
+    for (const auto& triangle: triangles)
+    {
+        const math3d::Vec3& p0 = positions[triangle[0]];
+        const math3d::Vec3 normal = math3d::cross(positions[triangle[1]] - p0, positions[triangle[2]] - p0) *
+                                    orientation;
+        const float normal_length = math3d::length(normal);
+        if (normal_length == 0.0f)
+        {
+            return 0.0f;
+        }
+        for (int corner = 0; corner < 3; corner++)
+        {
+            const uint32_t from = triangle[corner], to = triangle[(corner + 1) % 3];
+            const auto& other = triangles[neighbour(static_cast<uint32_t>(&triangle - triangles.data()), from, to)];
+            for (uint32_t vertex: other)
+            {
+                if (vertex != from && vertex != to &&
+                    math3d::dot(normal, positions[vertex] - p0) > 1e-5f * normal_length * size)
+                {
+                    return 0.0f;
+                }
+            }
+
+            const math3d::Vec3& p = positions[triangle[corner]];
+            const math3d::Vec3 u = math3d::normalize(positions[triangle[(corner + 1) % 3]] - p);
+            const math3d::Vec3 v = math3d::normalize(positions[triangle[(corner + 2) % 3]] - p);
+            angle_sums[triangle[corner]] += std::acos(std::min(std::max(math3d::dot(u, v), -1.0f), 1.0f));
+        }
+
+        // The corner of the box farthest along the normal must stay behind the plane of the face.
+        const float distance = math3d::dot(normal, p0 - center);
+        const float reach = std::fabs(normal.x) * half_size.x + std::fabs(normal.y) * half_size.y +
+                            std::fabs(normal.z) * half_size.z;
+        if (distance <= 0.0f)
+        {
+            return 0.0f;
+        }
+        if (reach > 0.0f)
+        {
+            scale = std::min(scale, distance / reach);
+        }
+    }
+    for (float angle_sum: angle_sums)
+    {
+        if (angle_sum > 2.0f * math3d::kPi + 1e-3f)
+        {
+            return 0.0f;
+        }
+    }
+    // A little smaller, so rounding never puts a corner outside.
+    return 0.99f * scale;
+}
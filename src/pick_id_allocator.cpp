@@ -0,0 +1,62 @@
+#include <stdexcept>
+#include <string>
+
+#include "../include/pick_id_allocator.h"
+
+
+uint32_t PickIdAllocator::acquire()
+/** Returns a free pick id: the last released one or, if none was released, the next never used one.
+Throws std::runtime_error if all ids are in use. */
+{
+    if (!free_ids_.empty())
+    {
+        uint32_t pick_id = free_ids_.back();
+        free_ids_.pop_back();
+        in_use_[pick_id] = true;
+        return pick_id;
+    }
+    if (next_id_ > max_id_)
+    {
+        throw std::runtime_error("No free pick ids: the scene has reached the limit of " +
+                                 std::to_string(max_id_) + " objects.");
+    }
+    in_use_.resize(next_id_ + 1, false);
+    in_use_[next_id_] = true;
+    return next_id_++;
+}
+
+void PickIdAllocator::release(uint32_t pick_id)
+/** Returns an id to the allocator, it's handed out again by the next acquire. Throws std::runtime_error if the id
+was never allocated or is already released, which would give it to two Objects later. */
+{
+    if (pick_id == 0 || pick_id >= next_id_)
+    {
+        throw std::runtime_error("Pick id " + std::to_string(pick_id) + " was not allocated.");
+    }
+    if (!in_use_[pick_id])
+    {
+        throw std::runtime_error("Pick id " + std::to_string(pick_id) + " is already released.");
+    }
+    in_use_[pick_id] = false;
+    free_ids_.push_back(pick_id);
+}
+
+void PickIdAllocator::clear()
+/** Releases all ids at once, e.g. when all Objects are removed. */
+{
+    next_id_ = 1;
+    free_ids_.clear();
+    in_use_.clear();
+}
+
+void PickIdAllocator::toColor(uint32_t pick_id, unsigned char rgb[3])
+{
+    rgb[0] = static_cast<unsigned char>((pick_id >> 16) & 0xFF);
+    rgb[1] = static_cast<unsigned char>((pick_id >> 8) & 0xFF);
+    rgb[2] = static_cast<unsigned char>(pick_id & 0xFF);
+}
+
+uint32_t PickIdAllocator::fromColor(const unsigned char rgb[3])
+{
+    return (static_cast<uint32_t>(rgb[0]) << 16) | (static_cast<uint32_t>(rgb[1]) << 8) | rgb[2];
+}
@@ -0,0 +1,397 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+#include "../include/primitive_generator.h"
+#include "../include/mesh_registry.h"
+#include "../include/math3d.h"
+
+
+std::unordered_map<PrimitiveParameters, ObjectType, PrimitiveParametersHash> PrimitiveGenerator::cache_;
+PrimitiveCacheStats PrimitiveGenerator::stats_{};
+
+namespace
+{
+void addVertex(Polyhedron& mesh, float x, float y, float z)
+{
+    mesh.vertices.push_back(x);
+    mesh.vertices.push_back(y);
+    mesh.vertices.push_back(z);
+}
+
+void addTriangle(Polyhedron& mesh, GLuint a, GLuint b, GLuint c)
+{
+    mesh.indices.push_back(a);
+    mesh.indices.push_back(b);
+    mesh.indices.push_back(c);
+}
+
+void addQuad(Polyhedron& mesh, GLuint a, GLuint b, GLuint c, GLuint d)
+/* Adds two triangles of the quad a-b-c-d (counterclockwise when looking at its front side). */
+{
+    addTriangle(mesh, a, b, c);
+    addTriangle(mesh, c, d, a);
+}
+
+float roundToHundredths(float value)
+/* Parameters are rounded, so parameters that look the same in the GUI and in the mesh name are the same key. */
+{
+    return std::round(value * 100.0f) / 100.0f;
+}
+
+Polyhedron generateUvSphere(float radius, int segments, int rings)
+/* Sphere of latitude rings between two pole vertices. */
+{
+    Polyhedron mesh;
+    addVertex(mesh, 0.0f, radius, 0.0f);
+    for (int ring = 1; ring < rings; ring++)
+    {
+        float theta = ring * math3d::kPi / rings;
+        for (int segment = 0; segment < segments; segment++)
+        {
+            float phi = segment * 2.0f * math3d::kPi / segments;
+            addVertex(mesh, radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta),
+                      radius * std::sin(theta) * std::sin(phi));
+        }
+    }
+    addVertex(mesh, 0.0f, -radius, 0.0f);
+
+    auto ring_vertex = [segments](int ring, int segment) {
+        return static_cast<GLuint>(1 + (ring - 1) * segments + segment % segments);
+    };
+    auto bottom_pole = static_cast<GLuint>(mesh.vertices.size() / 3 - 1);
+    for (int segment = 0; segment < segments; segment++)
+    {
+        addTriangle(mesh, 0, ring_vertex(1, segment + 1), ring_vertex(1, segment));
+        for (int ring = 1; ring < rings - 1; ring++)
+        {
+            addQuad(mesh, ring_vertex(ring, segment), ring_vertex(ring, segment + 1),
+                    ring_vertex(ring + 1, segment + 1), ring_vertex(ring + 1, segment));
+        }
+        addTriangle(mesh, bottom_pole, ring_vertex(rings - 1, segment), ring_vertex(rings - 1, segment + 1));
+    }
+    return mesh;
+}
+
+Polyhedron generateIcoSphere(float radius, int subdivisions)
+/* Icosahedron whose triangles are split into four `subdivisions` times, with vertices moved onto the sphere. */
+{
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    const float base_vertices[12][3] = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+                                        {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+                                        {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+    const GLuint base_indices[] = {0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+                                   1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+                                   3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+                                   4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1};
+
+    Polyhedron mesh;
+    auto add_on_sphere = [&mesh, radius](float x, float y, float z) {
+        float scale = radius / std::sqrt(x * x + y * y + z * z);
+        addVertex(mesh, x * scale, y * scale, z * scale);
+        return static_cast<GLuint>(mesh.vertices.size() / 3 - 1);
+    };
+    for (const auto& vertex: base_vertices)
+    {
+        add_on_sphere(vertex[0], vertex[1], vertex[2]);
+    }
+    mesh.indices.assign(std::begin(base_indices), std::end(base_indices));
+
+    for (int level = 0; level < subdivisions; level++)
+    {
+        // Every edge is shared by two triangles, its midpoint is created once.
+        std::map<std::pair<GLuint, GLuint>, GLuint> midpoints;
+        auto midpoint = [&](GLuint a, GLuint b) {
+            auto key = std::make_pair(std::min(a, b), std::max(a, b));
+            auto it = midpoints.find(key);
+            if (it != midpoints.end())
+            {
+                return it->second;
+            }
+            const float* va = &mesh.vertices[a * 3];
+            const float* vb = &mesh.vertices[b * 3];
+            GLuint index = add_on_sphere((va[0] + vb[0]) / 2, (va[1] + vb[1]) / 2, (va[2] + vb[2]) / 2);
+            midpoints[key] = index;
+            return index;
+        };
+
+        std::vector<GLuint> indices;
+        indices.swap(mesh.indices);
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            GLuint a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            GLuint ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+            addTriangle(mesh, a, ab, ca);
+            addTriangle(mesh, b, bc, ab);
+            addTriangle(mesh, c, ca, bc);
+            addTriangle(mesh, ab, bc, ca);
+        }
+    }
+    return mesh;
+}
+
+Polyhedron generateTorus(float radius, float minor_radius, int segments, int rings)
+/* Torus around the z-axis, so its hole faces the camera. */
+{
+    Polyhedron mesh;
+    for (int segment = 0; segment < segments; segment++)
+    {
+        float u = segment * 2.0f * math3d::kPi / segments;
+        for (int ring = 0; ring < rings; ring++)
+        {
+            float v = ring * 2.0f * math3d::kPi / rings;
+            float distance = radius + minor_radius * std::cos(v);
+            addVertex(mesh, distance * std::cos(u), distance * std::sin(u), minor_radius * std::sin(v));
+        }
+    }
+    auto vertex = [segments, rings](int segment, int ring) {
+        return static_cast<GLuint>((segment % segments) * rings + ring % rings);
+    };
+    for (int segment = 0; segment < segments; segment++)
+    {
+        for (int ring = 0; ring < rings; ring++)
+        {
+            addQuad(mesh, vertex(segment, ring), vertex(segment + 1, ring),
+                    vertex(segment + 1, ring + 1), vertex(segment, ring + 1));
+        }
+    }
+    return mesh;
+}
+
+Polyhedron generateCylinder(float radius, float height, int segments, bool cone)
+/* Cylinder (or cone, if `cone` is true) around the y-axis with closed bases. */
+{
+    Polyhedron mesh;
+    float half_height = height / 2.0f;
+    for (int segment = 0; segment < segments; segment++)
+    {
+        float phi = segment * 2.0f * math3d::kPi / segments;
+        addVertex(mesh, radius * std::cos(phi), -half_height, radius * std::sin(phi));
+        if (!cone)
+        {
+            addVertex(mesh, radius * std::cos(phi), half_height, radius * std::sin(phi));
+        }
+    }
+    auto bottom_center = static_cast<GLuint>(mesh.vertices.size() / 3);
+    addVertex(mesh, 0.0f, -half_height, 0.0f);
+    auto top_center = static_cast<GLuint>(mesh.vertices.size() / 3);
+    addVertex(mesh, 0.0f, half_height, 0.0f);
+
+    int stride = cone ? 1 : 2;
+    for (int segment = 0; segment < segments; segment++)
+    {
+        auto bottom = static_cast<GLuint>(segment * stride);
+        auto next_bottom = static_cast<GLuint>(((segment + 1) % segments) * stride);
+        addTriangle(mesh, bottom_center, bottom, next_bottom);
+        if (cone)
+        {
+            // The apex is the top center.
+            addTriangle(mesh, bottom, top_center, next_bottom);
+        }
+        else
+        {
+            addQuad(mesh, bottom, bottom + 1, next_bottom + 1, next_bottom);
+            addTriangle(mesh, top_center, next_bottom + 1, bottom + 1);
+        }
+    }
+    return mesh;
+}
+
+Polyhedron generateBox(float half_width, float height, int subdivisions)
+/* Box whose every face is a grid of subdivisions x subdivisions quads. */
+{
+    Polyhedron mesh;
+    float half_height = height / 2.0f;
+    // Every face: a corner and two edge vectors, their cross product points outside.
+    const float faces[6][9] = {
+            {-1, -1, 1, 2, 0, 0, 0, 2, 0},    // front (+z)
+            {1, -1, -1, -2, 0, 0, 0, 2, 0},   // back (-z)
+            {1, -1, 1, 0, 0, -2, 0, 2, 0},    // right (+x)
+            {-1, -1, -1, 0, 0, 2, 0, 2, 0},   // left (-x)
+            {-1, 1, 1, 2, 0, 0, 0, 0, -2},    // top (+y)
+            {-1, -1, -1, 2, 0, 0, 0, 0, 2}};  // bottom (-y)
+    const float scale[3] = {half_width, half_height, half_width};
+
+    for (const auto& face: faces)
+    {
+        auto first = static_cast<GLuint>(mesh.vertices.size() / 3);
+        for (int row = 0; row <= subdivisions; row++)
+        {
+            for (int col = 0; col <= subdivisions; col++)
+            {
+                float s = static_cast<float>(col) / subdivisions;
+                float t = static_cast<float>(row) / subdivisions;
+                addVertex(mesh, (face[0] + face[3] * s + face[6] * t) * scale[0],
+                          (face[1] + face[4] * s + face[7] * t) * scale[1],
+                          (face[2] + face[5] * s + face[8] * t) * scale[2]);
+            }
+        }
+        auto vertex = [first, subdivisions](int row, int col) {
+            return static_cast<GLuint>(first + row * (subdivisions + 1) + col);
+        };
+        for (int row = 0; row < subdivisions; row++)
+        {
+            for (int col = 0; col < subdivisions; col++)
+            {
+                addQuad(mesh, vertex(row, col), vertex(row, col + 1), vertex(row + 1, col + 1), vertex(row + 1, col));
+            }
+        }
+    }
+    return mesh;
+}
+}
+
+
+bool PrimitiveParameters::operator==(const PrimitiveParameters& other) const
+{
+    return kind == other.kind && radius == other.radius && minor_radius == other.minor_radius &&
+           height == other.height && segments == other.segments && rings == other.rings &&
+           subdivisions == other.subdivisions;
+}
+
+size_t PrimitiveParametersHash::operator()(const PrimitiveParameters& parameters) const
+{
+    size_t hash = static_cast<size_t>(parameters.kind);
+    auto combine = [&hash](size_t value) {hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);};
+    combine(std::hash<float>()(parameters.radius));
+    combine(std::hash<float>()(parameters.minor_radius));
+    combine(std::hash<float>()(parameters.height));
+    combine(std::hash<int>()(parameters.segments));
+    combine(std::hash<int>()(parameters.rings));
+    combine(std::hash<int>()(parameters.subdivisions));
+    return hash;
+}
+
+PrimitiveParameters PrimitiveGenerator::normalize(const PrimitiveParameters& parameters)
+/** Clamps parameters to supported ranges, rounds sizes to hundredths and zeroes parameters that the kind doesn't
+use, so parameters that describe the same mesh are equal. */
+{
+    PrimitiveParameters result{};
+    result.kind = parameters.kind;
+    result.radius = roundToHundredths(std::min(std::max(parameters.radius, 0.01f), 10.0f));
+    result.minor_radius = 0.0f;
+    result.height = 0.0f;
+    result.segments = 0;
+    result.rings = 0;
+    result.subdivisions = 0;
+
+    switch (parameters.kind)
+    {
+        case PrimitiveKind::kUvSphere:
+            result.segments = std::min(std::max(parameters.segments, 3), 256);
+            result.rings = std::min(std::max(parameters.rings, 2), 256);
+            break;
+        case PrimitiveKind::kIcoSphere:
+            result.subdivisions = std::min(std::max(parameters.subdivisions, 0), 5);
+            break;
+        case PrimitiveKind::kTorus:
+            result.minor_radius = roundToHundredths(std::min(std::max(parameters.minor_radius, 0.01f), result.radius));
+            result.segments = std::min(std::max(parameters.segments, 3), 256);
+            result.rings = std::min(std::max(parameters.rings, 3), 256);
+            break;
+        case PrimitiveKind::kCylinder:
+        case PrimitiveKind::kCone:
+            result.height = roundToHundredths(std::min(std::max(parameters.height, 0.01f), 10.0f));
+            result.segments = std::min(std::max(parameters.segments, 3), 256);
+            break;
+        case PrimitiveKind::kBox:
+            result.height = roundToHundredths(std::min(std::max(parameters.height, 0.01f), 10.0f));
+            result.subdivisions = std::min(std::max(parameters.subdivisions, 1), 64);
+            break;
+    }
+    return result;
+}
+
+Polyhedron PrimitiveGenerator::generate(const PrimitiveParameters& parameters)
+/** Generates the mesh of a primitive (without caching). */
+{
+    PrimitiveParameters p = normalize(parameters);
+    switch (p.kind)
+    {
+        case PrimitiveKind::kUvSphere: return generateUvSphere(p.radius, p.segments, p.rings);
+        case PrimitiveKind::kIcoSphere: return generateIcoSphere(p.radius, p.subdivisions);
+        case PrimitiveKind::kTorus: return generateTorus(p.radius, p.minor_radius, p.segments, p.rings);
+        case PrimitiveKind::kCylinder: return generateCylinder(p.radius, p.height, p.segments, false);
+        case PrimitiveKind::kCone: return generateCylinder(p.radius, p.height, p.segments, true);
+        case PrimitiveKind::kBox: return generateBox(p.radius, p.height, p.subdivisions);
+    }
+    return {};
+}
+
+ObjectType PrimitiveGenerator::getObjectType(const PrimitiveParameters& parameters)
+/** Returns the ObjectType of a primitive. The mesh is generated and registered in MeshRegistry only the first time
+these parameters are requested. A mesh with the same name that is already registered (e.g. loaded from a scene file)
+is reused as well. */
+{
+    PrimitiveParameters key = normalize(parameters);
+    auto it = cache_.find(key);
+    if (it != cache_.end())
+    {
+        stats_.hits++;
+        return it->second;
+    }
+    stats_.misses++;
+
+    std::string name = getName(key);
+    int object_type = MeshRegistry::findByName(name);
+    if (object_type < 0)
+    {
+        object_type = MeshRegistry::registerMesh(name, generate(key));
+    }
+    const Polyhedron& mesh = MeshRegistry::getMesh(static_cast<ObjectType>(object_type));
+    stats_.byte_size += sizeof(GLfloat) * mesh.vertices.size() + sizeof(GLuint) * mesh.indices.size();
+    stats_.mesh_count++;
+
+    cache_[key] = static_cast<ObjectType>(object_type);
+    return static_cast<ObjectType>(object_type);
+}
+
+std::string PrimitiveGenerator::getName(const PrimitiveParameters& parameters)
+/** Name of the mesh in MeshRegistry, it contains all parameters, e.g. "Torus R0.40 r0.15 48x24". */
+{
+    PrimitiveParameters p = normalize(parameters);
+    char name[128];
+    switch (p.kind)
+    {
+        case PrimitiveKind::kUvSphere:
+            snprintf(name, sizeof(name), "UV Sphere r%.2f %dx%d", p.radius, p.segments, p.rings);
+            break;
+        case PrimitiveKind::kIcoSphere:
+            snprintf(name, sizeof(name), "Ico Sphere r%.2f s%d", p.radius, p.subdivisions);
+            break;
+        case PrimitiveKind::kTorus:
+            snprintf(name, sizeof(name), "Torus R%.2f r%.2f %dx%d", p.radius, p.minor_radius, p.segments, p.rings);
+            break;
+        case PrimitiveKind::kCylinder:
+            snprintf(name, sizeof(name), "Cylinder r%.2f h%.2f %d", p.radius, p.height, p.segments);
+            break;
+        case PrimitiveKind::kCone:
+            snprintf(name, sizeof(name), "Cone r%.2f h%.2f %d", p.radius, p.height, p.segments);
+            break;
+        case PrimitiveKind::kBox:
+            snprintf(name, sizeof(name), "Box %.2fx%.2fx%.2f s%d", p.radius * 2, p.height, p.radius * 2,
+                     p.subdivisions);
+            break;
+    }
+    return name;
+}
+
+const char* PrimitiveGenerator::getKindName(PrimitiveKind kind)
+{
+    switch (kind)
+    {
+        case PrimitiveKind::kUvSphere: return "UV Sphere";
+        case PrimitiveKind::kIcoSphere: return "Ico Sphere";
+        case PrimitiveKind::kTorus: return "Torus";
+        case PrimitiveKind::kCylinder: return "Cylinder";
+        case PrimitiveKind::kCone: return "Cone";
+        case PrimitiveKind::kBox: return "Box";
+    }
+    return "Unknown";
+}
+
+PrimitiveCacheStats PrimitiveGenerator::getStats()
+{
+    return stats_;
+}
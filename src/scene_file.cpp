@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#ifdef PROJECT_1_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#include "../include/scene_file.h"
+#include "../include/mesh_registry.h"
+
+
+namespace
+{
+constexpr size_t kBlockAlignment = 16;
+
+size_t alignOffset(size_t offset)
+{
+    return (offset + kBlockAlignment - 1) & ~(kBlockAlignment - 1);
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool rangeInFile(uint64_t offset, uint64_t size, size_t file_size)
+{
+    return offset <= file_size && size <= file_size - offset;
+}
+
+// A custom mesh of a scene file and the object type it is drawn with: a registered mesh with the same name and
+// contents, or a new one that is registered once the whole file is validated (object_type is -1 until then).
+struct FileMesh
+{
+    std::string name;
+    Polyhedron mesh;
+    int object_type;
+};
+
+bool sameMesh(const Polyhedron& a, const Polyhedron& b)
+{
+    return a.vertices == b.vertices && a.indices == b.indices;
+}
+
+size_t matchFileMesh(std::vector<FileMesh>& file_meshes, std::string name, Polyhedron mesh)
+/* Returns the index in file_meshes of the mesh to use for a mesh of the file. A mesh registered under the same name
+is used only if it has the same vertices and indices; otherwise '_' is appended to the name until it is free or
+belongs to the same mesh (like names of imported meshes in GuiPanels::drawImportMesh), so loading a file twice
+doesn't register its meshes twice. */
+{
+    while (true)
+    {
+        int registered_type = MeshRegistry::findByName(name);
+        if (registered_type >= 0)
+        {
+            if (sameMesh(MeshRegistry::getMesh(static_cast<ObjectType>(registered_type)), mesh))
+            {
+                file_meshes.push_back({name, Polyhedron(), registered_type});
+                return file_meshes.size() - 1;
+            }
+            name += "_";
+            continue;
+        }
+        // Meshes of the same file that are not registered yet.
+        auto same_name = std::find_if(file_meshes.begin(), file_meshes.end(), [&name](const FileMesh& file_mesh) {
+            return file_mesh.object_type < 0 && file_mesh.name == name;
+        });
+        if (same_name == file_meshes.end())
+        {
+            file_meshes.push_back({name, std::move(mesh), -1});
+            return file_meshes.size() - 1;
+        }
+        if (sameMesh(same_name->mesh, mesh))
+        {
+            return static_cast<size_t>(same_name - file_meshes.begin());
+        }
+        name += "_";
+    }
+}
+}
+
+
+SceneReader::SceneReader(const std::string& file_path) : file_(file_path)
+{
+    const unsigned char* data = file_.data();
+    size_t file_size = file_.size();
+
+    if (file_size < sizeof(SceneFileHeader))
+    {
+        throw std::runtime_error("Scene file " + file_path + " is too small.");
+    }
+    header_ = reinterpret_cast<const SceneFileHeader*>(data);
+
+    if (std::memcmp(header_->magic, kSceneFileMagic, sizeof(kSceneFileMagic)) != 0)
+    {
+        throw std::runtime_error(file_path + " is not a scene file.");
+    }
+    if (header_->version != kSceneFileVersion)
+    {
+        throw std::runtime_error("Scene file version " + std::to_string(header_->version) + " is not supported.");
+    }
+    if (header_->file_size != file_size)
+    {
+        throw std::runtime_error("Scene file " + file_path + " is truncated.");
+    }
+
+    // Every table has to fit into the file and be aligned for its records before they are accessed in place. The
+    // object count is checked on its own first, so a huge one can't overflow the size of the table.
+    if (header_->object_count > file_size / sizeof(SceneObjectRecord) ||
+        !rangeInFile(header_->mesh_table_offset, uint64_t(header_->mesh_count) * sizeof(SceneMeshEntry), file_size) ||
+        !rangeInFile(header_->object_table_offset, header_->object_count * sizeof(SceneObjectRecord), file_size) ||
+        !rangeInFile(header_->comment_pool_offset, header_->comment_pool_size, file_size) ||
+        header_->mesh_table_offset % alignof(SceneMeshEntry) != 0 ||
+        header_->object_table_offset % alignof(SceneObjectRecord) != 0)
+    {
+        throw std::runtime_error("Scene file " + file_path + " has a corrupted table of contents.");
+    }
+
+    meshes_ = reinterpret_cast<const SceneMeshEntry*>(data + header_->mesh_table_offset);
+    objects_ = reinterpret_cast<const SceneObjectRecord*>(data + header_->object_table_offset);
+    comments_ = reinterpret_cast<const char*>(data + header_->comment_pool_offset);
+
+    for (size_t mesh_id = 0; mesh_id < meshCount(); mesh_id++)
+    {
+        const auto& entry = meshes_[mesh_id];
+        uint64_t expected_size = sizeof(GLfloat) * uint64_t(entry.vertex_count) + sizeof(GLuint) * uint64_t(entry.index_count);
+        // Raw blocks are read in place, so they have to be stored whole; other codecs are checked when decoded.
+        bool known_codec = entry.codec == kSceneMeshRaw || entry.codec == kSceneMeshDeflate;
+        if (!rangeInFile(entry.block_offset, entry.stored_size, file_size) || entry.raw_size != expected_size ||
+            entry.block_offset % kBlockAlignment != 0 || !known_codec ||
+            (entry.codec == kSceneMeshRaw && entry.stored_size != entry.raw_size))
+        {
+            throw std::runtime_error("Scene file " + file_path + " has a corrupted mesh block.");
+        }
+    }
+    decompressed_blocks_.resize(meshCount());
+}
+
+std::string SceneReader::comment(const SceneObjectRecord& record) const
+/** Returns the comment of an Object from the comment pool. */
+{
+    if (uint64_t(record.comment_offset) + record.comment_length > header_->comment_pool_size)
+    {
+        return "";
+    }
+    return {comments_ + record.comment_offset, record.comment_length};
+}
+
+const unsigned char* SceneReader::meshBlock_(size_t mesh_id)
+/** Returns the raw data of a mesh block. Uncompressed blocks point directly into the mapped file. */
+{
+    const auto& entry = meshes_[mesh_id];
+    const unsigned char* stored = file_.data() + entry.block_offset;
+
+    if (entry.codec == kSceneMeshRaw)
+    {
+        return stored;
+    }
+    if (entry.codec == kSceneMeshDeflate)
+    {
+#ifdef PROJECT_1_WITH_ZLIB
+        auto& block = decompressed_blocks_[mesh_id];
+        if (block.empty() && entry.raw_size > 0)
+        {
+            block.resize(entry.raw_size);
+            uLongf raw_size = static_cast<uLongf>(entry.raw_size);
+            if (uncompress(block.data(), &raw_size, stored, static_cast<uLong>(entry.stored_size)) != Z_OK ||
+                raw_size != entry.raw_size)
+            {
+                block.clear();
+                throw std::runtime_error("Failed to decompress a mesh block of the scene file.");
+            }
+        }
+        return block.data();
+#else
+        throw std::runtime_error("Scene file contains compressed meshes, but the application is built without zlib.");
+#endif
+    }
+    throw std::runtime_error("Scene file contains a mesh block with an unknown codec.");
+}
+
+const GLfloat* SceneReader::meshVertices(size_t mesh_id)
+/** Returns vertices of a mesh block (3 values per vertex). */
+{
+    return reinterpret_cast<const GLfloat*>(meshBlock_(mesh_id));
+}
+
+const GLuint* SceneReader::meshIndices(size_t mesh_id)
+/** Returns indices of a mesh block. They are stored right after the vertices. */
+{
+    return reinterpret_cast<const GLuint*>(meshBlock_(mesh_id) + sizeof(GLfloat) * meshes_[mesh_id].vertex_count);
+}
+
+
+bool SceneFile::isCompressionAvailable()
+/** Returns true if the application is built with zlib and mesh blocks can be compressed. */
+{
+#ifdef PROJECT_1_WITH_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+SceneFileStats SceneFile::save(const Session& session, const std::string& file_path, bool compress_meshes)
+/** Writes all Objects of the session into a scene file. Built-in meshes are not stored, because they are part of
+the application. Other meshes are stored once per object type, optionally compressed with deflate. */
+{
+    auto start_time = std::chrono::steady_clock::now();
+    const auto& objects = session.getObjects();
+
+    std::vector<SceneObjectRecord> records(objects.size());
+    std::vector<SceneMeshEntry> meshes;
+    std::vector<std::vector<unsigned char>> mesh_blocks;
+    std::map<ObjectType, size_t> mesh_by_type;
+    std::string comment_pool;
+
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        const auto& object = objects[i];
+        const auto& gui_parameters = object.getObjectGuiParameters();
+        auto& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+
+        record.id = object.getId();
+        record.object_type = static_cast<uint32_t>(object.getObjectType());
+        std::memcpy(record.rgb, object.getObjectColor(), sizeof(record.rgb));
+        std::memcpy(record.translation, object.getTranslation(), sizeof(record.translation));
+        std::memcpy(record.rotation, object.getRotation(), sizeof(record.rotation));
+        record.zoom_factor = gui_parameters.zoom_factor_;
+        record.polygon_mode = static_cast<uint32_t>(object.getPolygonMode());
+        record.flags = (session.isSelected(i) ? kSceneObjectSelected : 0u) |
+                       (gui_parameters.object_gui_ ? kSceneObjectPanelOpen : 0u);
+        record.panel_x = static_cast<float>(gui_parameters.window_x_);
+        record.panel_y = static_cast<float>(gui_parameters.window_y_);
+
+        size_t comment_length = strnlen(gui_parameters.comment_, sizeof(gui_parameters.comment_));
+        record.comment_offset = static_cast<uint32_t>(comment_pool.size());
+        record.comment_length = static_cast<uint32_t>(comment_length);
+        comment_pool.append(gui_parameters.comment_, comment_length);
+
+        // A mesh is stored only for object types outside the built-in library, once per type.
+        if (object.getObjectType() >= kBuiltinObjectTypeCount && mesh_by_type.count(object.getObjectType()) == 0)
+        {
+            const MeshView mesh = object.getMesh();
+
+            SceneMeshEntry entry{};
+            std::strncpy(entry.name, object.ObjectTypeToString().c_str(), sizeof(entry.name) - 1);
+            entry.object_type = record.object_type;
+            entry.vertex_count = static_cast<uint32_t>(mesh.vertices_size);
+            entry.index_count = static_cast<uint32_t>(mesh.indices_size);
+            entry.raw_size = sizeof(GLfloat) * mesh.vertices_size + sizeof(GLuint) * mesh.indices_size;
+
+            std::vector<unsigned char> block(entry.raw_size);
+            std::memcpy(block.data(), mesh.vertices, sizeof(GLfloat) * mesh.vertices_size);
+            std::memcpy(block.data() + sizeof(GLfloat) * mesh.vertices_size, mesh.indices,
+                        sizeof(GLuint) * mesh.indices_size);
+            entry.codec = kSceneMeshRaw;
+
+#ifdef PROJECT_1_WITH_ZLIB
+            if (compress_meshes)
+            {
+                uLongf compressed_size = compressBound(static_cast<uLong>(block.size()));
+                std::vector<unsigned char> compressed(compressed_size);
+                // The compressed block is kept only if it is actually smaller than the raw one.
+                if (compress2(compressed.data(), &compressed_size, block.data(), static_cast<uLong>(block.size()),
+                              Z_BEST_SPEED) == Z_OK && compressed_size < block.size())
+                {
+                    compressed.resize(compressed_size);
+                    block.swap(compressed);
+                    entry.codec = kSceneMeshDeflate;
+                }
+            }
+#endif
+            entry.stored_size = block.size();
+
+            mesh_by_type[object.getObjectType()] = meshes.size();
+            meshes.push_back(entry);
+            mesh_blocks.push_back(std::move(block));
+        }
+    }
+
+    // Offsets of every part of the file.
+    SceneFileHeader header{};
+    std::memcpy(header.magic, kSceneFileMagic, sizeof(header.magic));
+    header.version = kSceneFileVersion;
+    header.mesh_count = static_cast<uint32_t>(meshes.size());
+    header.object_count = records.size();
+    header.mesh_table_offset = sizeof(SceneFileHeader);
+    header.object_table_offset = alignOffset(header.mesh_table_offset + sizeof(SceneMeshEntry) * meshes.size());
+    header.comment_pool_offset = header.object_table_offset + sizeof(SceneObjectRecord) * records.size();
+    header.comment_pool_size = comment_pool.size();
+
+    size_t offset = alignOffset(header.comment_pool_offset + header.comment_pool_size);
+    for (size_t mesh_id = 0; mesh_id < meshes.size(); mesh_id++)
+    {
+        meshes[mesh_id].block_offset = offset;
+        offset = alignOffset(offset + meshes[mesh_id].stored_size);
+    }
+    header.file_size = offset;
+
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open " + file_path + " for writing.");
+    }
+
+    const char padding[kBlockAlignment] = {};
+    auto write_padding_to = [&](uint64_t position) {
+        auto current = static_cast<uint64_t>(file.tellp());
+        file.write(padding, static_cast<std::streamsize>(position - current));
+    };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(meshes.data()), static_cast<std::streamsize>(sizeof(SceneMeshEntry) * meshes.size()));
+    write_padding_to(header.object_table_offset);
+    file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(sizeof(SceneObjectRecord) * records.size()));
+    file.write(comment_pool.data(), static_cast<std::streamsize>(comment_pool.size()));
+    for (size_t mesh_id = 0; mesh_id < meshes.size(); mesh_id++)
+    {
+        write_padding_to(meshes[mesh_id].block_offset);
+        file.write(reinterpret_cast<const char*>(mesh_blocks[mesh_id].data()), static_cast<std::streamsize>(mesh_blocks[mesh_id].size()));
+    }
+    write_padding_to(header.file_size);
+
+    if (!file.good())
+    {
+        throw std::runtime_error("Failed to write the scene file " + file_path + ".");
+    }
+
+    SceneFileStats stats;
+    stats.object_count = records.size();
+    stats.mesh_count = meshes.size();
+    stats.file_size = header.file_size;
+    stats.total_seconds = secondsSince(start_time);
+    return stats;
+}
+
+SceneFileStats SceneFile::load(Session& session, const std::string& file_path)
+/** Replaces all Objects of the session with Objects from a scene file. The whole file is validated before its meshes
+are registered and the session is cleared, so a broken file leaves the current session and MeshRegistry untouched. */
+{
+    auto start_time = std::chrono::steady_clock::now();
+
+    SceneReader reader(file_path);
+
+    // Object type ids of custom meshes depend on the order of registration, so ids from the file are mapped to
+    // ids in the current MeshRegistry. Meshes that are already registered (same name and contents) are not added again.
+    std::vector<FileMesh> file_meshes;
+    std::map<uint32_t, size_t> mesh_by_file_type;
+    for (size_t mesh_id = 0; mesh_id < reader.meshCount(); mesh_id++)
+    {
+        const auto& entry = reader.meshEntry(mesh_id);
+        std::string name(entry.name, strnlen(entry.name, sizeof(entry.name)));
+
+        Polyhedron mesh;
+        const GLfloat* vertices = reader.meshVertices(mesh_id);
+        const GLuint* indices = reader.meshIndices(mesh_id);
+        mesh.vertices.assign(vertices, vertices + entry.vertex_count);
+        mesh.indices.assign(indices, indices + entry.index_count);
+        if (mesh.vertices.empty() || mesh.indices.empty())
+        {
+            throw std::runtime_error("Mesh " + name + " in the scene file is empty.");
+        }
+        for (auto index: mesh.indices)
+        {
+            if (index >= entry.vertex_count / 3)
+            {
+                throw std::runtime_error("Mesh " + name + " in the scene file references a vertex that doesn't exist.");
+            }
+        }
+        mesh_by_file_type[entry.object_type] = matchFileMesh(file_meshes, std::move(name), std::move(mesh));
+    }
+    for (size_t i = 0; i < reader.objectCount(); i++)
+    {
+        const auto& record = reader.objects()[i];
+        if (record.object_type >= kBuiltinObjectTypeCount && mesh_by_file_type.count(record.object_type) == 0)
+        {
+            throw std::runtime_error("Scene file contains an unknown object type.");
+        }
+        if (uint64_t(record.comment_offset) + record.comment_length > reader.header().comment_pool_size)
+        {
+            throw std::runtime_error("Scene file contains a comment outside of the comment pool.");
+        }
+    }
+
+    // The file is valid, its new meshes can be registered.
+    std::map<uint32_t, ObjectType> type_by_file_type;
+    for (auto& file_mesh: file_meshes)
+    {
+        if (file_mesh.object_type < 0)
+        {
+            file_mesh.object_type = MeshRegistry::registerMesh(file_mesh.name, std::move(file_mesh.mesh));
+        }
+    }
+    for (const auto& mesh: mesh_by_file_type)
+    {
+        type_by_file_type[mesh.first] = static_cast<ObjectType>(file_meshes[mesh.second].object_type);
+    }
+
+    SceneFileStats stats;
+    stats.object_count = reader.objectCount();
+    stats.mesh_count = reader.meshCount();
+    stats.file_size = reader.header().file_size;
+    stats.read_seconds = secondsSince(start_time);
+
+    session.clear();
+    session.reserve(reader.objectCount());
+
+    for (size_t i = 0; i < reader.objectCount(); i++)
+    {
+        const auto& record = reader.objects()[i];
+        auto object_type = record.object_type < kBuiltinObjectTypeCount ? static_cast<ObjectType>(record.object_type)
+                                                                        : type_by_file_type[record.object_type];
+        auto& object = session.restore_object(record.id, object_type, record.rgb);
+        auto& gui_parameters = object.getObjectGuiParameters();
+
+        gui_parameters.zoom_factor_ = record.zoom_factor;
+        object.getPolygonMode() = record.polygon_mode == kPolygonModeLine ? kPolygonModeLine : kPolygonModeFill;
+        session.setSelected(i, (record.flags & kSceneObjectSelected) != 0);
+        gui_parameters.object_gui_ = (record.flags & kSceneObjectPanelOpen) != 0;
+        gui_parameters.window_x_ = record.panel_x;
+        gui_parameters.window_y_ = record.panel_y;
+
+        auto comment = reader.comment(record);
+        std::strncpy(gui_parameters.comment_, comment.c_str(), sizeof(gui_parameters.comment_) - 1);
+
+        // setTransform re-calculates the bounding box, so the zoom factor has to be restored before it.
+        object.setTransform(record.translation, record.rotation);
+    }
+
+    stats.total_seconds = secondsSince(start_time);
+    return stats;
+}
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../include/scene_stress.h"
+#include "../include/mesh_registry.h"
+#include "../include/math3d.h"
+
+
+namespace
+{
+math3d::Quat randomRotation(std::mt19937& random)
+/* Uniformly distributed rotation (K. Shoemake, "Uniform random rotations", Graphics Gems III). */
+{
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float u1 = unit(random), u2 = 2.0f * math3d::kPi * unit(random), u3 = 2.0f * math3d::kPi * unit(random);
+    float a = std::sqrt(1.0f - u1), b = std::sqrt(u1);
+    return {a * std::sin(u2), a * std::cos(u2), b * std::sin(u3), b * std::cos(u3)};
+}
+
+void randomColor(std::mt19937& random, float rgb[3])
+/* Random colour that is never too dark to see against the background. */
+{
+    std::uniform_real_distribution<float> channel(0.2f, 1.0f);
+    for (int i = 0; i < 3; i++)
+    {
+        rgb[i] = channel(random);
+    }
+}
+}
+
+
+StressStats SceneStress::populate(Session& session, const StressParameters& parameters)
+/** Removes all Objects from the session (and clears undo history, like loading a scene) and adds
+parameters.object_count generated Objects. Returns the number of Objects and the time it took. */
+{
+    auto start_time = std::chrono::steady_clock::now();
+    std::mt19937 random(parameters.seed);
+
+    // Types to choose from: built-in types with their weights, then every registered mesh with an equal share
+    // of registered_weight.
+    std::vector<ObjectType> types;
+    std::vector<float> weights;
+    for (int i = 0; i < kBuiltinObjectTypeCount; i++)
+    {
+        types.push_back(static_cast<ObjectType>(i));
+        weights.push_back(std::max(parameters.type_weights[i], 0.0f));
+    }
+    for (size_t i = 0; i < MeshRegistry::size(); i++)
+    {
+        types.push_back(static_cast<ObjectType>(kBuiltinObjectTypeCount + i));
+        weights.push_back(std::max(parameters.registered_weight, 0.0f) / MeshRegistry::size());
+    }
+    if (std::all_of(weights.begin(), weights.end(), [](float weight) {return weight <= 0.0f;}))
+    {
+        std::fill(weights.begin(), weights.begin() + kBuiltinObjectTypeCount, 1.0f);
+    }
+    std::discrete_distribution<size_t> type_distribution(weights.begin(), weights.end());
+
+    auto sample_position = [&parameters, &random](float center, float spread) {
+        if (spread <= 0.0f)
+        {
+            return center;
+        }
+        if (parameters.distribution == StressDistribution::kNormal)
+        {
+            std::normal_distribution<float> distribution(center, spread / 3.0f);
+            return distribution(random);
+        }
+        std::uniform_real_distribution<float> distribution(center - spread, center + spread);
+        return distribution(random);
+    };
+
+    // Cluster centers are spread over the whole area, Objects are spread around them within cluster_radius.
+    int cluster_count = std::max(parameters.cluster_count, 0);
+    std::vector<math3d::Vec3> cluster_centers;
+    std::vector<math3d::Vec3> cluster_colors;
+    for (int i = 0; i < cluster_count; i++)
+    {
+        math3d::Vec3 center{sample_position(0.0f, parameters.spread[0]),
+                            sample_position(0.0f, parameters.spread[1]),
+                            sample_position(0.0f, parameters.spread[2])};
+        cluster_centers.push_back(center);
+        float rgb[3];
+        randomColor(random, rgb);
+        cluster_colors.emplace_back(rgb[0], rgb[1], rgb[2]);
+    }
+    std::vector<math3d::Vec3> type_colors;
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        float rgb[3];
+        randomColor(random, rgb);
+        type_colors.emplace_back(rgb[0], rgb[1], rgb[2]);
+    }
+    std::uniform_int_distribution<int> cluster_distribution(0, std::max(cluster_count - 1, 0));
+
+    session.clear();
+    int object_count = std::max(parameters.object_count, 0);
+    session.reserve(static_cast<size_t>(object_count));
+    for (int i = 0; i < object_count; i++)
+    {
+        size_t type_index = type_distribution(random);
+
+        float translation[3];
+        float rgb[3];
+        randomColor(random, rgb);
+        if (cluster_count > 0)
+        {
+            int cluster = cluster_distribution(random);
+            const auto& center = cluster_centers[cluster];
+            translation[0] = sample_position(center.x, parameters.cluster_radius);
+            translation[1] = sample_position(center.y, parameters.cluster_radius);
+            translation[2] = parameters.spread[2] > 0.0f ? sample_position(center.z, parameters.cluster_radius)
+                                                         : 0.0f;
+            if (parameters.coloring == StressColoring::kPerCluster)
+            {
+                rgb[0] = cluster_colors[cluster].x;
+                rgb[1] = cluster_colors[cluster].y;
+                rgb[2] = cluster_colors[cluster].z;
+            }
+        }
+        else
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                translation[axis] = sample_position(0.0f, parameters.spread[axis]);
+            }
+        }
+        if (parameters.coloring == StressColoring::kPerType)
+        {
+            rgb[0] = type_colors[type_index].x;
+            rgb[1] = type_colors[type_index].y;
+            rgb[2] = type_colors[type_index].z;
+        }
+
+        float rotation[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+        if (parameters.random_rotation)
+        {
+            randomRotation(random).toRotation(rotation);
+        }
+
+        auto& object = session.restore_object(i + 1, types[type_index], rgb);
+        object.setTransform(translation, rotation);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    return {static_cast<size_t>(object_count), seconds};
+}
+
+void ZoomFlythrough::start(int frame_count)
+/** Starts a new flythrough of frame_count frames, frame times of the previous one are discarded. */
+{
+    frame_count_ = std::max(frame_count, 2);
+    frames_left_ = frame_count_;
+    stats_ = FrameStats(static_cast<size_t>(frame_count_));
+}
+
+double ZoomFlythrough::nextZoomStep()
+/** Returns the zoom step of the current frame: positive (zoom in) during the first half, negative during the
+second half, so the steps add up to zero. */
+{
+    if (frames_left_ <= 0)
+    {
+        return 0.0;
+    }
+    int half = frame_count_ / 2;
+    int frame = frame_count_ - frames_left_;
+    if (frame < half)
+    {
+        return kZoomDepth / half;
+    }
+    if (frame < 2 * half)
+    {
+        return -kZoomDepth / half;
+    }
+    return 0.0;
+}
+
+bool ZoomFlythrough::addFrameTime(double milliseconds)
+/** Records the time of the current frame and moves to the next one. Returns true if it was the last frame. */
+{
+    if (frames_left_ <= 0)
+    {
+        return false;
+    }
+    stats_.add(milliseconds);
+    frames_left_--;
+    return frames_left_ == 0;
+}
+
+std::string ZoomFlythrough::summary() const
+/** Frame time statistics of the last flythrough as one line of text. */
+{
+    char text[160];
+    snprintf(text, sizeof(text), "Zoom flythrough: %zu frames, mean %.2f ms, p50 %.2f ms, p99 %.2f ms, max %.2f ms",
+             stats_.size(), stats_.mean(), stats_.percentile(0.5), stats_.percentile(0.99), stats_.max());
+    return text;
+}
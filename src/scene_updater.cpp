@@ -0,0 +1,128 @@
+#include "../include/scene_updater.h"
+#include "../include/trace.h"
+
+
+void SceneUpdater::start(std::function<void()> on_scene_changed)
+/** Starts the update thread. */
+{
+    on_scene_changed_ = std::move(on_scene_changed);
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        running_ = true;
+        snapshot_requested_ = true;
+    }
+    thread_ = std::thread(&SceneUpdater::run_, this);
+}
+
+void SceneUpdater::stop()
+/** Stops the update thread, commands that are still queued are dropped. */
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        running_ = false;
+    }
+    wake_up_.notify_one();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+void SceneUpdater::enqueue(SceneCommand command)
+/** Queues a command for the update thread and wakes it up. */
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        commands_.push_back(std::move(command));
+    }
+    wake_up_.notify_one();
+}
+
+void SceneUpdater::requestSnapshot()
+/** Asks the update thread to publish a new snapshot, e.g. after the GUI has changed Objects. */
+{
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        snapshot_requested_ = true;
+    }
+    wake_up_.notify_one();
+}
+
+bool SceneUpdater::applyQueuedCommands()
+/** Applies all queued commands in the order they were queued. Returns true if any command was applied. */
+{
+    std::vector<SceneCommand> commands;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        commands.swap(commands_);
+    }
+
+    for (const auto& command: commands)
+    {
+        applyCommand(session_, command);
+    }
+    return !commands.empty();
+}
+
+void SceneUpdater::applyCommand(Session& session, const SceneCommand& command)
+/** Applies a single command to Session on the calling thread. */
+{
+    switch (command.type)
+    {
+        case SceneCommand::kMove:
+            session.updateObjectsCoordinates(command.objects, command.delta_x, command.delta_y);
+            break;
+        case SceneCommand::kRotate:
+            session.updateObjectsRotation(command.objects, command.delta_x, command.delta_y);
+            break;
+        case SceneCommand::kMoveGuiPanels:
+            session.updateObjectsGuiCoordinates(command.objects, command.window_width,
+                                                command.window_height, command.delta_x, command.delta_y);
+            break;
+        case SceneCommand::kCloseHistoryEntry:
+            session.getHistory().closeEntry();
+            break;
+    }
+}
+
+const RenderSnapshot& SceneUpdater::latestSnapshot()
+{
+    snapshots_.update();
+    return snapshots_.readBuffer();
+}
+
+void SceneUpdater::run_()
+/** Loop of the update thread: sleeps until there are commands or a snapshot is requested, applies commands and
+publishes a snapshot of the scene. */
+{
+    Trace::setThreadName("scene update");
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            wake_up_.wait(lock, [this] {return !running_ || snapshot_requested_ || !commands_.empty();});
+            if (!running_)
+            {
+                return;
+            }
+            snapshot_requested_ = false;
+        }
+
+        bool scene_changed;
+        {
+            PROJECT_1_TRACE_ZONE("SceneUpdater::update");
+            std::lock_guard<std::mutex> session_lock(session_.getMutex());
+            scene_changed = applyQueuedCommands();
+
+            auto& snapshot = snapshots_.writeBuffer();
+            snapshot.structure_version = session_.getStructureVersion();
+            session_.fillDrawItems(snapshot.items);
+        }
+        snapshots_.publish();
+
+        if (scene_changed && on_scene_changed_)
+        {
+            on_scene_changed_();
+        }
+    }
+}
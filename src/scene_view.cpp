@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cmath>
+
+#include "../include/scene_view.h"
+
+
+void SceneView::setRect(int x, int y, int width, int height, int window_height)
+/** Places the view in the window (window coordinates, y pointing down) and adapts its projection to the aspect ratio
+of the rectangle. */
+{
+    x_ = x;
+    y_ = y;
+    width_ = std::max(width, 1);
+    height_ = std::max(height, 1);
+    window_height_ = window_height;
+    updateMatrices_();
+}
+
+void SceneView::zoom(double zooming_factor)
+/** Adjusts the viewing boundaries of the view to achieve zooming in or out, like DrawingLib::zoom did for the single
+view before. */
+{
+    left_ += zooming_factor;
+    right_ -= zooming_factor;
+    top_ -= zooming_factor;
+    bottom_ += zooming_factor;
+    updateMatrices_();
+}
+
+void SceneView::orbit(double delta_yaw, double delta_pitch)
+/** Turns the camera around the scene origin by the given angles in degrees. Pitch stays between -90 and 90 degrees,
+so the scene never turns upside down. */
+{
+    setOrbit(yaw_ + static_cast<float>(delta_yaw), pitch_ + static_cast<float>(delta_pitch));
+}
+
+void SceneView::setOrbit(float yaw, float pitch)
+{
+    yaw_ = std::fmod(yaw, 360.0f);
+    pitch_ = std::min(std::max(pitch, -90.0f), 90.0f);
+    updateMatrices_();
+}
+
+bool SceneView::contains(double x, double y) const
+{
+    return x >= x_ && x < x_ + width_ && y >= y_ && y < y_ + height_;
+}
+
+math3d::Viewport SceneView::getGlViewport() const
+{
+    return {static_cast<float>(x_), static_cast<float>(window_height_ - y_ - height_),
+            static_cast<float>(width_), static_cast<float>(height_)};
+}
+
+void SceneView::updateMatrices_()
+/** Re-computes the matrices and the frustum planes after the rectangle, the viewing boundaries or the orbit have
+changed. */
+{
+    const float dim_ratio = static_cast<float>(height_) / static_cast<float>(width_);
+    auto left = static_cast<float>(left_);
+    auto right = static_cast<float>(right_);
+    auto bottom = static_cast<float>(bottom_) * dim_ratio;
+    auto top = static_cast<float>(top_) * dim_ratio;
+    auto depth = static_cast<float>(depth_correction_factor_);
+
+    // Perspective projection: the view frustum is a truncated pyramid between the near and far planes.
+    projection_matrix_ = math3d::Mat4::frustum(left, right, bottom, top,
+                                               static_cast<float>(near_), static_cast<float>(far_));
+
+    // The scene is turned around its origin (yaw, then pitch) and moved away from the camera, so Objects around
+    // z = 0 are inside the frustum.
+    const float yaw = math3d::radians(yaw_), pitch = math3d::radians(pitch_);
+    const float cos_yaw = std::cos(yaw), sin_yaw = std::sin(yaw);
+    const float cos_pitch = std::cos(pitch), sin_pitch = std::sin(pitch);
+    const float rotation[9] = {cos_yaw, 0.0f, sin_yaw,
+                               sin_pitch * sin_yaw, cos_pitch, -sin_pitch * cos_yaw,
+                               -cos_pitch * sin_yaw, sin_pitch, cos_pitch * cos_yaw};
+    view_matrix_ = math3d::Mat4::translation(0.0f, 0.0f, -depth) * math3d::Mat4::rotation(rotation);
+
+    const math3d::Mat4 view_projection = projection_matrix_ * view_matrix_;
+    if (!math3d::inverse(view_projection, inverse_view_projection_))
+    {
+        inverse_view_projection_ = math3d::Mat4();
+    }
+
+    // Planes of the frustum are sums and differences of the rows of the view-projection matrix
+    // (-w <= x, y, z <= w in clip space): left, right, bottom, top, near, far.
+    for (int axis = 0; axis < 3; axis++)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            float sign = side == 0 ? 1.0f : -1.0f;
+            frustum_planes_[axis * 2 + side] = {view_projection(3, 0) + sign * view_projection(axis, 0),
+                                                view_projection(3, 1) + sign * view_projection(axis, 1),
+                                                view_projection(3, 2) + sign * view_projection(axis, 2),
+                                                view_projection(3, 3) + sign * view_projection(axis, 3)};
+        }
+    }
+}
+
+void SceneView::cull(const std::vector<ObjectDrawItem>& items, std::vector<VisibleItem>& visible_items,
+                     ViewStats& stats) const
+/** Fills visible_items with the draw items this view has to draw and adds the counts to stats.
+A bounding box is outside of the frustum if its corner farthest along the normal of one of the planes is outside of
+it; boxes near a corner of the frustum may be kept although they are outside, they are only drawn for nothing.
+The size on the screen is the diameter of the sphere around the bounding box, divided by its distance from the
+camera (w in clip space), so it is never smaller than the Object really is. */
+{
+    stats.views++;
+    visible_items.clear();
+
+    const math3d::Mat4 view_projection = projection_matrix_ * view_matrix_;
+    // Pixels covered by one unit at distance one from the camera, vertically.
+    const float pixels_per_unit = projection_matrix_(1, 1) * 0.5f * static_cast<float>(height_);
+
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        stats.objects++;
+        const auto& box = items[i].bounding_box;
+
+        bool outside = false;
+        for (const auto& plane: frustum_planes_)
+        {
+            float x = plane.x >= 0.0f ? box.maxX : box.minX;
+            float y = plane.y >= 0.0f ? box.maxY : box.minY;
+            float z = plane.z >= 0.0f ? box.maxZ : box.minZ;
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f)
+            {
+                outside = true;
+                break;
+            }
+        }
+        if (outside)
+        {
+            stats.outside_frustum++;
+            continue;
+        }
+
+        const math3d::Vec3 center((box.minX + box.maxX) * 0.5f, (box.minY + box.maxY) * 0.5f,
+                                  (box.minZ + box.maxZ) * 0.5f);
+        const float radius = 0.5f * math3d::length({box.maxX - box.minX, box.maxY - box.minY, box.maxZ - box.minZ});
+        const float distance = view_projection.transform(math3d::Vec4(center, 1.0f)).w;
+
+        ObjectDetail detail = ObjectDetail::kFull;
+        // Objects that reach the camera plane have no meaningful size on the screen, they are drawn in full.
+        if (distance > radius)
+        {
+            float pixel_size = 2.0f * radius * pixels_per_unit / distance;
+            if (pixel_size < kMinPixelSize)
+            {
+                stats.too_small++;
+                continue;
+            }
+            if (pixel_size < kEdgePixelSize)
+            {
+                detail = ObjectDetail::kWithoutEdges;
+                stats.without_edges++;
+            }
+        }
+        visible_items.push_back({static_cast<int>(i), detail});
+        stats.drawn++;
+    }
+}
@@ -0,0 +1,118 @@
+#include <algorithm>
+
+#include "../include/selection_set.h"
+
+
+void SelectionSet::resize(size_t size)
+/** Changes the number of bits, new bits are not set. */
+{
+    size_ = size;
+    words_.resize((size + kWordBits - 1) / kWordBits, 0);
+    clearUnusedBits_();
+}
+
+void SelectionSet::pushBack(bool value)
+/** Adds a bit at the end, e.g. for a new Object. */
+{
+    resize(size_ + 1);
+    set(size_ - 1, value);
+}
+
+void SelectionSet::erase(size_t index)
+/** Removes a bit and shifts all following bits down by one, like erasing an element of a vector, so bits stay
+in sync with indices of Objects. */
+{
+    size_t word_index = index / kWordBits;
+    size_t bit = index % kWordBits;
+
+    // In the word of the erased bit, lower bits stay and higher bits move down by one.
+    uint64_t word = words_[word_index];
+    uint64_t lower_mask = (uint64_t{1} << bit) - 1;
+    uint64_t higher = bit + 1 < kWordBits ? (word >> (bit + 1)) << bit : 0;
+    words_[word_index] = (word & lower_mask) | higher;
+
+    // Following words move down by one bit, their lowest bit goes to the top of the previous word.
+    for (size_t i = word_index + 1; i < words_.size(); i++)
+    {
+        words_[i - 1] |= (words_[i] & 1u) << (kWordBits - 1);
+        words_[i] >>= 1;
+    }
+    resize(size_ - 1);
+}
+
+void SelectionSet::setAll()
+{
+    std::fill(words_.begin(), words_.end(), ~uint64_t{0});
+    clearUnusedBits_();
+}
+
+void SelectionSet::resetAll()
+{
+    std::fill(words_.begin(), words_.end(), 0);
+}
+
+void SelectionSet::invert()
+{
+    for (auto& word: words_)
+    {
+        word = ~word;
+    }
+    clearUnusedBits_();
+}
+
+void SelectionSet::intersect(const SelectionSet& other)
+/** Keeps only bits that are set in both sets. Bits beyond the size of other are reset. */
+{
+    size_t common = std::min(words_.size(), other.words_.size());
+    for (size_t i = 0; i < common; i++)
+    {
+        words_[i] &= other.words_[i];
+    }
+    std::fill(words_.begin() + common, words_.end(), 0);
+}
+
+void SelectionSet::unite(const SelectionSet& other)
+/** Sets bits that are set in other. Bits of other beyond the size of this set are ignored. */
+{
+    size_t common = std::min(words_.size(), other.words_.size());
+    for (size_t i = 0; i < common; i++)
+    {
+        words_[i] |= other.words_[i];
+    }
+    clearUnusedBits_();
+}
+
+size_t SelectionSet::count() const
+/** Number of set bits. */
+{
+    size_t result = 0;
+    for (auto word: words_)
+    {
+        result += popCount_(word);
+    }
+    return result;
+}
+
+bool SelectionSet::any() const
+{
+    return std::any_of(words_.begin(), words_.end(), [](uint64_t word) {return word != 0;});
+}
+
+std::vector<int> SelectionSet::toIndices() const
+/** Indices of set bits in increasing order. */
+{
+    std::vector<int> indices;
+    indices.reserve(count());
+    indices.assign(begin(), end());
+    return indices;
+}
+
+void SelectionSet::clearUnusedBits_()
+/** Bits of the last word beyond size_ are always zero, so whole-word operations don't need to mask them. */
+{
+    size_t used_bits = size_ % kWordBits;
+    if (used_bits != 0)
+    {
+        words_.back() &= (uint64_t{1} << used_bits) - 1;
+    }
+}
@@ -1,7 +1,10 @@
 #include <algorithm>
+#include <cstring>
 #include "logger.h"
 
 #include "../include/session.h"
+#include "../include/frame_scheduler.h"
+#include "../include/mesh_buffer_cache.h"
 
 
 void Session::loadAllObjectsBuffers()
@@ -17,79 +20,196 @@ void Session::add_object(ObjectType object_type)
 manipulations with drawn object. Then adds it to the objects_ vector.
 Also, adds an info message to logger with id and type of created object. */
 {
+    FrameScheduler::requestRedraw();
     current_object_id_ = current_object_id_ + 1;
-    generateNewPickColor_();
 
-    auto pick_color_id = generatePickColorID_();
-    auto new_object = Object(current_object_id_, pick_color_id, object_type, 1, 0,0, current_pick_color_[0], current_pick_color_[1], current_pick_color_[2]);
+    auto pick_id = acquirePickId_(objects_.size());
+    unsigned char pick_color[3];
+    PickIdAllocator::toColor(pick_id, pick_color);
+    auto new_object = Object(current_object_id_, static_cast<int>(pick_id), object_type, 1, 0,0, pick_color[0], pick_color[1], pick_color[2]);
 
+    new_object.setGpuResident(gpu_resident_objects_);
     new_object.loadObjectBuffers();
     objects_.push_back(std::move(new_object));
+    selection_.pushBack(false);
+    structure_version_++;
+
+    HistoryEntry entry{HistoryCommand::kCreate};
+    entry.objects.push_back(captureObjectState(objects_.back()));
+    history_.record(std::move(entry));
 
     std::string logger_message = "An object type " + new_object.ObjectTypeToString() + " is created.";
     Logger::addMessage(LogLevel::Info, logger_message.c_str());
 }
 
-void Session::drawAllObjects(bool get_pick_color)
-/** Iterates through the vector of objects and applies member function to draw every object. */
+void Session::addObjects(ObjectType object_type, int count, const ObjectLayout& layout)
+/** Creates count Objects of object_type at once, placed by layout. Unlike calling add_object count times, objects_
+grows at most once, the mesh is summarized once for all of them (see Object::summarizeMesh), the scene changes once,
+and there is one undo step and one message in logger. Objects have no buffers of their own, so the mesh is uploaded
+at most once and nothing else is uploaded. */
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    FrameScheduler::requestRedraw();
+
+    const size_t first_index = objects_.size();
+    objects_.reserve(first_index + static_cast<size_t>(count));
+    const MeshSummary mesh_summary = Object::summarizeMesh(object_type);
+
+    const int columns = layout.columns > 0 ? layout.columns : 1;
+    const int rows = (count + columns - 1) / columns;
+    HistoryEntry entry{HistoryCommand::kCreate};
+    entry.objects.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; i++)
+    {
+        current_object_id_ = current_object_id_ + 1;
+        auto pick_id = acquirePickId_(objects_.size());
+        unsigned char pick_color[3];
+        PickIdAllocator::toColor(pick_id, pick_color);
+        objects_.emplace_back(current_object_id_, static_cast<int>(pick_id), object_type, 1.0f, 0.0f, 0.0f,
+                              pick_color[0], pick_color[1], pick_color[2], mesh_summary);
+
+        auto& object = objects_.back();
+        object.setGpuResident(gpu_resident_objects_);
+        object.loadObjectBuffers();
+        float translation[3] = {layout.center[0], layout.center[1], 0.0f};
+        if (layout.columns > 0)
+        {
+            translation[0] += (static_cast<float>(i % columns) - 0.5f * static_cast<float>(columns - 1)) *
+                              layout.spacing;
+            translation[1] += (0.5f * static_cast<float>(rows - 1) - static_cast<float>(i / columns)) *
+                              layout.spacing;
+        }
+        object.translate(translation);
+        entry.objects.push_back(captureObjectState(object));
+    }
+    selection_.resize(objects_.size());
+    structure_version_++;
+    history_.record(std::move(entry));
+
+    std::string logger_message = std::to_string(count) + " objects of type " +
+                                 objects_[first_index].ObjectTypeToString() + " are created.";
+    Logger::addMessage(LogLevel::Info, logger_message.c_str());
+}
+
+Object& Session::restore_object(int id, ObjectType object_type, const GLfloat rgb[3])
+/** Creates an Object with an id that was assigned earlier (e.g. in a saved scene) and adds it to the objects_ vector.
+Pick color is always generated anew. Unlike add_object, no message is added to logger, because objects are usually
+restored in large numbers. */
 {
+    FrameScheduler::requestRedraw();
+    current_object_id_ = std::max(current_object_id_, id);
+
+    auto pick_id = acquirePickId_(objects_.size());
+    unsigned char pick_color[3];
+    PickIdAllocator::toColor(pick_id, pick_color);
+    objects_.emplace_back(id, static_cast<int>(pick_id), object_type, rgb[0], rgb[1], rgb[2],
+                          pick_color[0], pick_color[1], pick_color[2]);
+    objects_.back().setGpuResident(gpu_resident_objects_);
+    objects_.back().loadObjectBuffers();
+    selection_.pushBack(false);
+    structure_version_++;
+    return objects_.back();
+}
+
+void Session::clear()
+/** Deletes buffers of all Objects and removes them from the session. */
+{
+    FrameScheduler::requestRedraw();
     for (auto& object: objects_)
     {
-        object.draw(get_pick_color);
+        object.reset();
     }
+    objects_.clear();
+    selection_.resize(0);
+    pick_ids_.clear();
+    object_index_by_pick_id_.clear();
+    structure_version_++;
+    clear_count_++;
+    // Entries reference Objects that no longer exist.
+    history_.clear();
 }
 
-void Session::drawAllObjectsMetadata()
-/** Iterates through the vector of objects and applies member function to draw (print) metadata of every object. */
+void Session::setVertexFormat(VertexFormat vertex_format)
+/** Uploads the shared meshes of all Objects again in vertex_format (see MeshBufferCache). Draw items made before
+decode positions of the old format, so the structure version changes and they are made again; the mutex has to be
+held on the thread of the OpenGL context. */
+{
+    if (vertex_format == MeshBufferCache::getVertexFormat())
+    {
+        return;
+    }
+    FrameScheduler::requestRedraw();
+    MeshBufferCache::setVertexFormat(vertex_format);
+    structure_version_++;
+}
+
+void Session::compactMeshBuffers()
+/** Moves the meshes of all Objects together in the shared buffers (see MeshBufferCache::compact). Draw items made
+before have the old offsets, so the structure version changes like in setVertexFormat; the mutex has to be held on
+the thread of the OpenGL context. */
+{
+    FrameScheduler::requestRedraw();
+    MeshBufferCache::compact();
+    structure_version_++;
+}
+
+void Session::setGpuResidentObjects(bool gpu_resident)
+/** Makes all Objects, and Objects created later, GPU-resident or not (see Object::setGpuResident). Buffers don't
+change, so nothing has to be drawn again. */
 {
+    gpu_resident_objects_ = gpu_resident;
     for (auto& object: objects_)
     {
-        object.drawMetadataText();
+        object.setGpuResident(gpu_resident);
     }
 }
 
-void Session::generateNewPickColor_()
-/** Generates a new pick color by incrementing the RGB values by 10.
-If a component reaches 255, it resets to 0 and increments the previous component. */
+void Session::fillDrawItems(std::vector<ObjectDrawItem>& items) const
+/** Fills a draw item for every object, in the same order as objects_. */
 {
-    for (int i = 2; i >= 0; --i)
+    items.resize(objects_.size());
+    for (size_t i = 0; i < objects_.size(); i++)
     {
-        if (current_pick_color_[i] < 255)
-        {
-            current_pick_color_[i] += 10;
-            return;
-        }
-        if (current_pick_color_[i] == 255)
-        {
-            current_pick_color_[i] = 0;
-            current_pick_color_[i - 1]++;
-            return;
-        }
+        objects_[i].fillDrawItem(items[i]);
+        items[i].selected = selection_.test(i);
     }
 }
 
-int Session::generatePickColorID_()
-/** Calculates pick color id using with the formula: R*256^2 + G*256^1 + B*256^0. Afterwards, pick_color_id is assigned
-to an Object instance. */
+void Session::drawAllObjectsMetadata()
+/** Iterates through the vector of objects and applies member function to draw (print) metadata of every object. */
 {
-    int pick_color_id = current_pick_color_[0] * (256 * 256) + current_pick_color_[1] * 256 +
-                        current_pick_color_[2];
-    return pick_color_id;
+    for (auto& object: objects_)
+    {
+        object.drawMetadataText();
+    }
 }
 
-int Session::getObjectIdByPickColor(const unsigned char* pick_color)
-/** Calculates pick_color_id for a colour values (see formula above), iterates through the vector of Objects to get an id
-of an Object with specified pick colour. */
+uint32_t Session::acquirePickId_(size_t object_index)
+/** Allocates a pick id for an Object that will be placed at object_index and records it in the id -> index table. */
 {
-    int pick_color_id = pick_color[0] * (256 * 256) + pick_color[1] * 256 + pick_color[2];
-    for (std::vector<Object>::size_type i = 0; i < objects_.size(); i++)
+    uint32_t pick_id = pick_ids_.acquire();
+    if (object_index_by_pick_id_.size() <= pick_id)
     {
-        if (objects_[i].checkPickColor(pick_color_id))
-        {
-            return static_cast<int>(i);
-        }
+        object_index_by_pick_id_.resize(pick_id + 1, -1);
+    }
+    object_index_by_pick_id_[pick_id] = static_cast<int>(object_index);
+    return pick_id;
+}
+
+int Session::getObjectIdByPickColor(const unsigned char* pick_color) const
+/** Converts a colour read from the pick pass to a pick id (see PickIdAllocator) and returns the index of the Object
+with this id, or -1 for the background and colours that don't belong to any Object. The table is indexed directly
+by the id, so the lookup doesn't depend on the number of Objects. */
+{
+    uint32_t pick_id = PickIdAllocator::fromColor(pick_color);
+    if (pick_id >= object_index_by_pick_id_.size())
+    {
+        return -1;
     }
-    return -1;
+    return object_index_by_pick_id_[pick_id];
 }
 
 void Session::reset()
@@ -101,13 +221,20 @@ void Session::reset()
     }
 }
 
-void Session::updateObjectsCoordinates(const std::vector<int>& object_ids, double delta_x, double delta_y)
-/** Iterates through the vector of object_ids and applies Object member function to update vertices coordinates
+void Session::updateObjectsCoordinates(const SelectionSet& objects, double delta_x, double delta_y)
+/** Iterates through indices of set bits in objects and applies Object member function to update coordinates
 of the corresponding Objects. It moves x- and y- coordinates by x_delta and y_delta of mouse cursor position. */
 {
-    for (auto object_id : object_ids){
+    FrameScheduler::requestRedraw();
+    for (auto object_id : objects){
         objects_[object_id].updateObjectCoordinates(delta_x, delta_y);
     }
+
+    // The same translation as in Object::updateObjectCoordinates (screen y-axis goes down).
+    HistoryEntry entry{HistoryCommand::kTranslate, objectIdsByIndices_(objects)};
+    entry.values[0] = static_cast<float>(delta_x);
+    entry.values[1] = -static_cast<float>(delta_y);
+    history_.record(std::move(entry));
 }
 
 void Session::remove_object(int object_id)
@@ -117,86 +244,326 @@ Technically every Object in the vector objects_ has 2 ids:
     - id assigned to Object when the instance is created.
 They are not always the same. Index in the vector objects_ is used to define which Object to remove. */
 {
+    FrameScheduler::requestRedraw();
     std::string logger_message = "An object #" + objects_[object_id].ObjectIdToString() +
                                 " type " + objects_[object_id].ObjectTypeToString() +
                                 " is removed.";
     if (objects_.size() > object_id)
     {
-        objects_.erase(objects_.begin() + object_id);
+        HistoryEntry entry{HistoryCommand::kRemove};
+        entry.objects.push_back(captureObjectState(objects_[object_id]));
+        history_.record(std::move(entry));
+
+        eraseObject_(object_id);
     }
 
     Logger::addMessage(LogLevel::Info, logger_message.c_str());
 }
 
-void Session::updateObjectsRotation(const std::vector<int>& object_ids, double delta_x, double delta_y)
-/** Iterates through the vector of object_ids and applies an Object member function
+void Session::updateObjectsRotation(const SelectionSet& objects, double delta_x, double delta_y)
+/** Iterates through indices of set bits in objects and applies an Object member function
 to update the vertices coordinates of the corresponding Objects.
 It calculates the center of the Object, the angle of rotation based on the x_delta and y_delta
 of the mouse cursor position, and rotates the coordinates of the vertices by the calculated angle. */
 {
-    for (auto object_id : object_ids){
-        objects_[object_id].updateObjectRotation(delta_x, delta_y);
+    FrameScheduler::requestRedraw();
+    // The rotation is the same for all Objects, so it's calculated once.
+    HistoryEntry entry{HistoryCommand::kRotate, objectIdsByIndices_(objects)};
+    Object::calculateRotationDelta(delta_x, delta_y, entry.values);
+
+    for (auto object_id : objects){
+        objects_[object_id].applyRotation(entry.values);
     }
+    history_.record(std::move(entry));
 }
 
-std::vector<int> Session::getSelectedObjects()
-/** Iterates through the vector of Objects, if Object's variable selected_ is true, adds its id to the vector
-selected_objects_id and returns this vector. */
+void Session::setSelected(size_t object_index, bool selected)
 {
-    std::vector<int> selected_objects_id{};
+    FrameScheduler::requestRedraw();
+    selection_.set(object_index, selected);
+}
 
-    for (int i=0; i < objects_.size(); i += 1)
-    {
-        if (objects_[i].getSelected())
-        {
-            selected_objects_id.push_back(i);
-        }
+void Session::deSelectAllObjects()
+/** Resets all bits of the selection. */
+{
+    FrameScheduler::requestRedraw();
+    selection_.resetAll();
+}
+
+void Session::selectAllObjects()
+/** Sets all bits of the selection. */
+{
+    FrameScheduler::requestRedraw();
+    selection_.setAll();
+}
+
+void Session::invertSelection()
+/** Selects all Objects that are not selected and deselects all that are. */
+{
+    FrameScheduler::requestRedraw();
+    selection_.invert();
+}
+
+void Session::selectObjectsInFrame(const std::vector<int> &object_ids)
+/** Adds Objects with indices from object_ids (e.g. found inside the selection rectangle) to the selection. */
+{
+    FrameScheduler::requestRedraw();
+    for (auto object_id : object_ids){
+        selection_.set(object_id);
+    }
+}
+
+void Session::updateObjectsGuiCoordinates(const SelectionSet& objects, float window_width, float window_height,
+                                         double delta_x, double delta_y)
+/** Iterates through indices of set bits in objects and applies Object member function to update coordinates of
+individual ImGui panel of an Object. Main window height and width are taken into consideration to keep it in
+window limits. */
+{
+    FrameScheduler::requestRedraw();
+    for (auto object_id : objects){
+        objects_[object_id].updateGuiWindowDeltaCoordinates(window_width, window_height, delta_x, delta_y);
     }
+}
+
+void Session::recordColorChange(int object_index, const float rgb_before[3])
+/** Records a change of colour of an Object from rgb_before to its current colour.
+The colour itself is changed by the GUI, this only makes the change undoable. */
+{
+    const auto& object = objects_[object_index];
+    HistoryEntry entry{HistoryCommand::kColor, {object.getId()}};
+    std::memcpy(entry.values, rgb_before, 3 * sizeof(float));
+    std::memcpy(entry.values + 3, object.getObjectColor(), 3 * sizeof(float));
+    history_.record(std::move(entry));
+}
 
-    return selected_objects_id;
+void Session::recordCommentChange(int object_index, const std::string& comment_before)
+/** Records a change of comment of an Object from comment_before to its current comment. */
+{
+    const auto& object = objects_[object_index];
+    HistoryEntry entry{HistoryCommand::kComment, {object.getId()}};
+    entry.text_before = comment_before;
+    entry.text_after = object.getObjectGuiParameters().comment_;
+    history_.record(std::move(entry));
 }
 
-void Session::deSelectAllObjects()
-/** Iterates through the vector of Objects and if Object's variable selected_ is true, switch it to false. */
+void Session::resetObjectTransform(int object_index)
+/** Returns an Object to the default position, rotation and size (see Object::resetObjectVertices) as an undoable
+step. The transform before and after is stored, so moves made before the reset are undone from the right place. */
 {
-    for (auto &object: objects_)
+    FrameScheduler::requestRedraw();
+    auto& object = objects_[object_index];
+    HistoryEntry entry{HistoryCommand::kTransform, {object.getId()}};
+    entry.objects.push_back(captureObjectState(object));
+    object.resetObjectVertices();
+    entry.objects.push_back(captureObjectState(object));
+    history_.record(std::move(entry));
+}
+
+bool Session::undo()
+/** Reverts the last recorded change. Returns false if there is nothing to undo. */
+{
+    if (!history_.canUndo())
     {
-        if (object.getSelected()){
-            object.switchSelected();
-        }
+        return false;
     }
+    applyHistoryEntry_(history_.nextUndo(), true);
+    history_.finishUndo();
+    FrameScheduler::requestRedraw();
+    return true;
 }
 
-void Session::selectAllObjects()
-/** Iterates through the vector of Objects and if Object's variable selected_ is false, switch it to true. */
+bool Session::redo()
+/** Applies the last undone change again. Returns false if there is nothing to redo. */
 {
-    for (auto &object: objects_)
+    if (!history_.canRedo())
     {
-        if (!object.getSelected()){
-            object.switchSelected();
-        }
+        return false;
     }
+    applyHistoryEntry_(history_.nextRedo(), false);
+    history_.finishRedo();
+    FrameScheduler::requestRedraw();
+    return true;
 }
 
-void Session::selectObjectsInFrame(const std::vector<int> &object_ids)
-/** Iterates through the vector of object_ids and if Object's variable selected_ is false, switch it to true. */
+void Session::applyHistoryEntry_(const HistoryEntry& entry, bool undo)
+/** Applies a history entry forwards (redo) or backwards (undo). Objects are found by id through a map that is built
+once per entry, so an entry that changes thousands of Objects is applied in a single pass. */
 {
-    for (auto object_id : object_ids){
-        if (!objects_[object_id].getSelected()) {
-            objects_[object_id].switchSelected();
+    switch (entry.command)
+    {
+        case HistoryCommand::kTranslate:
+        case HistoryCommand::kRotate:
+        {
+            const float sign = undo ? -1.0f : 1.0f;
+            const float translation[3] = {sign * entry.values[0], sign * entry.values[1], sign * entry.values[2]};
+            // The inverse of a rotation matrix is its transpose.
+            const float* values = entry.values;
+            const float transposed[9] = {values[0], values[3], values[6],
+                                         values[1], values[4], values[7],
+                                         values[2], values[5], values[8]};
+            auto indices = indicesById_();
+            for (auto id: entry.object_ids)
+            {
+                auto it = indices.find(id);
+                if (it == indices.end())
+                {
+                    continue;
+                }
+                if (entry.command == HistoryCommand::kTranslate)
+                {
+                    objects_[it->second].translate(translation);
+                }
+                else
+                {
+                    objects_[it->second].applyRotation(undo ? transposed : values);
+                }
+            }
+            break;
+        }
+        case HistoryCommand::kColor:
+        case HistoryCommand::kComment:
+        {
+            auto indices = indicesById_();
+            auto it = indices.find(entry.object_ids.front());
+            if (it == indices.end())
+            {
+                break;
+            }
+            auto& object = objects_[it->second];
+            if (entry.command == HistoryCommand::kColor)
+            {
+                std::memcpy(object.getObjectColor(), entry.values + (undo ? 0 : 3), 3 * sizeof(float));
+            }
+            else
+            {
+                auto& comment = object.getObjectGuiParameters().comment_;
+                std::strncpy(comment, (undo ? entry.text_before : entry.text_after).c_str(), sizeof(comment) - 1);
+                comment[sizeof(comment) - 1] = '\0';
+            }
+            break;
+        }
+        case HistoryCommand::kTransform:
+        {
+            auto indices = indicesById_();
+            auto it = indices.find(entry.object_ids.front());
+            if (it == indices.end())
+            {
+                break;
+            }
+            auto& object = objects_[it->second];
+            const auto& state = entry.objects[undo ? 0 : 1];
+            // setTransform re-calculates the bounding box, so the zoom factor has to be set before it.
+            object.getObjectGuiParameters().zoom_factor_ = state.zoom_factor;
+            object.setTransform(state.translation, state.rotation);
+            break;
         }
+        case HistoryCommand::kCreate:
+        case HistoryCommand::kRemove:
+        {
+            // Undoing a creation and redoing a removal delete Objects, the other two directions restore them.
+            bool restore = (entry.command == HistoryCommand::kRemove) == undo;
+            if (restore)
+            {
+                for (const auto& state: entry.objects)
+                {
+                    restoreObjectState(state);
+                }
+            }
+            else
+            {
+                auto indices = indicesById_();
+                std::vector<size_t> erase_indices;
+                for (const auto& state: entry.objects)
+                {
+                    auto it = indices.find(state.id);
+                    if (it != indices.end())
+                    {
+                        erase_indices.push_back(it->second);
+                    }
+                }
+                // Erasing from the back keeps the remaining indices valid.
+                std::sort(erase_indices.rbegin(), erase_indices.rend());
+                for (auto index: erase_indices)
+                {
+                    eraseObject_(index);
+                }
+            }
+            break;
+        }
+    }
+}
 
+std::vector<int> Session::objectIdsByIndices_(const SelectionSet& objects) const
+{
+    std::vector<int> object_ids;
+    object_ids.reserve(objects.count());
+    for (auto index: objects)
+    {
+        object_ids.push_back(objects_[index].getId());
     }
+    return object_ids;
 }
 
-void Session::updateObjectsGuiCoordinates(const std::vector<int> &object_ids, float window_width, float window_height,
-                                         double delta_x, double delta_y)
-/** Iterates through the vector of object_ids and applies Object member function to update coordinates of individual
-ImGui panel of an Object. Main window height and width are taken into consideration to keep it in window limits. */
+std::unordered_map<int, size_t> Session::indicesById_() const
 {
-    for (auto object_id : object_ids){
-        objects_[object_id].updateGuiWindowDeltaCoordinates(window_width, window_height, delta_x, delta_y);
+    std::unordered_map<int, size_t> indices;
+    indices.reserve(objects_.size());
+    for (size_t i = 0; i < objects_.size(); i++)
+    {
+        indices.emplace(objects_[i].getId(), i);
     }
+    return indices;
+}
+
+ObjectState Session::captureObjectState(const Object& object) const
+{
+    ObjectState state{object.getId(), object.getObjectType()};
+    std::memcpy(state.rgb, object.getObjectColor(), sizeof(state.rgb));
+    std::memcpy(state.translation, object.getTranslation(), sizeof(state.translation));
+    std::memcpy(state.rotation, object.getRotation(), sizeof(state.rotation));
+    state.zoom_factor = object.getObjectGuiParameters().zoom_factor_;
+    state.polygon_mode = object.getPolygonMode();
+    state.comment = object.getObjectGuiParameters().comment_;
+    return state;
 }
 
+void Session::restoreObjectState(const ObjectState& state)
+/** Creates an Object again from its saved state, with the same id. */
+{
+    restore_object(state.id, state.object_type, state.rgb);
+    applyObjectState(objects_.size() - 1, state);
+}
 
+void Session::applyObjectState(size_t object_index, const ObjectState& state)
+/** Sets colour, transform, zoom factor, polygon mode and comment of an existing Object from state; its id and type
+are kept. */
+{
+    FrameScheduler::requestRedraw();
+    auto& object = objects_[object_index];
+    std::memcpy(object.getObjectColor(), state.rgb, sizeof(state.rgb));
+    auto& gui_parameters = object.getObjectGuiParameters();
+    // setTransform re-calculates the bounding box, so the zoom factor has to be set before it.
+    gui_parameters.zoom_factor_ = state.zoom_factor;
+    std::strncpy(gui_parameters.comment_, state.comment.c_str(), sizeof(gui_parameters.comment_) - 1);
+    gui_parameters.comment_[sizeof(gui_parameters.comment_) - 1] = '\0';
+    object.getPolygonMode() = state.polygon_mode;
+    object.setTransform(state.translation, state.rotation);
+}
+
+void Session::eraseObject_(size_t object_index)
+/** Deletes buffers of an Object and removes it from the objects_ vector. */
+{
+    auto pick_id = static_cast<uint32_t>(objects_[object_index].getPickId());
+    pick_ids_.release(pick_id);
+    object_index_by_pick_id_[pick_id] = -1;
+
+    objects_[object_index].reset();
+    objects_.erase(objects_.begin() + static_cast<long>(object_index));
+    selection_.erase(object_index);
+    // Objects after the erased one have moved down by one.
+    for (size_t i = object_index; i < objects_.size(); i++)
+    {
+        object_index_by_pick_id_[objects_[i].getPickId()] = static_cast<int>(i);
+    }
+    structure_version_++;
+}
@@ -0,0 +1,235 @@
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "../include/json_writer.h"
+#include "../include/trace.h"
+
+namespace
+{
+// Every thread keeps the last kEventsPerThread zones (about 400 KB). The main loop records ~10 zones per frame,
+// so at 60 FPS the buffer of the main thread covers the last ~25 seconds.
+constexpr size_t kEventsPerThread = 16384;
+
+struct TraceEvent
+{
+    const char* name;
+    uint64_t start_us;
+    uint64_t duration_us;
+};
+
+struct ThreadBuffer
+{
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    size_t next{0};
+    int thread_id{0};
+    std::string thread_name;
+    bool in_use{false};
+};
+
+// Zones of a thread that has ended, with the id and name it had.
+struct FinishedThread
+{
+    int thread_id;
+    std::string thread_name;
+    std::vector<TraceEvent> events;
+};
+
+struct TraceRegistry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    // Oldest first; together they keep at most kEventsPerThread zones.
+    std::deque<FinishedThread> finished_threads;
+    size_t finished_event_count{0};
+    int next_thread_id{1};
+};
+
+TraceRegistry& registry()
+{
+    // Never destroyed: buffers of threads may be written while static objects are being destroyed at exit.
+    static auto* trace_registry = new TraceRegistry();
+    return *trace_registry;
+}
+
+struct ThreadBufferHandle
+/* Owns a buffer for the lifetime of a thread. When the thread ends, its zones are moved to the finished threads
+of the registry under its id and name, and the empty buffer is handed over to the next new thread (with a new id),
+so short-lived worker threads don't grow the registry and their zones are never shown as zones of another thread. */
+{
+    ThreadBuffer* buffer{nullptr};
+
+    ~ThreadBufferHandle()
+    {
+        if (buffer == nullptr)
+        {
+            return;
+        }
+        auto& trace_registry = registry();
+        std::lock_guard<std::mutex> registry_lock(trace_registry.mutex);
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        if (!buffer->events.empty())
+        {
+            trace_registry.finished_event_count += buffer->events.size();
+            trace_registry.finished_threads.push_back({buffer->thread_id, buffer->thread_name, {}});
+            trace_registry.finished_threads.back().events.swap(buffer->events);
+            // Finished threads keep as many zones as one running thread, the oldest threads are dropped first.
+            while (trace_registry.finished_event_count > kEventsPerThread)
+            {
+                trace_registry.finished_event_count -= trace_registry.finished_threads.front().events.size();
+                trace_registry.finished_threads.pop_front();
+            }
+        }
+        buffer->next = 0;
+        buffer->in_use = false;
+    }
+};
+
+ThreadBuffer& threadBuffer()
+{
+    thread_local ThreadBufferHandle handle;
+    if (handle.buffer == nullptr)
+    {
+        auto& trace_registry = registry();
+        std::lock_guard<std::mutex> lock(trace_registry.mutex);
+        for (auto& buffer: trace_registry.buffers)
+        {
+            if (!buffer->in_use)
+            {
+                handle.buffer = buffer.get();
+                break;
+            }
+        }
+        if (handle.buffer == nullptr)
+        {
+            trace_registry.buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+            handle.buffer = trace_registry.buffers.back().get();
+        }
+        // A reused buffer is empty (see ~ThreadBufferHandle), only its memory is kept.
+        std::lock_guard<std::mutex> buffer_lock(handle.buffer->mutex);
+        handle.buffer->thread_id = trace_registry.next_thread_id++;
+        handle.buffer->thread_name = "thread " + std::to_string(handle.buffer->thread_id);
+        handle.buffer->events.reserve(kEventsPerThread);
+        handle.buffer->in_use = true;
+    }
+    return *handle.buffer;
+}
+
+size_t writeThread(std::ofstream& file, int thread_id, const std::string& thread_name,
+                   const std::vector<TraceEvent>& events, uint64_t since, bool first)
+/* Writes the name of a thread and its zones that ended after since, returns the number of zones. */
+{
+    file << (first ? "" : ",\n") << R"({"ph": "M", "name": "thread_name", "pid": 1, "tid": )"
+         << thread_id << R"(, "args": {"name": )";
+    json::writeString(file, thread_name);
+    file << "}}";
+
+    size_t zone_count = 0;
+    for (const auto& event: events)
+    {
+        if (event.start_us + event.duration_us < since)
+        {
+            continue;
+        }
+        file << ",\n" << R"({"ph": "X", "pid": 1, "tid": )" << thread_id << R"(, "name": )";
+        json::writeString(file, event.name);
+        file << R"(, "ts": )" << event.start_us << R"(, "dur": )" << event.duration_us << "}";
+        zone_count++;
+    }
+    return zone_count;
+}
+}
+
+
+bool Trace::isEnabled()
+/** Returns true if trace zones are compiled in (PROJECT_1_ENABLE_TRACING is defined). */
+{
+#ifdef PROJECT_1_ENABLE_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t Trace::nowMicroseconds()
+{
+    static const auto start_time = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_time).count());
+}
+
+void Trace::recordZone(const char* name, uint64_t start_us, uint64_t end_us)
+/** Stores a finished zone in the buffer of the calling thread, the oldest zone is replaced when the buffer is full.
+The lock is taken only by this thread and by an export, so it is practically never contended. */
+{
+    auto& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    TraceEvent event{name, start_us, end_us - start_us};
+    if (buffer.events.size() < kEventsPerThread)
+    {
+        buffer.events.push_back(event);
+    }
+    else
+    {
+        buffer.events[buffer.next] = event;
+    }
+    buffer.next = (buffer.next + 1) % kEventsPerThread;
+}
+
+void Trace::setThreadName(const char* name)
+/** Sets the name of the calling thread that is shown in the trace viewer. */
+{
+    auto& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.thread_name = name;
+}
+
+size_t Trace::exportChromeTrace(const std::string& path, double seconds)
+/** Writes all zones that ended during the last `seconds` seconds in the Trace Event Format
+(complete events, "ph": "X"), which can be opened in chrome://tracing or ui.perfetto.dev. */
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open trace file: " + path);
+    }
+
+    uint64_t now = nowMicroseconds();
+    uint64_t window = static_cast<uint64_t>(seconds * 1e6);
+    uint64_t since = now > window ? now - window : 0;
+
+    size_t zone_count = 0;
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    auto& trace_registry = registry();
+    std::lock_guard<std::mutex> registry_lock(trace_registry.mutex);
+    bool first = true;
+    for (const auto& thread: trace_registry.finished_threads)
+    {
+        zone_count += writeThread(file, thread.thread_id, thread.thread_name, thread.events, since, first);
+        first = false;
+    }
+    for (auto& buffer: trace_registry.buffers)
+    {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        // Buffers waiting for a new thread are empty.
+        if (!buffer->in_use)
+        {
+            continue;
+        }
+        zone_count += writeThread(file, buffer->thread_id, buffer->thread_name, buffer->events, since, first);
+        first = false;
+    }
+    file << "\n]}\n";
+
+    if (!file.good())
+    {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+    return zone_count;
+}
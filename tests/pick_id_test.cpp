@@ -0,0 +1,193 @@
+#include <cstdint>
+#include <set>
+#include <vector>
+#include "logger.h"
+
+#include "test_check.h"
+#include "../bench/offscreen_context.h"
+#include "../include/pick_id_allocator.h"
+#include "../include/session.h"
+
+// project_1_pick_id_test checks PickIdAllocator - exhaustion, reuse of released ids, errors for ids that were never
+// allocated or are released twice and the conversion of ids to pick colours and back - and the id -> index table of Session while Objects
+// are added, removed and restored by undo and redo.
+
+namespace
+{
+void checkExhaustion()
+{
+    PickIdAllocator allocator(4);
+    for (uint32_t expected = 1; expected <= 4; expected++)
+    {
+        CHECK(allocator.acquire() == expected);
+    }
+    CHECK(allocator.size() == 4);
+    CHECK_THROWS(allocator.acquire());
+    CHECK(allocator.size() == 4);
+
+    // A released id can be acquired again even if the allocator is full.
+    allocator.release(2);
+    CHECK(allocator.acquire() == 2);
+    CHECK_THROWS(allocator.acquire());
+
+    allocator.clear();
+    CHECK(allocator.size() == 0);
+    CHECK(allocator.acquire() == 1);
+}
+
+void checkReuse()
+{
+    PickIdAllocator allocator;
+    for (int i = 0; i < 10; i++)
+    {
+        allocator.acquire();
+    }
+    // The last released id is handed out first.
+    allocator.release(3);
+    allocator.release(7);
+    allocator.release(5);
+    CHECK(allocator.size() == 7);
+    CHECK(allocator.acquire() == 5);
+    CHECK(allocator.acquire() == 7);
+    CHECK(allocator.acquire() == 3);
+    CHECK(allocator.acquire() == 11);
+    CHECK(allocator.highestId() == 11);
+}
+
+void checkInvalidRelease()
+{
+    PickIdAllocator allocator;
+    CHECK_THROWS(allocator.release(0));
+    CHECK_THROWS(allocator.release(1));
+    allocator.acquire();
+    allocator.acquire();
+    CHECK_THROWS(allocator.release(0));
+    CHECK_THROWS(allocator.release(3));
+    CHECK_THROWS(allocator.release(PickIdAllocator::kMaxPickId));
+    CHECK(allocator.size() == 2);
+
+    // An id released twice would be handed out to two Objects.
+    allocator.release(1);
+    CHECK_THROWS(allocator.release(1));
+    CHECK(allocator.size() == 1);
+    CHECK(allocator.acquire() == 1);
+    CHECK(allocator.acquire() == 3);
+    allocator.release(3);
+    allocator.release(2);
+    CHECK_THROWS(allocator.release(3));
+    CHECK(allocator.acquire() == 2);
+    CHECK(allocator.acquire() == 3);
+    CHECK(allocator.acquire() == 4);
+}
+
+void checkColors()
+{
+    uint32_t mismatches = 0;
+    unsigned char rgb[3];
+    for (uint32_t pick_id = 0; pick_id <= PickIdAllocator::kMaxPickId; pick_id++)
+    {
+        PickIdAllocator::toColor(pick_id, rgb);
+        mismatches += PickIdAllocator::fromColor(rgb) == pick_id ? 0 : 1;
+    }
+    CHECK(mismatches == 0);
+
+    PickIdAllocator::toColor(0x123456, rgb);
+    CHECK(rgb[0] == 0x12 && rgb[1] == 0x34 && rgb[2] == 0x56);
+}
+
+void checkSessionPickTable(const Session& session)
+/* Every Object has its own pick id, and its pick colour resolves to its index; the background doesn't. */
+{
+    std::set<int> pick_ids;
+    const auto& objects = session.getObjects();
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        int pick_id = objects[i].getPickId();
+        CHECK(pick_id > 0);
+        CHECK(pick_ids.insert(pick_id).second);
+
+        unsigned char rgb[3];
+        PickIdAllocator::toColor(static_cast<uint32_t>(pick_id), rgb);
+        CHECK(session.getObjectIdByPickColor(rgb) == static_cast<int>(i));
+    }
+    const unsigned char background[3] = {0, 0, 0};
+    CHECK(session.getObjectIdByPickColor(background) == -1);
+    const unsigned char unused[3] = {0xFF, 0xFF, 0xFF};
+    CHECK(session.getObjectIdByPickColor(unused) == -1);
+}
+
+void checkSession()
+{
+    Session session;
+    for (int type = 0; type < kBuiltinObjectTypeCount; type++)
+    {
+        session.addObjects(static_cast<ObjectType>(type), 5);
+    }
+    checkSessionPickTable(session);
+
+    // Removed Objects free their ids, and the ids don't resolve to any Object until they are reused.
+    std::vector<int> removed_pick_ids;
+    for (int index: {17, 12, 3, 0})
+    {
+        removed_pick_ids.push_back(session.getObjects()[index].getPickId());
+        session.remove_object(index);
+    }
+    checkSessionPickTable(session);
+    for (int pick_id: removed_pick_ids)
+    {
+        unsigned char rgb[3];
+        PickIdAllocator::toColor(static_cast<uint32_t>(pick_id), rgb);
+        CHECK(session.getObjectIdByPickColor(rgb) == -1);
+    }
+
+    // Undone removals restore Objects at the end with reused ids, new Objects come after them.
+    for (int i = 0; i < 3; i++)
+    {
+        CHECK(session.undo());
+        checkSessionPickTable(session);
+    }
+    session.add_object(kCube);
+    checkSessionPickTable(session);
+    CHECK(session.getObjects().size() == 20);
+
+    // Undoing the cube and the first removal, then the creation of the last 5 Objects, which are spread over the
+    // session by now.
+    CHECK(session.undo());
+    CHECK(session.undo());
+    CHECK(session.getObjects().size() == 20);
+    CHECK(session.undo());
+    CHECK(session.getObjects().size() == 15);
+    checkSessionPickTable(session);
+    CHECK(session.redo());
+    CHECK(session.getObjects().size() == 20);
+    checkSessionPickTable(session);
+
+    session.remove_object(5);
+    CHECK(session.undo());
+    CHECK(session.redo());
+    checkSessionPickTable(session);
+    CHECK(session.undo());
+    checkSessionPickTable(session);
+
+    session.clear();
+    checkSessionPickTable(session);
+    session.addObjects(kPyramid, 3);
+    checkSessionPickTable(session);
+    CHECK(session.getObjects().front().getPickId() == 1);
+    session.clear();
+}
+}
+
+
+int main()
+{
+    Logger::init();
+    checkExhaustion();
+    checkReuse();
+    checkInvalidRelease();
+    checkColors();
+
+    OffscreenContext context(64, 64);
+    checkSession();
+    return test::testResult();
+}
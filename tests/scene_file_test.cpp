@@ -0,0 +1,429 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+#include "logger.h"
+
+#include "test_check.h"
+#include "../bench/offscreen_context.h"
+#include "../include/scene_file.h"
+#include "../include/mesh_registry.h"
+#include "../include/session.h"
+
+// project_1_scene_file_test saves scenes with SceneFile, loads them back and compares every Object, comment and
+// custom mesh; with zlib, mesh blocks are compressed as well. Then it damages saved files in every part of the layout
+// and checks that they are rejected with an exception instead of being read out of bounds, without registering any
+// of their meshes, and that meshes of a file reuse registered meshes only with the same name and contents. Objects
+// need buffers, so the test runs in an off-screen context like project_1_bench.
+
+namespace
+{
+using Bytes = std::vector<char>;
+
+// A stored size shorter than the mesh block of the test.
+constexpr size_t kShortBlockSize = 16;
+
+Polyhedron makeGrid(int size)
+/* A flat grid of size x size vertices with two triangles per cell; its indices compress well. */
+{
+    Polyhedron grid;
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            grid.vertices.insert(grid.vertices.end(), {static_cast<GLfloat>(x) / static_cast<GLfloat>(size - 1) - 0.5f,
+                                                       static_cast<GLfloat>(y) / static_cast<GLfloat>(size - 1) - 0.5f,
+                                                       0.0f});
+        }
+    }
+    for (int y = 0; y + 1 < size; y++)
+    {
+        for (int x = 0; x + 1 < size; x++)
+        {
+            auto corner = static_cast<GLuint>(y * size + x);
+            auto row = static_cast<GLuint>(size);
+            grid.indices.insert(grid.indices.end(), {corner, corner + 1, corner + row + 1,
+                                                     corner, corner + row + 1, corner + row});
+        }
+    }
+    return grid;
+}
+
+void populateScene(Session& session, ObjectType custom_type)
+/* Two Objects of every built-in type and three of the custom mesh, each with its own colour, transform, zoom,
+polygon mode, panel, comment and selection. */
+{
+    std::vector<ObjectType> types;
+    for (int type = 0; type < kBuiltinObjectTypeCount; type++)
+    {
+        types.insert(types.end(), 2, static_cast<ObjectType>(type));
+    }
+    types.insert(types.end(), 3, custom_type);
+
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        session.add_object(types[i]);
+        auto& object = session.getObjects().back();
+        auto value = static_cast<float>(i);
+
+        const float rgb[3] = {0.1f * value, 0.5f, 1.0f - 0.05f * value};
+        std::memcpy(object.getObjectColor(), rgb, sizeof(rgb));
+        float rotation[9];
+        Object::calculateRotationDelta(3.0 * i, -7.0, rotation);
+        object.applyRotation(rotation);
+        const float translation[3] = {0.25f * value, -0.125f * value, 0.5f};
+        object.translate(translation);
+
+        auto& gui_parameters = object.getObjectGuiParameters();
+        gui_parameters.zoom_factor_ = 1.0f + 0.25f * value;
+        gui_parameters.object_gui_ = i % 3 == 0;
+        gui_parameters.window_x_ = 10.0 * i;
+        gui_parameters.window_y_ = 20.5 + i;
+        // Empty, short and the longest possible comments.
+        std::string comment = i % 4 == 0 ? "" : "Object " + std::to_string(i);
+        if (i == 5)
+        {
+            comment.assign(sizeof(gui_parameters.comment_) - 1, 'c');
+        }
+        std::strncpy(gui_parameters.comment_, comment.c_str(), sizeof(gui_parameters.comment_) - 1);
+        gui_parameters.comment_[sizeof(gui_parameters.comment_) - 1] = '\0';
+
+        object.getPolygonMode() = i % 2 == 0 ? kPolygonModeFill : kPolygonModeLine;
+        session.setSelected(i, i % 2 == 1);
+    }
+}
+
+void checkSameObjects(const Session& expected, const Session& actual)
+{
+    CHECK(expected.getObjects().size() == actual.getObjects().size());
+    for (size_t i = 0; i < expected.getObjects().size() && i < actual.getObjects().size(); i++)
+    {
+        const auto& a = expected.getObjects()[i];
+        const auto& b = actual.getObjects()[i];
+        CHECK(a.getId() == b.getId());
+        CHECK(a.getObjectType() == b.getObjectType());
+        CHECK(std::memcmp(a.getObjectColor(), b.getObjectColor(), 3 * sizeof(float)) == 0);
+        CHECK(std::memcmp(a.getTranslation(), b.getTranslation(), 3 * sizeof(float)) == 0);
+        CHECK(std::memcmp(a.getRotation(), b.getRotation(), 9 * sizeof(float)) == 0);
+        CHECK(a.getPolygonMode() == b.getPolygonMode());
+        CHECK(expected.isSelected(i) == actual.isSelected(i));
+
+        const auto& a_gui = a.getObjectGuiParameters();
+        const auto& b_gui = b.getObjectGuiParameters();
+        CHECK(a_gui.zoom_factor_ == b_gui.zoom_factor_);
+        CHECK(a_gui.object_gui_ == b_gui.object_gui_);
+        CHECK(a_gui.window_x_ == b_gui.window_x_);
+        CHECK(a_gui.window_y_ == b_gui.window_y_);
+        CHECK(std::string(a_gui.comment_) == std::string(b_gui.comment_));
+    }
+}
+
+void checkMeshBlock(const std::string& file_path, ObjectType custom_type, uint32_t codec)
+/* The file stores exactly one mesh, the custom one, with the given codec and the same vertices and indices. */
+{
+    SceneReader reader(file_path);
+    CHECK(reader.meshCount() == 1);
+    if (reader.meshCount() != 1)
+    {
+        return;
+    }
+    const auto& mesh = MeshRegistry::getMesh(custom_type);
+    const auto& entry = reader.meshEntry(0);
+    CHECK(std::string(entry.name) == MeshRegistry::getName(custom_type));
+    CHECK(entry.codec == codec);
+    CHECK(entry.vertex_count == mesh.vertices.size());
+    CHECK(entry.index_count == mesh.indices.size());
+    CHECK(std::memcmp(reader.meshVertices(0), mesh.vertices.data(), sizeof(GLfloat) * mesh.vertices.size()) == 0);
+    CHECK(std::memcmp(reader.meshIndices(0), mesh.indices.data(), sizeof(GLuint) * mesh.indices.size()) == 0);
+
+    // Comments are read back from the pool of the file, not only through the Session.
+    size_t commented = 0;
+    for (size_t i = 0; i < reader.objectCount(); i++)
+    {
+        commented += reader.comment(reader.objects()[i]).empty() ? 0 : 1;
+    }
+    CHECK(commented > 0);
+}
+
+Bytes readFile(const std::string& file_path)
+{
+    std::ifstream file(file_path, std::ios::binary);
+    return Bytes(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& file_path, const Bytes& bytes)
+{
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+template<typename T>
+T readValue(const Bytes& bytes, size_t offset)
+{
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+template<typename T>
+Bytes patched(Bytes bytes, size_t offset, T value)
+{
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    return bytes;
+}
+
+Bytes renamedMesh(Bytes bytes, size_t mesh_entry, const std::string& name)
+{
+    char* entry_name = bytes.data() + mesh_entry + offsetof(SceneMeshEntry, name);
+    std::memset(entry_name, 0, sizeof(SceneMeshEntry::name));
+    std::memcpy(entry_name, name.data(), name.size());
+    return bytes;
+}
+
+void checkRejected(const Bytes& bytes, Session& session, const char* description)
+/* Loading a damaged file throws and leaves the session and MeshRegistry as they were. */
+{
+    const std::string file_path = "scene_file_test_damaged.p1s";
+    writeFile(file_path, bytes);
+    size_t object_count = session.getObjects().size();
+    size_t mesh_count = MeshRegistry::size();
+    bool thrown = false;
+    try
+    {
+        SceneFile::load(session, file_path);
+    }
+    catch (const std::exception&)
+    {
+        thrown = true;
+    }
+    if (!thrown)
+    {
+        test::fail(__FILE__, __LINE__, std::string("a scene file with ") + description + " is loaded");
+    }
+    CHECK(session.getObjects().size() == object_count);
+    CHECK(MeshRegistry::size() == mesh_count);
+    std::remove(file_path.c_str());
+}
+
+void checkDamagedFiles(const std::string& file_path, Session& session, ObjectType custom_type)
+/* file_path is a valid scene file with one uncompressed mesh block. */
+{
+    const Bytes valid = readFile(file_path);
+    const auto header = readValue<SceneFileHeader>(valid, 0);
+    const size_t mesh_entry = header.mesh_table_offset;
+    const size_t first_record = header.object_table_offset;
+    const auto entry = readValue<SceneMeshEntry>(valid, mesh_entry);
+    CHECK(entry.codec == kSceneMeshRaw);
+
+    checkRejected(Bytes(), session, "no data");
+    checkRejected(Bytes(valid.begin(), valid.begin() + sizeof(SceneFileHeader) / 2), session, "half of a header");
+    checkRejected(Bytes(valid.begin(), valid.end() - 1), session, "the last byte missing");
+    checkRejected(Bytes(valid.begin(), valid.begin() + static_cast<long>(entry.block_offset)), session,
+                  "the mesh block missing");
+    checkRejected(patched(valid, 0, 'X'), session, "a wrong magic");
+    checkRejected(patched(valid, offsetof(SceneFileHeader, version), kSceneFileVersion + 1), session,
+                  "a newer version");
+    checkRejected(patched(valid, offsetof(SceneFileHeader, version), uint32_t(0)), session, "version 0");
+
+    // Tables outside of the file, or so large that their size overflows.
+    checkRejected(patched(valid, offsetof(SceneFileHeader, mesh_count), uint32_t(100000)), session,
+                  "too many meshes");
+    checkRejected(patched(valid, offsetof(SceneFileHeader, object_count), uint64_t(valid.size())), session,
+                  "too many objects");
+    checkRejected(patched(valid, offsetof(SceneFileHeader, object_count), UINT64_MAX / sizeof(SceneObjectRecord) + 1),
+                  session, "an object count whose table size overflows");
+    checkRejected(patched(valid, offsetof(SceneFileHeader, object_table_offset), uint64_t(valid.size())), session,
+                  "the object table after the end");
+    checkRejected(patched(valid, offsetof(SceneFileHeader, object_table_offset), header.object_table_offset + 1),
+                  session, "a misaligned object table");
+    checkRejected(patched(valid, offsetof(SceneFileHeader, mesh_table_offset), UINT64_MAX - 8), session,
+                  "the mesh table offset close to overflow");
+    checkRejected(patched(valid, offsetof(SceneFileHeader, comment_pool_size), uint64_t(valid.size())), session,
+                  "the comment pool after the end");
+
+    // Mesh blocks outside of the file, of a wrong size or with a codec that doesn't exist.
+    checkRejected(patched(valid, mesh_entry + offsetof(SceneMeshEntry, block_offset), uint64_t(valid.size())),
+                  session, "a mesh block after the end");
+    checkRejected(patched(valid, mesh_entry + offsetof(SceneMeshEntry, block_offset), entry.block_offset + 4),
+                  session, "a misaligned mesh block");
+    checkRejected(patched(valid, mesh_entry + offsetof(SceneMeshEntry, stored_size), uint64_t(valid.size())),
+                  session, "a mesh block larger than the file");
+    checkRejected(patched(valid, mesh_entry + offsetof(SceneMeshEntry, stored_size), uint64_t(kShortBlockSize)),
+                  session, "a raw mesh block shorter than its data");
+    checkRejected(patched(valid, mesh_entry + offsetof(SceneMeshEntry, vertex_count), entry.vertex_count + 3),
+                  session, "a vertex count larger than the mesh block");
+    checkRejected(patched(valid, mesh_entry + offsetof(SceneMeshEntry, index_count), UINT32_MAX), session,
+                  "an index count larger than the mesh block");
+    checkRejected(patched(valid, mesh_entry + offsetof(SceneMeshEntry, codec), uint32_t(7)), session,
+                  "an unknown codec");
+
+    // Meshes that aren't registered yet (another name): one with an index of a vertex after the last one, an empty
+    // one, and a valid one in a file that is found broken after its meshes are read. None of them is registered.
+    const std::string new_name = "scene_file_test_new";
+    const Bytes renamed = renamedMesh(valid, mesh_entry, new_name);
+    checkRejected(patched(renamed, static_cast<size_t>(entry.block_offset) + sizeof(GLfloat) * entry.vertex_count,
+                          entry.vertex_count / 3), session, "a mesh index out of range");
+    Bytes empty_mesh = renamed;
+    for (size_t field: {offsetof(SceneMeshEntry, vertex_count), offsetof(SceneMeshEntry, index_count)})
+    {
+        empty_mesh = patched(empty_mesh, mesh_entry + field, uint32_t(0));
+    }
+    for (size_t field: {offsetof(SceneMeshEntry, stored_size), offsetof(SceneMeshEntry, raw_size)})
+    {
+        empty_mesh = patched(empty_mesh, mesh_entry + field, uint64_t(0));
+    }
+    checkRejected(empty_mesh, session, "an empty mesh");
+    checkRejected(patched(renamed, first_record + offsetof(SceneObjectRecord, comment_length), UINT32_MAX), session,
+                  "a new mesh and a comment longer than the pool");
+    checkRejected(patched(renamed, first_record + offsetof(SceneObjectRecord, object_type), uint32_t(1000)), session,
+                  "a new mesh and an unknown object type");
+    CHECK(MeshRegistry::findByName(new_name) < 0);
+
+    // Objects of a type that isn't stored in the file or with comments outside of the comment pool.
+    checkRejected(patched(valid, first_record + offsetof(SceneObjectRecord, object_type), uint32_t(1000)), session,
+                  "an unknown object type");
+    checkRejected(patched(valid, first_record + offsetof(SceneObjectRecord, comment_offset),
+                          static_cast<uint32_t>(header.comment_pool_size + 1)), session, "a comment after the pool");
+    checkRejected(patched(valid, first_record + offsetof(SceneObjectRecord, comment_length), UINT32_MAX), session,
+                  "a comment longer than the pool");
+}
+
+void checkDamagedCompressedBlock(const std::string& file_path, Session& session)
+/* file_path is a valid scene file with one compressed mesh block, whose data is damaged. */
+{
+    const Bytes valid = readFile(file_path);
+    const auto header = readValue<SceneFileHeader>(valid, 0);
+    const auto entry = readValue<SceneMeshEntry>(valid, header.mesh_table_offset);
+    CHECK(entry.codec == kSceneMeshDeflate);
+
+    Bytes damaged = valid;
+    for (size_t i = 0; i < entry.stored_size; i += 7)
+    {
+        damaged[entry.block_offset + i] = static_cast<char>(~damaged[entry.block_offset + i]);
+    }
+    checkRejected(damaged, session, "a damaged compressed mesh block");
+    checkRejected(patched(valid, header.mesh_table_offset + offsetof(SceneMeshEntry, raw_size),
+                          entry.raw_size + sizeof(GLuint)), session, "a wrong size of a compressed mesh block");
+}
+
+void checkMeshNames(const std::string& file_path, ObjectType custom_type)
+/* file_path is a valid scene file with Objects of custom_type. A mesh of a file is drawn with a registered mesh only
+if both have the same name and contents; a different mesh with the same name is registered under another name. */
+{
+    const std::string other_name = "scene_file_test_other";
+    const auto other_type = MeshRegistry::registerMesh(other_name, makeGrid(8));
+    const Bytes valid = readFile(file_path);
+    const auto header = readValue<SceneFileHeader>(valid, 0);
+    const std::string renamed_path = "scene_file_test_renamed.p1s";
+    writeFile(renamed_path, renamedMesh(valid, header.mesh_table_offset, other_name));
+
+    auto custom_types = [](const Session& session) {
+        std::set<int> types;
+        for (const auto& object: session.getObjects())
+        {
+            if (object.getObjectType() >= kBuiltinObjectTypeCount)
+            {
+                types.insert(object.getObjectType());
+            }
+        }
+        return types;
+    };
+
+    Session session;
+    const size_t mesh_count = MeshRegistry::size();
+    SceneFile::load(session, renamed_path);
+    CHECK(MeshRegistry::size() == mesh_count + 1);
+    const int renamed_type = MeshRegistry::findByName(other_name + "_");
+    CHECK(renamed_type >= 0 && renamed_type != other_type);
+    CHECK(custom_types(session) == std::set<int>{renamed_type});
+    if (renamed_type >= 0)
+    {
+        const auto& mesh = MeshRegistry::getMesh(static_cast<ObjectType>(renamed_type));
+        const auto& custom_mesh = MeshRegistry::getMesh(custom_type);
+        CHECK(mesh.vertices == custom_mesh.vertices && mesh.indices == custom_mesh.indices);
+    }
+
+    // Loading the same files again registers nothing.
+    SceneFile::load(session, renamed_path);
+    CHECK(custom_types(session) == std::set<int>{renamed_type});
+    SceneFile::load(session, file_path);
+    CHECK(custom_types(session) == std::set<int>{custom_type});
+    CHECK(MeshRegistry::size() == mesh_count + 1);
+
+    session.clear();
+    std::remove(renamed_path.c_str());
+}
+}
+
+
+int main()
+{
+    Logger::init();
+    OffscreenContext context(64, 64);
+
+    const auto custom_type = MeshRegistry::registerMesh("scene_file_test_grid", makeGrid(64));
+    Session session;
+    populateScene(session, custom_type);
+
+    // Uncompressed: loading into a session with other Objects replaces them.
+    const std::string raw_path = "scene_file_test_raw.p1s";
+    auto save_stats = SceneFile::save(session, raw_path, false);
+    CHECK(save_stats.object_count == session.getObjects().size());
+    CHECK(save_stats.mesh_count == 1);
+    checkMeshBlock(raw_path, custom_type, kSceneMeshRaw);
+
+    Session loaded;
+    loaded.add_object(kCube);
+    auto load_stats = SceneFile::load(loaded, raw_path);
+    CHECK(load_stats.object_count == session.getObjects().size());
+    CHECK(load_stats.file_size == save_stats.file_size);
+    checkSameObjects(session, loaded);
+
+    // A saved and loaded scene saves to the same bytes.
+    const std::string again_path = "scene_file_test_again.p1s";
+    SceneFile::save(loaded, again_path, false);
+    CHECK(readFile(raw_path) == readFile(again_path));
+
+    checkDamagedFiles(raw_path, loaded, custom_type);
+    checkSameObjects(session, loaded);
+    checkMeshNames(raw_path, custom_type);
+
+    // Compressed mesh blocks, if the application is built with zlib; without it, the block is stored raw.
+    const std::string compressed_path = "scene_file_test_compressed.p1s";
+    SceneFile::save(session, compressed_path, true);
+    bool compressed = SceneFile::isCompressionAvailable();
+    checkMeshBlock(compressed_path, custom_type, compressed ? kSceneMeshDeflate : kSceneMeshRaw);
+    if (compressed)
+    {
+        CHECK(readFile(compressed_path).size() < readFile(raw_path).size());
+        Session loaded_compressed;
+        SceneFile::load(loaded_compressed, compressed_path);
+        checkSameObjects(session, loaded_compressed);
+        checkDamagedCompressedBlock(compressed_path, loaded_compressed);
+        checkSameObjects(session, loaded_compressed);
+        loaded_compressed.clear();
+    }
+    else
+    {
+        std::cout << "zlib is not available, compressed mesh blocks are not tested." << std::endl;
+    }
+
+    // An empty scene.
+    Session empty;
+    const std::string empty_path = "scene_file_test_empty.p1s";
+    SceneFile::save(empty, empty_path, true);
+    SceneFile::load(loaded, empty_path);
+    CHECK(loaded.getObjects().empty());
+
+    for (const auto& file_path: {raw_path, again_path, compressed_path, empty_path})
+    {
+        std::remove(file_path.c_str());
+    }
+    session.clear();
+    return test::testResult();
+}
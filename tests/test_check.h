@@ -0,0 +1,63 @@
+#ifndef PROJECT_1_TEST_CHECK_H
+#define PROJECT_1_TEST_CHECK_H
+
+#include <iostream>
+#include <string>
+
+// Checks of the test executables (tests/*_test.cpp). A failed check prints its location and the test goes on, so one
+// run reports every failure; main returns testResult(), which ctest sees as a failed test if anything failed.
+
+namespace test
+{
+inline int& failureCount()
+{
+    static int failure_count = 0;
+    return failure_count;
+}
+
+inline void fail(const char* file, int line, const std::string& message)
+{
+    std::cerr << file << ":" << line << ": check failed: " << message << std::endl;
+    failureCount()++;
+}
+
+inline int testResult()
+{
+    if (failureCount() > 0)
+    {
+        std::cerr << failureCount() << " check(s) failed." << std::endl;
+        return 1;
+    }
+    return 0;
+}
+}
+
+#define CHECK(condition)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(condition))                                                                                              \
+        {                                                                                                              \
+            test::fail(__FILE__, __LINE__, #condition);                                                                \
+        }                                                                                                              \
+    } while (false)
+
+// The expression has to throw an exception derived from std::exception.
+#define CHECK_THROWS(expression)                                                                                       \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        bool thrown = false;                                                                                           \
+        try                                                                                                            \
+        {                                                                                                              \
+            expression;                                                                                                \
+        }                                                                                                              \
+        catch (const std::exception&)                                                                                  \
+        {                                                                                                              \
+            thrown = true;                                                                                             \
+        }                                                                                                              \
+        if (!thrown)                                                                                                   \
+        {                                                                                                              \
+            test::fail(__FILE__, __LINE__, std::string(#expression) + " doesn't throw");                             \
+        }                                                                                                              \
+    } while (false)
+
+#endif //PROJECT_1_TEST_CHECK_H
@@ -0,0 +1,224 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// project_1_bake_meshes runs at build time and writes the built-in meshes (cube, pyramid, sphere, icosahedron)
+// as constant tables into a C++ source file that is compiled into the application (see library.h).
+// Usage: project_1_bake_meshes output.cpp
+
+namespace
+{
+const float pi = 3.14159265359f;
+
+// Precision of the sphere: number of horizontal stripes (and half of the number of vertical ones).
+const int kSpherePrecision = 40;
+
+struct Mesh
+{
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+const Mesh cube = {
+        {
+                -0.5f, -0.5f, -0.5f,
+                0.5f, -0.5f, -0.5f,
+                0.5f,  0.5f, -0.5f,
+                -0.5f,  0.5f, -0.5f,
+                -0.5f, -0.5f,  0.5f,
+                0.5f, -0.5f,  0.5f,
+                0.5f,  0.5f,  0.5f,
+                -0.5f,  0.5f,  0.5f
+        },
+        {
+                // Back face
+                0, 1, 2,
+                2, 3, 0,
+                4, 5, 6,
+                6, 7, 4,
+                0, 3, 7,
+                7, 4, 0,
+                1, 5, 6,
+                6, 2, 1,
+                3, 2, 6,
+                6, 7, 3,
+                0, 1, 5,
+                5, 4, 0
+        }
+};
+
+const Mesh pyramid = {
+        {
+                -0.5f, 0.0f,-0.5f,
+                0.5f, 0.0f, -0.5f,
+                0.5f, 0.0f,0.5f,
+                -0.5f, 0.0f, 0.5f,
+                0.0f, 1.0f ,0.0f,
+        },
+        {
+                0, 1, 4,  // Side Face 0
+                1, 2, 4,  // Side Face 1
+                2, 3, 4,  // Side Face 2
+                3, 0, 4,  // Side Face 3
+                0, 1, 2,  // Base Face (Triangle 1)
+                2, 3, 0   // Base Face (Triangle 2)
+        }
+};
+
+const Mesh icosahedron = {
+        {-0.5257311f, 0.0f, 0.8506508f,
+         0.5257311f, 0.0f, 0.8506508f,
+         -0.5257311f, 0.0f, -0.8506508f,
+         0.5257311f, 0.0f, -0.8506508f,
+         0.0f, 0.8506508f, 0.5257311f,
+         0.0f, 0.8506508f, -0.5257311f,
+         0.0f, -0.8506508f, 0.5257311f,
+         0.0f, -0.8506508f, -0.5257311f,
+         0.8506508f, 0.5257311f, 0.0f,
+         -0.8506508f, 0.5257311f, 0.0f,
+         0.8506508f, -0.5257311f, 0.0f,
+         -0.8506508f, -0.5257311f, 0.0f
+        },
+        {
+                0,4,1,
+                0,9,4,
+                9,5,4,
+                4,5,8,
+                4,8,1,
+                8,10,1,
+                8,3,10,
+                5,3,8,
+                5,2,3,
+                2,7,3,
+                7,10,3,
+                7,6,10,
+                7,11,6,
+                11,0,6,
+                0,1,6,
+                6,1,10,
+                9,0,11,
+                9,11,2,
+                9,2,5,
+                7,2,11
+        }
+};
+
+Mesh generateSphere(float precision)
+/* Generates vertices and indices of a sphere made of triangle stripes. */
+{
+    Mesh sphere;
+
+    for (int i = 0; i <= precision; ++i) {
+        float theta1 = i * pi / precision;
+        float theta2 = (i + 1) * pi / precision;
+
+        for (int j = 0; j <= precision * 2; ++j) {
+            float phi = j * 2 * pi / (precision * 2);
+
+            float x1 = sin(theta1) * cos(phi);
+            float y1 = cos(theta1);
+            float z1 = sin(theta1) * sin(phi);
+
+            float x2 = sin(theta2) * cos(phi);
+            float y2 = cos(theta2);
+            float z2 = sin(theta2) * sin(phi);
+
+            sphere.vertices.push_back(x1);
+            sphere.vertices.push_back(y1);
+            sphere.vertices.push_back(z1);
+
+            sphere.vertices.push_back(x2);
+            sphere.vertices.push_back(y2);
+            sphere.vertices.push_back(z2);
+        }
+    }
+
+    for (unsigned int i = 0; i < sphere.vertices.size() / 3 - precision - 1; i += (precision + 1)) {
+        for (int j = 0; j < precision; ++j) {
+            sphere.indices.push_back(i + j);
+            sphere.indices.push_back(i + j + 1);
+            sphere.indices.push_back(i + j + 2);
+
+            sphere.indices.push_back(i + j + 2);
+            sphere.indices.push_back(i + j + 1);
+            sphere.indices.push_back(i + j + 3);
+        }
+    }
+
+    return sphere;
+}
+
+void writeMesh(std::ofstream& file, const std::string& name, const Mesh& mesh)
+/* Writes vertices and indices of a mesh as two constant arrays. Floats are written with 9 significant digits,
+so they are read back exactly. */
+{
+    char number[32];
+    file << "const GLfloat " << name << "_vertices[] = {";
+    for (size_t i = 0; i < mesh.vertices.size(); i++)
+    {
+        std::snprintf(number, sizeof(number), "%.9g", mesh.vertices[i]);
+        // "1" is not a valid float literal with the f suffix, "1.0f" is.
+        bool has_fraction = std::string(number).find_first_of(".e") != std::string::npos;
+        file << (i % 6 == 0 ? "\n        " : " ") << number << (has_fraction ? "f," : ".0f,");
+    }
+    file << "\n};\n";
+
+    file << "const GLuint " << name << "_indices[] = {";
+    for (size_t i = 0; i < mesh.indices.size(); i++)
+    {
+        file << (i % 12 == 0 ? "\n        " : " ") << mesh.indices[i] << ",";
+    }
+    file << "\n};\n\n";
+}
+}
+
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: project_1_bake_meshes output.cpp" << std::endl;
+        return 1;
+    }
+
+    std::ofstream file(argv[1]);
+    if (!file)
+    {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    // Order of the meshes is the order of ObjectType (object.h).
+    const std::vector<std::pair<std::string, Mesh>> meshes = {
+            {"cube", cube},
+            {"pyramid", pyramid},
+            {"sphere", generateSphere(kSpherePrecision)},
+            {"icosahedron", icosahedron}};
+
+    // The generated file is placed in the build directory, so library.h is found through the include path.
+    file << "// Generated by project_1_bake_meshes (tools/bake_meshes.cpp) at build time, do not edit.\n"
+            "#include \"library.h\"\n\n"
+            "namespace\n{\n";
+    for (const auto& mesh: meshes)
+    {
+        writeMesh(file, mesh.first, mesh.second);
+    }
+    file << "}\n\n"
+            "const MeshView kBuiltinMeshes[kBuiltinObjectTypeCount] = {\n";
+    for (const auto& mesh: meshes)
+    {
+        file << "        {" << mesh.first << "_vertices, " << mesh.second.vertices.size() << ", "
+             << mesh.first << "_indices, " << mesh.second.indices.size() << "},\n";
+    }
+    file << "};\n";
+
+    if (!file.good())
+    {
+        std::cerr << "Failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}